@@ -2,10 +2,11 @@
 #include "mnnInfer.h"
 #include <iostream>
 #include <vector>
+#include <algorithm>
 #include <opencv2/opencv.hpp>
 
-MNNInfer::MNNInfer(std::string modelPath,float mean_[3],float std_[3])
-    : m_modelPath(modelPath) {
+MNNInfer::MNNInfer(std::string modelPath,float mean_[3],float std_[3], int num_sessions)
+    : m_modelPath(modelPath), m_numSessions(std::max(num_sessions, 1)) {
         for(int i = 0; i < 3; i++)
         {
             mnn_mean[i] = mean_[i];
@@ -14,8 +15,10 @@ MNNInfer::MNNInfer(std::string modelPath,float mean_[3],float std_[3])
     }
 
 MNNInfer::~MNNInfer() {
-    if (m_session) {
-        m_net->releaseSession(m_session);
+    for (auto& slot : m_sessions) {
+        if (slot.session) {
+            m_net->releaseSession(slot.session);
+        }
     }
 }
 
@@ -32,39 +35,75 @@ int MNNInfer::loadModel() {
     backendConfig.precision = MNN::BackendConfig::Precision_High;
     config.backendConfig = &backendConfig;
 
-    m_session = m_net->createSession(config);
-    if (!m_session) {
-        std::cerr << "❌ Failed to create MNN session." << std::endl;
-        return -1;
+    // 预处理配置（每个会话一个 ImageProcess 实例，convert 不在会话间共享）
+    MNN::CV::ImageProcess::Config processConfig;
+    processConfig.filterType = MNN::CV::BILINEAR;
+    processConfig.sourceFormat = MNN::CV::BGR;
+    processConfig.destFormat = MNN::CV::RGB;
+    for (int i = 0; i < 3; ++i) {
+        processConfig.mean[i]   = mnn_mean[i];
+        processConfig.normal[i] = 1.0f / (mnn_std[i] * 255.0f);
     }
 
-    // 获取输入张量
-    auto inputTensors = m_net->getSessionInputAll(m_session);
-    if (inputTensors.empty()) {
-        std::cerr << "❌ No input tensor found!" << std::endl;
-        return -1;
-    }
-    std::string inputName = inputTensors.begin()->first;
-    m_inputTensor = inputTensors.begin()->second;
-    
-    if (!m_inputTensor) {
-        std::cerr << "❌ Failed to get input tensor." << std::endl;
-        return -1;
+    // 创建会话池：共享同一个 Interpreter（权重只有一份）
+    m_sessions.resize(m_numSessions);
+    for (int s = 0; s < m_numSessions; ++s) {
+        SessionSlot& slot = m_sessions[s];
+        slot.session = m_net->createSession(config);
+        if (!slot.session) {
+            std::cerr << "❌ Failed to create MNN session." << std::endl;
+            return -1;
+        }
+
+        // 获取输入张量
+        auto inputTensors = m_net->getSessionInputAll(slot.session);
+        if (inputTensors.empty() || !inputTensors.begin()->second) {
+            std::cerr << "❌ Failed to get input tensor." << std::endl;
+            return -1;
+        }
+        slot.inputTensor = inputTensors.begin()->second;
+
+        // 获取输出张量（假设单输出）
+        auto outputTensors = m_net->getSessionOutputAll(slot.session);
+        if (outputTensors.empty() || !outputTensors.begin()->second) {
+            std::cerr << "❌ No output tensor!" << std::endl;
+            return -1;
+        }
+        slot.outputName = outputTensors.begin()->first;
+        slot.outputTensor = outputTensors.begin()->second;
+
+        slot.inputHost.reset(new MNN::Tensor(slot.inputTensor, MNN::Tensor::CAFFE));
+        slot.outputHost.reset(new MNN::Tensor(slot.outputTensor, MNN::Tensor::CAFFE));
+        slot.process = std::shared_ptr<MNN::CV::ImageProcess>(MNN::CV::ImageProcess::create(processConfig));
     }
 
+    m_freeSessions.clear();
+    for (int s = m_numSessions - 1; s >= 0; --s) m_freeSessions.push_back(s);
+
     // 打印输入信息
-    auto shape = m_inputTensor->shape();
+    auto shape = m_sessions[0].inputTensor->shape();
     std::cout << "✅ Model loaded. Input shape (NCHW): ";
     for (size_t i = 0; i < shape.size(); ++i) {
         std::cout << shape[i] << " ";
     }
-    std::cout << std::endl;
+    std::cout << "(" << m_numSessions << " session" << (m_numSessions > 1 ? "s" : "") << ")" << std::endl;
 
     return 0;
 }
 
 int MNNInfer::runInference(std::vector<cv::Mat> &inputs, std::vector<std::vector<float>> &outputs) {
-    if (!m_session || !m_inputTensor) {
+    std::vector<std::pair<std::string, std::vector<int>>> shapes;
+    int ret = runInference(inputs, outputs, shapes);
+    std::lock_guard<std::mutex> lock(m_shapesMutex);
+    output_shapes = std::move(shapes);
+    return ret;
+}
+
+int MNNInfer::runInference(std::vector<cv::Mat> &inputs, std::vector<std::vector<float>> &outputs,
+                           std::vector<std::pair<std::string, std::vector<int>>> &shapes) {
+    outputs.clear();
+    shapes.clear();
+    if (m_sessions.empty()) {
         std::cerr << "❌ Model not loaded!" << std::endl;
         return -1;
     }
@@ -73,81 +112,68 @@ int MNNInfer::runInference(std::vector<cv::Mat> &inputs, std::vector<std::vector
         return -1;
     }
 
-    auto shape = m_inputTensor->shape();
-    int model_batch = shape[0];   // 通常是 1
-    int channel = shape[1];
+    Lease lease(*this);
+    return _run(m_sessions[lease.id], inputs, outputs, shapes);
+}
+
+int MNNInfer::_acquire() {
+    std::unique_lock<std::mutex> lock(m_poolMutex);
+    m_poolCv.wait(lock, [this] { return !m_freeSessions.empty(); });
+    int id = m_freeSessions.back();
+    m_freeSessions.pop_back();
+    return id;
+}
+
+void MNNInfer::_release(int id) {
+    {
+        std::lock_guard<std::mutex> lock(m_poolMutex);
+        m_freeSessions.push_back(id);
+    }
+    m_poolCv.notify_one();
+}
+
+int MNNInfer::_run(SessionSlot& slot, std::vector<cv::Mat> &inputs, std::vector<std::vector<float>> &outputs,
+                   std::vector<std::pair<std::string, std::vector<int>>> &shapes) {
+    auto shape = slot.inputTensor->shape();
     int height = shape[2];
     int width = shape[3];
 
-    // std::cout << "📊 Model input shape: " << shape[0] << "x" << shape[1] 
-    //           << "x" << shape[2] << "x" << shape[3] << std::endl;
-
     // ✅ 关键修改：不要检查 batch size，而是循环处理每个输入
     // 即使 model_batch=1，我们也逐个推理
 
-    outputs.clear();
-    output_shapes.clear();
-
-    // 获取输出 tensor 信息（假设单输出）
-    auto outputNames = m_net->getSessionOutputAll(m_session);
-    if (outputNames.empty()) {
-        std::cerr << "❌ No output tensor!" << std::endl;
-        return -1;
-    }
-    const std::string& outName = outputNames.begin()->first;
-
-    // 预处理配置
-    MNN::CV::ImageProcess::Config config;
-    config.filterType = MNN::CV::BILINEAR;
-    config.sourceFormat = MNN::CV::BGR;
-    config.destFormat = MNN::CV::RGB;
-    for (int i = 0; i < 3; ++i) {
-        config.mean[i]   = mnn_mean[i];
-        config.normal[i] = 1.0f / (mnn_std[i] * 255.0f);
-    }
-    auto process = std::shared_ptr<MNN::CV::ImageProcess>(MNN::CV::ImageProcess::create(config));
+    size_t feat_dim = 1;
+    for (auto s : slot.outputTensor->shape()) feat_dim *= s;
 
     // ✅ 逐个处理每个输入图像
+    cv::Mat resized;
     for (size_t i = 0; i < inputs.size(); ++i) {
         cv::Mat& img = inputs[i];
         if (img.empty()) {
             // 空图：填充零特征
-            auto outTensor = m_net->getSessionOutput(m_session, outName.c_str());
-            size_t feat_dim = 1;
-            for (auto s : outTensor->shape()) feat_dim *= s;
             outputs.push_back(std::vector<float>(feat_dim, 0.0f));
             continue;
         }
 
         // 调整尺寸
-        cv::Mat resized;
         cv::resize(img, resized, cv::Size(width, height)); // 注意：Size(宽, 高)
 
         // 准备输入（NCHW，batch=1）
-        MNN::Tensor inputUser(m_inputTensor, MNN::Tensor::CAFFE);
-        process->convert(
+        slot.process->convert(
             resized.data, width, height, width * 3,
-            inputUser.host<float>(), width, height
+            slot.inputHost->host<float>(), width, height
         );
-        m_inputTensor->copyFromHostTensor(&inputUser);
+        slot.inputTensor->copyFromHostTensor(slot.inputHost.get());
 
         // 推理
-        m_net->runSession(m_session);
+        m_net->runSession(slot.session);
 
         // 获取输出
-        auto outputTensor = m_net->getSessionOutput(m_session, outName.c_str());
-        MNN::Tensor outputUser(outputTensor, MNN::Tensor::CAFFE);
-        outputTensor->copyToHostTensor(&outputUser);
-
-        auto outShape = outputTensor->shape();
-        output_shapes.push_back({outName, outShape});
-
-        size_t total = 1;
-        for (auto s : outputTensor->shape()) 
-            total *= s;
-        std::vector<float> feat(outputUser.host<float>(), outputUser.host<float>() + total);
-        outputs.push_back(std::move(feat));
+        slot.outputTensor->copyToHostTensor(slot.outputHost.get());
+        shapes.push_back({slot.outputName, slot.outputTensor->shape()});
+
+        const float* data = slot.outputHost->host<float>();
+        outputs.emplace_back(data, data + feat_dim);
     }
 
     return 0;
-}
\ No newline at end of file
+}
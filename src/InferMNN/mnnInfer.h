@@ -9,26 +9,66 @@
 #include <vector>
 #include <opencv2/opencv.hpp>
 #include <memory>
+#include <mutex>
+#include <condition_variable>
 
+// 同一个 Interpreter（模型权重只加载一份）创建 num_sessions 个会话组成会话池，
+// 每个会话有自己的输入/输出张量和预处理器。runInference 从池中取一个空闲会话，
+// 用完归还；池中会话全部占用时等待。因此可以从多个线程（多路跟踪）同时调用。
 class MNNInfer 
 {
     public:
-        MNNInfer(std::string modelPath,float mean_[3],float std_[3]); 
+        // num_sessions: 会话池大小，即可同时推理的线程数
+        MNNInfer(std::string modelPath,float mean_[3],float std_[3], int num_sessions = 1); 
         ~MNNInfer();
 
     public:
+        // 最近一次两参数 runInference 的输出形状；多线程调用时请用三参数版本取形状
         std::vector<std::pair<std::string, std::vector<int>>> output_shapes;
         int loadModel();
         int runInference(std::vector<cv::Mat> &inputs, std::vector<std::vector<float>> &outputs);
+        // 线程安全版本：输出形状写入调用方的 shapes
+        int runInference(std::vector<cv::Mat> &inputs, std::vector<std::vector<float>> &outputs,
+                         std::vector<std::pair<std::string, std::vector<int>>> &shapes);
+
+        int numSessions() const { return m_numSessions; }
 
     private:
+        // 会话池中的一个会话（各自独占输入输出张量与预处理器）
+        struct SessionSlot {
+            MNN::Session* session = nullptr;
+            MNN::Tensor* inputTensor = nullptr;
+            MNN::Tensor* outputTensor = nullptr;
+            std::string outputName;
+            std::unique_ptr<MNN::Tensor> inputHost;      // NCHW 主机端输入，逐次复用
+            std::unique_ptr<MNN::Tensor> outputHost;     // NCHW 主机端输出，逐次复用
+            std::shared_ptr<MNN::CV::ImageProcess> process;
+        };
+
+        // 会话租约：构造时取出空闲会话，析构时归还
+        struct Lease {
+            MNNInfer& owner;
+            int id;
+            explicit Lease(MNNInfer& o) : owner(o), id(o._acquire()) {}
+            ~Lease() { owner._release(id); }
+        };
+
+        int _acquire();
+        void _release(int id);
+        int _run(SessionSlot& slot, std::vector<cv::Mat> &inputs, std::vector<std::vector<float>> &outputs,
+                 std::vector<std::pair<std::string, std::vector<int>>> &shapes);
+
         std::string m_modelPath;
         std::shared_ptr<MNN::Interpreter> m_net;
-        MNN::Session* m_session = nullptr;
-        MNN::Tensor* m_inputTensor = nullptr;
+        int m_numSessions;
+        std::vector<SessionSlot> m_sessions;
+        std::vector<int> m_freeSessions;        // 空闲会话下标（栈）
+        std::mutex m_poolMutex;
+        std::condition_variable m_poolCv;
+        std::mutex m_shapesMutex;               // 保护 output_shapes
         float mnn_mean[3];
         float mnn_std[3];
 
 };
 
-#endif // MNN_INFER_H
\ No newline at end of file
+#endif // MNN_INFER_H
@@ -0,0 +1,387 @@
+#include "MotMetrics.h"
+#include "utils/utils.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+constexpr float kMatchIoU = 0.5f;                          // CLEAR / Identity 的匹配阈值
+constexpr double kEps = std::numeric_limits<double>::epsilon();
+
+// MOTChallenge 的干扰类别：车上的人、静止的人、干扰物、倒影
+bool is_distractor(int cls) {
+    return cls == 2 || cls == 7 || cls == 8 || cls == 12;
+}
+
+double hota_alpha(int a) {
+    return 0.05 * (a + 1);
+}
+
+// 在 IoU >= kMatchIoU 的配对上求最优一对一匹配（代价 1 - IoU），结果为 (行, 列)
+void match_by_iou(const std::vector<float>& iou, size_t rows, size_t cols,
+                  const std::vector<bool>* row_skip, const std::vector<bool>* col_skip,
+                  AssignmentWorkspace& ws, std::vector<std::pair<size_t, size_t>>& matches) {
+    SparseCostMatrix cost;
+    cost.reset(static_cast<int>(cols));
+    for (size_t i = 0; i < rows; ++i) {
+        if (!row_skip || !(*row_skip)[i]) {
+            for (size_t j = 0; j < cols; ++j) {
+                if (col_skip && (*col_skip)[j]) continue;
+                if (iou[i * cols + j] >= kMatchIoU) cost.push(static_cast<int>(j), 1.0f - iou[i * cols + j]);
+            }
+        }
+        cost.endRow();
+    }
+    std::vector<size_t> unmatched_rows, unmatched_cols;
+    LinearAssignment(cost, 1.0f - kMatchIoU, AssignmentMode::LAPJV, ws, matches, unmatched_rows, unmatched_cols);
+}
+
+} // namespace
+
+// ==================== 文件读写 ====================
+
+MotSequence LoadMotFile(const std::string& path) {
+    std::ifstream f(path);
+    if (!f) throw std::runtime_error("Failed to open MOT file: " + path);
+
+    MotSequence seq(1);
+    std::string line;
+    size_t line_no = 0;
+    while (std::getline(f, line)) {
+        ++line_no;
+        std::replace(line.begin(), line.end(), ',', ' ');
+        std::istringstream ss(line);
+        std::vector<double> cols;
+        double v;
+        while (ss >> v) cols.push_back(v);
+        if (cols.empty()) continue;
+        if (cols.size() < 6) {
+            throw std::runtime_error(path + ":" + std::to_string(line_no) + ": expected at least 6 columns");
+        }
+
+        const int frame = static_cast<int>(cols[0]);
+        if (frame < 1) continue;
+        MotEntry e;
+        e.id = static_cast<int>(cols[1]);
+        e.box = cv::Rect_<float>(static_cast<float>(cols[2]), static_cast<float>(cols[3]),
+                                 static_cast<float>(cols[4]), static_cast<float>(cols[5]));
+        if (cols.size() > 6) e.score = static_cast<float>(cols[6]);
+        if (cols.size() > 7) e.cls = static_cast<int>(cols[7]);
+        if (cols.size() > 8) e.visibility = static_cast<float>(cols[8]);
+        if (seq.size() <= static_cast<size_t>(frame)) seq.resize(frame + 1);
+        seq[frame].push_back(e);
+    }
+    return seq;
+}
+
+void SaveMotFile(const std::string& path, const MotSequence& seq) {
+    std::ofstream f(path, std::ios::trunc);
+    if (!f) throw std::runtime_error("Failed to write MOT file: " + path);
+    f << std::fixed << std::setprecision(2);
+    for (size_t frame = 1; frame < seq.size(); ++frame) {
+        for (const MotEntry& e : seq[frame]) {
+            f << frame << "," << e.id << "," << e.box.x << "," << e.box.y << ","
+              << e.box.width << "," << e.box.height << ",1,-1,-1,-1\n";
+        }
+    }
+    if (!f) throw std::runtime_error("Failed to write MOT file: " + path);
+}
+
+// ==================== MotSummary ====================
+
+double MotSummary::mota() const {
+    return num_gt == 0 ? 0.0 : 1.0 - static_cast<double>(fn + fp + idsw) / num_gt;
+}
+
+double MotSummary::motp() const {
+    return tp == 0 ? 0.0 : iou_sum / tp;
+}
+
+double MotSummary::idf1() const {
+    return num_gt + num_tracker == 0 ? 0.0 : 2.0 * idtp / (num_gt + num_tracker);
+}
+
+double MotSummary::idp() const {
+    return num_tracker == 0 ? 0.0 : static_cast<double>(idtp) / num_tracker;
+}
+
+double MotSummary::idr() const {
+    return num_gt == 0 ? 0.0 : static_cast<double>(idtp) / num_gt;
+}
+
+double MotSummary::hotaAt(int a) const {
+    double det = hota_tp[a] / std::max(1.0, hota_tp[a] + hota_fn[a] + hota_fp[a]);
+    double ass = ass_sum[a] / std::max(1.0, hota_tp[a]);
+    return std::sqrt(det * ass);
+}
+
+double MotSummary::detA() const {
+    double s = 0.0;
+    for (int a = 0; a < kHotaAlphas; ++a) s += hota_tp[a] / std::max(1.0, hota_tp[a] + hota_fn[a] + hota_fp[a]);
+    return s / kHotaAlphas;
+}
+
+double MotSummary::assA() const {
+    double s = 0.0;
+    for (int a = 0; a < kHotaAlphas; ++a) s += ass_sum[a] / std::max(1.0, hota_tp[a]);
+    return s / kHotaAlphas;
+}
+
+double MotSummary::locA() const {
+    double s = 0.0;
+    for (int a = 0; a < kHotaAlphas; ++a) s += hota_tp[a] > 0 ? loc_sum[a] / hota_tp[a] : 1.0;
+    return s / kHotaAlphas;
+}
+
+double MotSummary::hota() const {
+    double s = 0.0;
+    for (int a = 0; a < kHotaAlphas; ++a) s += hotaAt(a);
+    return s / kHotaAlphas;
+}
+
+MotSummary& MotSummary::operator+=(const MotSummary& o) {
+    num_frames += o.num_frames;
+    num_gt += o.num_gt;
+    num_tracker += o.num_tracker;
+    tp += o.tp;
+    fp += o.fp;
+    fn += o.fn;
+    idsw += o.idsw;
+    iou_sum += o.iou_sum;
+    num_gt_ids += o.num_gt_ids;
+    mostly_tracked += o.mostly_tracked;
+    mostly_lost += o.mostly_lost;
+    idtp += o.idtp;
+    for (int a = 0; a < kHotaAlphas; ++a) {
+        hota_tp[a] += o.hota_tp[a];
+        hota_fn[a] += o.hota_fn[a];
+        hota_fp[a] += o.hota_fp[a];
+        ass_sum[a] += o.ass_sum[a];
+        loc_sum[a] += o.loc_sum[a];
+    }
+    return *this;
+}
+
+// ==================== MotEvaluator ====================
+
+MotEvaluator::MotEvaluator(bool mot_challenge_rules) : mot_challenge_rules_(mot_challenge_rules) {}
+
+int MotEvaluator::_compact_id(std::unordered_map<int, int>& map, int id) {
+    auto it = map.find(id);
+    if (it != map.end()) return it->second;
+    const int compact = static_cast<int>(map.size());
+    map.emplace(id, compact);
+    return compact;
+}
+
+void MotEvaluator::addFrame(const std::vector<MotEntry>& gt, const std::vector<MotEntry>& tracks) {
+    std::vector<bool> keep_track(tracks.size(), true);
+    std::vector<bool> keep_gt(gt.size(), true);
+
+    if (mot_challenge_rules_) {
+        // 与干扰类别 gt 匹配上的跟踪框不计入（既不算 TP 也不算 FP）
+        bool any_distractor = false;
+        for (const MotEntry& g : gt) any_distractor |= is_distractor(g.cls);
+        if (any_distractor && !tracks.empty()) {
+            std::vector<float> iou(gt.size() * tracks.size());
+            for (size_t i = 0; i < gt.size(); ++i) {
+                for (size_t j = 0; j < tracks.size(); ++j) iou[i * tracks.size() + j] = CalculateIoU(gt[i].box, tracks[j].box);
+            }
+            AssignmentWorkspace ws;
+            std::vector<std::pair<size_t, size_t>> matches;
+            match_by_iou(iou, gt.size(), tracks.size(), nullptr, nullptr, ws, matches);
+            for (const auto& [i, j] : matches) {
+                if (is_distractor(gt[i].cls)) keep_track[j] = false;
+            }
+        }
+        // gt 只保留考虑标记不为 0 的行人
+        for (size_t i = 0; i < gt.size(); ++i) keep_gt[i] = gt[i].cls == 1 && gt[i].score != 0.0f;
+    }
+
+    Frame frame;
+    std::vector<const cv::Rect_<float>*> gt_boxes, tr_boxes;
+    for (size_t i = 0; i < gt.size(); ++i) {
+        if (!keep_gt[i]) continue;
+        frame.gt_ids.push_back(_compact_id(gt_id_map_, gt[i].id));
+        gt_boxes.push_back(&gt[i].box);
+    }
+    for (size_t j = 0; j < tracks.size(); ++j) {
+        if (!keep_track[j]) continue;
+        frame.tr_ids.push_back(_compact_id(tr_id_map_, tracks[j].id));
+        tr_boxes.push_back(&tracks[j].box);
+    }
+    frame.iou.resize(gt_boxes.size() * tr_boxes.size());
+    for (size_t i = 0; i < gt_boxes.size(); ++i) {
+        for (size_t j = 0; j < tr_boxes.size(); ++j) {
+            frame.iou[i * tr_boxes.size() + j] = CalculateIoU(*gt_boxes[i], *tr_boxes[j]);
+        }
+    }
+    frames_.push_back(std::move(frame));
+}
+
+void MotEvaluator::addSequence(const MotSequence& gt, const MotSequence& tracks) {
+    const std::vector<MotEntry> empty;
+    const size_t n = std::max(gt.size(), tracks.size());
+    for (size_t f = 1; f < n; ++f) {
+        addFrame(f < gt.size() ? gt[f] : empty, f < tracks.size() ? tracks[f] : empty);
+    }
+}
+
+MotSummary MotEvaluator::compute() const {
+    MotSummary s;
+    s.num_frames = frames_.size();
+    const size_t num_gt_ids = gt_id_map_.size();
+    const size_t num_tr_ids = tr_id_map_.size();
+    s.num_gt_ids = num_gt_ids;
+    auto key = [num_tr_ids](int g, int t) { return static_cast<uint64_t>(g) * num_tr_ids + t; };
+
+    AssignmentWorkspace ws;
+    std::vector<std::pair<size_t, size_t>> matches;
+    std::vector<size_t> unmatched_rows, unmatched_cols;
+    SparseCostMatrix cost;
+
+    // ---- 第一遍：CLEAR MOT、Identity 的共现计数、HOTA 的全局对齐累计 ----
+    std::vector<int> last_match(num_gt_ids, -1);               // gt 轨迹最近一次匹配的跟踪轨迹
+    std::vector<size_t> gt_count(num_gt_ids, 0), gt_tracked(num_gt_ids, 0), tr_count(num_tr_ids, 0);
+    std::unordered_map<uint64_t, int> id_pairs;                 // IoU >= 0.5 的共现帧数
+    std::unordered_map<uint64_t, double> potential;             // HOTA：Σ 逐帧归一化相似度
+    std::vector<bool> gt_used, tr_used;
+    std::vector<double> row_sum, col_sum;
+
+    for (const Frame& fr : frames_) {
+        const size_t n = fr.gt_ids.size(), m = fr.tr_ids.size();
+        s.num_gt += n;
+        s.num_tracker += m;
+        for (int g : fr.gt_ids) gt_count[g]++;
+        for (int t : fr.tr_ids) tr_count[t]++;
+
+        // CLEAR：先保留上一次的对应关系（仍满足 IoU 阈值时），其余再做最优匹配
+        gt_used.assign(n, false);
+        tr_used.assign(m, false);
+        size_t frame_tp = 0;
+        auto accept = [&](size_t i, size_t j) {
+            const int g = fr.gt_ids[i], t = fr.tr_ids[j];
+            if (last_match[g] >= 0 && last_match[g] != t) s.idsw++;
+            last_match[g] = t;
+            gt_used[i] = tr_used[j] = true;
+            gt_tracked[g]++;
+            s.iou_sum += fr.iou[i * m + j];
+            frame_tp++;
+        };
+        for (size_t i = 0; i < n; ++i) {
+            const int g = fr.gt_ids[i];
+            if (last_match[g] < 0) continue;
+            for (size_t j = 0; j < m; ++j) {
+                if (!tr_used[j] && fr.tr_ids[j] == last_match[g] && fr.iou[i * m + j] >= kMatchIoU) {
+                    accept(i, j);
+                    break;
+                }
+            }
+        }
+        match_by_iou(fr.iou, n, m, &gt_used, &tr_used, ws, matches);
+        for (const auto& [i, j] : matches) accept(i, j);
+        s.tp += frame_tp;
+        s.fn += n - frame_tp;
+        s.fp += m - frame_tp;
+
+        // Identity 与 HOTA 的全局统计
+        row_sum.assign(n, 0.0);
+        col_sum.assign(m, 0.0);
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < m; ++j) {
+                const float iou = fr.iou[i * m + j];
+                row_sum[i] += iou;
+                col_sum[j] += iou;
+                if (iou >= kMatchIoU) id_pairs[key(fr.gt_ids[i], fr.tr_ids[j])]++;
+            }
+        }
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < m; ++j) {
+                const double iou = fr.iou[i * m + j];
+                const double denom = row_sum[i] + col_sum[j] - iou;
+                if (iou > 0.0 && denom > kEps) potential[key(fr.gt_ids[i], fr.tr_ids[j])] += iou / denom;
+            }
+        }
+    }
+
+    for (size_t g = 0; g < num_gt_ids; ++g) {
+        const double ratio = gt_count[g] ? static_cast<double>(gt_tracked[g]) / gt_count[g] : 0.0;
+        if (ratio > 0.8) s.mostly_tracked++;
+        if (ratio < 0.2) s.mostly_lost++;
+    }
+
+    // ---- Identity：gt 轨迹与跟踪轨迹的一对一全局分配，最大化共现帧数 ----
+    // 代价取 K - 共现帧数（K 大于所有计数，全为正），阈值 K：最小化 Σ(代价 - K) 即最大化 Σ 共现帧数
+    if (!id_pairs.empty()) {
+        std::vector<std::vector<std::pair<int, int>>> rows(num_gt_ids);
+        int max_count = 0;
+        for (const auto& [k, c] : id_pairs) {
+            rows[k / num_tr_ids].emplace_back(static_cast<int>(k % num_tr_ids), c);
+            max_count = std::max(max_count, c);
+        }
+        const float K = static_cast<float>(max_count + 1);
+        cost.reset(static_cast<int>(num_tr_ids));
+        for (auto& row : rows) {
+            std::sort(row.begin(), row.end());
+            for (const auto& [t, c] : row) cost.push(t, K - static_cast<float>(c));
+            cost.endRow();
+        }
+        LinearAssignment(cost, K, AssignmentMode::LAPJV, ws, matches, unmatched_rows, unmatched_cols);
+        for (const auto& [g, t] : matches) s.idtp += id_pairs[key(static_cast<int>(g), static_cast<int>(t))];
+    }
+
+    // ---- HOTA：按全局对齐得分加权的逐帧匹配，19 个 α 共用一次分配 ----
+    std::unordered_map<uint64_t, std::array<int, kHotaAlphas>> hota_matches;
+    for (const Frame& fr : frames_) {
+        const size_t n = fr.gt_ids.size(), m = fr.tr_ids.size();
+        for (int a = 0; a < kHotaAlphas; ++a) {
+            s.hota_fn[a] += n;
+            s.hota_fp[a] += m;
+        }
+        if (n == 0 || m == 0) continue;
+
+        cost.reset(static_cast<int>(m));
+        for (size_t i = 0; i < n; ++i) {
+            const int g = fr.gt_ids[i];
+            for (size_t j = 0; j < m; ++j) {
+                const float iou = fr.iou[i * m + j];
+                if (iou <= 0.0f) continue;
+                const int t = fr.tr_ids[j];
+                auto it = potential.find(key(g, t));
+                if (it == potential.end()) continue;
+                const double align = it->second / (gt_count[g] + tr_count[t] - it->second);
+                const float score = static_cast<float>(align * iou);
+                if (score > 0.0f) cost.push(static_cast<int>(j), 1.0f - score);
+            }
+            cost.endRow();
+        }
+        LinearAssignment(cost, 1.0f, AssignmentMode::LAPJV, ws, matches, unmatched_rows, unmatched_cols);
+        for (const auto& [i, j] : matches) {
+            const double iou = fr.iou[i * m + j];
+            auto& counts = hota_matches[key(fr.gt_ids[i], fr.tr_ids[j])];
+            for (int a = 0; a < kHotaAlphas; ++a) {
+                if (iou < hota_alpha(a) - kEps) continue;
+                s.hota_tp[a] += 1.0;
+                s.hota_fn[a] -= 1.0;
+                s.hota_fp[a] -= 1.0;
+                s.loc_sum[a] += iou;
+                counts[a]++;
+            }
+        }
+    }
+    // 关联得分：每个匹配对 (g, t) 的 A = 共同匹配帧数 / (g 的帧数 + t 的帧数 - 共同匹配帧数)，按匹配帧数加权
+    for (const auto& [k, counts] : hota_matches) {
+        const size_t g = k / num_tr_ids, t = k % num_tr_ids;
+        for (int a = 0; a < kHotaAlphas; ++a) {
+            const double c = counts[a];
+            if (c == 0) continue;
+            s.ass_sum[a] += c * c / (gt_count[g] + tr_count[t] - c);
+        }
+    }
+    return s;
+}
@@ -0,0 +1,94 @@
+#ifndef MOT_METRICS_H
+#define MOT_METRICS_H
+
+#include <array>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <opencv2/core.hpp>
+
+// ==================== MOTChallenge 格式 ====================
+// 每行：frame, id, x, y, w, h, conf, [class, visibility]（det.txt 的 id 为 -1；gt.txt 的 conf 为 0/1 标记）
+struct MotEntry {
+    int id = -1;
+    cv::Rect_<float> box;            // tlwh
+    float score = 1.0f;              // 检测置信度 / gt 的考虑标记（0 为忽略）
+    int cls = 1;                     // gt 类别（1 为行人）；缺省列按行人处理
+    float visibility = 1.0f;
+};
+
+// 下标为帧号（1-based），frames[0] 恒为空
+using MotSequence = std::vector<std::vector<MotEntry>>;
+
+// 读取 MOT 格式文件；文件不存在或某行少于 6 列时抛出 std::runtime_error
+MotSequence LoadMotFile(const std::string& path);
+// 写出跟踪结果：frame, id, x, y, w, h, 1, -1, -1, -1
+void SaveMotFile(const std::string& path, const MotSequence& seq);
+
+// ==================== 评测结果 ====================
+constexpr int kHotaAlphas = 19;      // HOTA 的定位阈值 α = 0.05, 0.10, ..., 0.95
+
+struct MotSummary {
+    // CLEAR MOT（IoU >= 0.5 为匹配）
+    size_t num_frames = 0;
+    size_t num_gt = 0;               // gt 框总数
+    size_t num_tracker = 0;          // 跟踪框总数（去掉与干扰项匹配的之后）
+    size_t tp = 0, fp = 0, fn = 0, idsw = 0;
+    double iou_sum = 0.0;            // 匹配对的 IoU 之和（MOTP）
+    size_t num_gt_ids = 0;
+    size_t mostly_tracked = 0;       // 被跟踪帧数 > 80% 的 gt 轨迹
+    size_t mostly_lost = 0;          // 被跟踪帧数 < 20% 的 gt 轨迹
+
+    // Identity（全局 gt 轨迹 ↔ 跟踪轨迹一对一分配）
+    size_t idtp = 0;
+
+    // HOTA（每个 α 一组）
+    std::array<double, kHotaAlphas> hota_tp{}, hota_fn{}, hota_fp{};
+    std::array<double, kHotaAlphas> ass_sum{};   // Σ 匹配的关联得分（AssA * TP）
+    std::array<double, kHotaAlphas> loc_sum{};   // Σ 匹配的 IoU（LocA * TP）
+
+    double mota() const;
+    double motp() const;
+    double idf1() const;
+    double idp() const;
+    double idr() const;
+    double detA() const;
+    double assA() const;
+    double locA() const;
+    double hota() const;
+    // 第 a 个 α 上的 HOTA
+    double hotaAt(int a) const;
+
+    // 合并多个序列（计数相加；HOTA 的 AssA / LocA 按 TP 加权）
+    MotSummary& operator+=(const MotSummary& other);
+};
+
+// ==================== 评测器 ====================
+// 逐帧送入 gt 和跟踪结果，最后一次性计算 CLEAR MOT（MOTA）、Identity（IDF1）和 HOTA。
+// mot_challenge_rules = true 时按 MOTChallenge 的预处理：与干扰类别（骑车/车上的人、静止的人、
+// 干扰物、倒影）的 gt 匹配上的跟踪框不计入，gt 只保留考虑标记不为 0 的行人。
+class MotEvaluator {
+    public:
+        explicit MotEvaluator(bool mot_challenge_rules = true);
+
+        void addFrame(const std::vector<MotEntry>& gt, const std::vector<MotEntry>& tracks);
+        // 整段序列（gt 与 tracks 的帧数可以不同，按较长者对齐）
+        void addSequence(const MotSequence& gt, const MotSequence& tracks);
+
+        MotSummary compute() const;
+
+    private:
+        struct Frame {
+            std::vector<int> gt_ids, tr_ids;     // 压缩后的编号（0..num_gt_ids-1 / 0..num_tr_ids-1）
+            std::vector<float> iou;              // gt x tracker 行优先
+        };
+
+        // 原始 ID -> 压缩编号（首次出现时分配）
+        static int _compact_id(std::unordered_map<int, int>& map, int id);
+
+        bool mot_challenge_rules_;
+        std::vector<Frame> frames_;
+        std::unordered_map<int, int> gt_id_map_, tr_id_map_;
+};
+
+#endif // MOT_METRICS_H
@@ -0,0 +1,370 @@
+#include "ReidGallery.h"
+#include "utils/utils.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <queue>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+struct ReidGallery::FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t dim;
+    uint32_t M;
+    uint32_t max_upper_levels;
+    uint64_t record_bytes;
+    uint64_t capacity;
+    uint64_t count;            // 已完整写入的节点数（最后更新）
+    int32_t entry_point;
+    int32_t max_level;
+};
+
+struct ReidGallery::NodeMeta {
+    int32_t level;
+    int32_t camera_id;
+    int32_t track_id;
+    int32_t reserved;
+    int64_t frame;
+};
+
+namespace {
+
+const char kMagic[8] = {'R', 'E', 'I', 'D', 'G', 'A', 'L', '1'};
+const uint32_t kVersion = 1;
+
+size_t align_up(size_t n, size_t a) { return (n + a - 1) / a * a; }
+
+// 每个线程一份访问标记，按 tag 区分不同次搜索，避免每次清零
+struct VisitedList {
+    std::vector<uint32_t> marks;
+    uint32_t tag = 0;
+};
+
+VisitedList& visited_list(size_t n) {
+    thread_local VisitedList v;
+    if (v.marks.size() < n) v.marks.resize(n, 0);
+    if (++v.tag == 0) {
+        std::fill(v.marks.begin(), v.marks.end(), 0);
+        v.tag = 1;
+    }
+    return v;
+}
+
+} // namespace
+
+ReidGallery::ReidGallery(const std::string& path, const ReidGalleryConfig& config)
+    : path_(path),
+      dim_(config.dim),
+      ef_construction_(config.ef_construction),
+      ef_search_(config.ef_search),
+      rng_(100) {
+    if (dim_ == 0 || config.M < 2) {
+        throw std::invalid_argument("ReidGallery: dim must be > 0 and M >= 2");
+    }
+
+    size_t existing = 0;
+    if (!path_.empty()) {
+        fd_ = ::open(path_.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd_ < 0) throw std::runtime_error("ReidGallery: cannot open " + path_);
+        struct stat st;
+        if (::fstat(fd_, &st) != 0) throw std::runtime_error("ReidGallery: cannot stat " + path_);
+        existing = static_cast<size_t>(st.st_size);
+    }
+
+    if (existing >= kHeaderBytes) {
+        // 打开已有文件：图参数以文件头为准
+        FileHeader h;
+        if (::pread(fd_, &h, sizeof(h), 0) != static_cast<ssize_t>(sizeof(h)) ||
+            std::memcmp(h.magic, kMagic, sizeof(kMagic)) != 0 || h.version != kVersion) {
+            ::close(fd_);
+            throw std::runtime_error("ReidGallery: " + path_ + " is not a gallery file");
+        }
+        if (h.dim != dim_) {
+            ::close(fd_);
+            throw std::runtime_error("ReidGallery: " + path_ + " has feature dim " + std::to_string(h.dim));
+        }
+        _layout(static_cast<int>(h.M));
+        if (h.record_bytes != record_bytes_ || h.max_upper_levels != kMaxUpperLevels ||
+            existing < kHeaderBytes + h.capacity * record_bytes_) {
+            ::close(fd_);
+            throw std::runtime_error("ReidGallery: " + path_ + " is truncated or has a different layout");
+        }
+        _map(existing);
+        return;
+    }
+
+    // 新建
+    _layout(config.M);
+    const size_t capacity = std::max<size_t>(config.initial_capacity, 1);
+    const size_t bytes = kHeaderBytes + capacity * record_bytes_;
+    if (fd_ >= 0 && ::ftruncate(fd_, static_cast<off_t>(bytes)) != 0) {
+        ::close(fd_);
+        throw std::runtime_error("ReidGallery: cannot resize " + path_);
+    }
+    _map(bytes);
+
+    FileHeader* h = _header();
+    std::memcpy(h->magic, kMagic, sizeof(kMagic));
+    h->version = kVersion;
+    h->dim = static_cast<uint32_t>(dim_);
+    h->M = static_cast<uint32_t>(M_);
+    h->max_upper_levels = kMaxUpperLevels;
+    h->record_bytes = record_bytes_;
+    h->capacity = capacity;
+    h->count = 0;
+    h->entry_point = -1;
+    h->max_level = -1;
+}
+
+ReidGallery::~ReidGallery() {
+    if (data_) {
+        if (fd_ >= 0) ::msync(data_, mapped_bytes_, MS_SYNC);
+        ::munmap(data_, mapped_bytes_);
+    }
+    if (fd_ >= 0) ::close(fd_);
+}
+
+void ReidGallery::_layout(int M) {
+    M_ = M;
+    M0_ = 2 * M;
+    meta_offset_ = align_up(dim_ * sizeof(float), 8);
+    links0_offset_ = meta_offset_ + sizeof(NodeMeta);
+    upper_offset_ = links0_offset_ + (1 + M0_) * sizeof(uint32_t);
+    record_bytes_ = align_up(upper_offset_ + kMaxUpperLevels * (1 + M_) * sizeof(uint32_t), 64);
+    level_mult_ = 1.0 / std::log(static_cast<double>(M_));
+}
+
+void ReidGallery::_map(size_t bytes) {
+    void* p;
+    if (!data_) {
+        p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                   fd_ >= 0 ? MAP_SHARED : (MAP_PRIVATE | MAP_ANONYMOUS), fd_, 0);
+    } else {
+        p = ::mremap(data_, mapped_bytes_, bytes, MREMAP_MAYMOVE);
+    }
+    if (p == MAP_FAILED) throw std::runtime_error("ReidGallery: mmap failed");
+    data_ = static_cast<char*>(p);
+    mapped_bytes_ = bytes;
+}
+
+void ReidGallery::_grow() {
+    const size_t capacity = _header()->capacity * 2;
+    const size_t bytes = kHeaderBytes + capacity * record_bytes_;
+    if (fd_ >= 0 && ::ftruncate(fd_, static_cast<off_t>(bytes)) != 0) {
+        throw std::runtime_error("ReidGallery: cannot resize " + path_);
+    }
+    _map(bytes);
+    _header()->capacity = capacity;
+}
+
+ReidGallery::NodeMeta* ReidGallery::_meta(uint32_t id) const {
+    return reinterpret_cast<NodeMeta*>(data_ + kHeaderBytes + id * record_bytes_ + meta_offset_);
+}
+
+uint32_t* ReidGallery::_links(uint32_t id, int level) const {
+    char* node = data_ + kHeaderBytes + id * record_bytes_;
+    if (level == 0) return reinterpret_cast<uint32_t*>(node + links0_offset_);
+    return reinterpret_cast<uint32_t*>(node + upper_offset_) + (level - 1) * (1 + M_);
+}
+
+int ReidGallery::_random_level() {
+    std::uniform_real_distribution<double> u(0.0, 1.0);
+    int level = static_cast<int>(-std::log(std::max(u(rng_), 1e-12)) * level_mult_);
+    return std::min(level, kMaxUpperLevels);
+}
+
+float ReidGallery::_distance(const float* a, uint32_t id) const {
+    return NormalizedCosineDistance(a, _vector(id), dim_);
+}
+
+size_t ReidGallery::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return _header()->count;
+}
+
+size_t ReidGallery::mappedBytes() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return mapped_bytes_;
+}
+
+void ReidGallery::flush() {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    if (fd_ >= 0) ::msync(data_, mapped_bytes_, MS_SYNC);
+}
+
+uint32_t ReidGallery::_greedy(const float* q, uint32_t ep, int from_level, int to_level) const {
+    float best = _distance(q, ep);
+    for (int level = from_level; level >= to_level; --level) {
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            const uint32_t* links = _links(ep, level);
+            for (uint32_t k = 1; k <= links[0]; ++k) {
+                float d = _distance(q, links[k]);
+                if (d < best) {
+                    best = d;
+                    ep = links[k];
+                    changed = true;
+                }
+            }
+        }
+    }
+    return ep;
+}
+
+void ReidGallery::_search_layer(const float* q, uint32_t ep, int ef, int level,
+                                std::vector<Candidate>& out) const {
+    VisitedList& visited = visited_list(_header()->count + 1);
+    std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> candidates;  // 小顶堆
+    std::priority_queue<Candidate> results;                                                     // 大顶堆
+
+    float d = _distance(q, ep);
+    candidates.emplace(d, ep);
+    results.emplace(d, ep);
+    visited.marks[ep] = visited.tag;
+
+    while (!candidates.empty()) {
+        Candidate c = candidates.top();
+        if (c.first > results.top().first && results.size() >= static_cast<size_t>(ef)) break;
+        candidates.pop();
+
+        const uint32_t* links = _links(c.second, level);
+        for (uint32_t k = 1; k <= links[0]; ++k) {
+            const uint32_t n = links[k];
+            if (visited.marks[n] == visited.tag) continue;
+            visited.marks[n] = visited.tag;
+            float dn = _distance(q, n);
+            if (results.size() < static_cast<size_t>(ef) || dn < results.top().first) {
+                candidates.emplace(dn, n);
+                results.emplace(dn, n);
+                if (results.size() > static_cast<size_t>(ef)) results.pop();
+            }
+        }
+    }
+
+    out.resize(results.size());
+    for (size_t k = out.size(); k-- > 0;) {
+        out[k] = results.top();
+        results.pop();
+    }
+}
+
+void ReidGallery::_select_neighbors(std::vector<Candidate>& candidates, int m) const {
+    if (candidates.size() <= static_cast<size_t>(m)) return;
+    std::vector<Candidate> selected;
+    selected.reserve(m);
+    for (const auto& c : candidates) {
+        if (selected.size() >= static_cast<size_t>(m)) break;
+        // c 离某个已选邻居比离目标更近时，它已能经由该邻居到达，不再单独连边
+        const float* v = _vector(c.second);
+        bool keep = true;
+        for (const auto& s : selected) {
+            if (_distance(v, s.second) < c.first) {
+                keep = false;
+                break;
+            }
+        }
+        if (keep) selected.push_back(c);
+    }
+    candidates.swap(selected);
+}
+
+void ReidGallery::_connect(uint32_t id, uint32_t neighbor, int level) {
+    uint32_t* links = _links(id, level);
+    const uint32_t max_links = level == 0 ? M0_ : M_;
+    if (links[0] < max_links) {
+        links[1 + links[0]++] = neighbor;
+        return;
+    }
+
+    // 邻居表已满：在原邻居和新邻居中重新选邻
+    const float* v = _vector(id);
+    std::vector<Candidate> candidates;
+    candidates.reserve(max_links + 1);
+    candidates.emplace_back(_distance(v, neighbor), neighbor);
+    for (uint32_t k = 1; k <= links[0]; ++k) candidates.emplace_back(_distance(v, links[k]), links[k]);
+    std::sort(candidates.begin(), candidates.end());
+    _select_neighbors(candidates, max_links);
+    links[0] = static_cast<uint32_t>(candidates.size());
+    for (size_t k = 0; k < candidates.size(); ++k) links[1 + k] = candidates[k].second;
+}
+
+uint32_t ReidGallery::add(const float* feature, const GalleryRecord& record) {
+    std::lock_guard<std::mutex> gate(write_gate_);
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (_header()->count >= _header()->capacity) _grow();
+
+    FileHeader* h = _header();
+    const uint32_t id = static_cast<uint32_t>(h->count);
+    const int level = _random_level();
+
+    std::memcpy(const_cast<float*>(_vector(id)), feature, dim_ * sizeof(float));
+    NodeMeta* meta = _meta(id);
+    meta->level = level;
+    meta->camera_id = record.camera_id;
+    meta->track_id = record.track_id;
+    meta->reserved = 0;
+    meta->frame = record.frame;
+    for (int l = 0; l <= level; ++l) _links(id, l)[0] = 0;
+
+    if (h->entry_point < 0) {
+        h->entry_point = static_cast<int32_t>(id);
+        h->max_level = level;
+        h->count = id + 1;
+        return id;
+    }
+
+    const float* q = _vector(id);
+    const int top = h->max_level;
+    uint32_t ep = _greedy(q, static_cast<uint32_t>(h->entry_point), top, level + 1);
+
+    std::vector<Candidate> nearest;
+    for (int l = std::min(level, top); l >= 0; --l) {
+        _search_layer(q, ep, ef_construction_, l, nearest);
+        ep = nearest.front().second;
+        _select_neighbors(nearest, M_);
+
+        uint32_t* links = _links(id, l);
+        links[0] = static_cast<uint32_t>(nearest.size());
+        for (size_t k = 0; k < nearest.size(); ++k) {
+            links[1 + k] = nearest[k].second;
+            _connect(nearest[k].second, id, l);
+        }
+    }
+
+    if (level > top) {
+        h->entry_point = static_cast<int32_t>(id);
+        h->max_level = level;
+    }
+    h->count = id + 1;   // 节点写完后才计入，重新打开文件时不会读到写了一半的节点
+    return id;
+}
+
+void ReidGallery::search(const float* feature, size_t k, std::vector<GalleryMatch>& out) const {
+    out.clear();
+    std::unique_lock<std::mutex> gate(write_gate_);
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    gate.unlock();
+    const FileHeader* h = _header();
+    if (h->entry_point < 0 || k == 0) return;
+
+    uint32_t ep = _greedy(feature, static_cast<uint32_t>(h->entry_point), h->max_level, 1);
+    std::vector<Candidate> nearest;
+    _search_layer(feature, ep, std::max<int>(ef_search_, static_cast<int>(k)), 0, nearest);
+
+    const size_t n = std::min(k, nearest.size());
+    out.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        const NodeMeta* meta = _meta(nearest[i].second);
+        out[i].index = nearest[i].second;
+        out[i].record.camera_id = meta->camera_id;
+        out[i].record.track_id = meta->track_id;
+        out[i].record.frame = meta->frame;
+        out[i].distance = nearest[i].first;
+    }
+}
@@ -0,0 +1,112 @@
+#ifndef REID_GALLERY_H
+#define REID_GALLERY_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <random>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+
+// ==================== 入库特征的来源 ====================
+struct GalleryRecord {
+    int32_t camera_id = 0;     // 摄像头（路）编号
+    int32_t track_id = 0;      // 该路内的轨迹 ID
+    int64_t frame = 0;         // 入库时该路的帧号
+};
+
+// 检索结果：距离 = 1 - 余弦相似度，升序
+struct GalleryMatch {
+    uint32_t index = 0;        // 库内编号（入库顺序）
+    GalleryRecord record;
+    float distance = 0.0f;
+};
+
+struct ReidGalleryConfig {
+    size_t dim = 512;              // 特征维度（已 L2 归一化的 ReID 特征）
+    int M = 16;                    // 上层每个节点的最大邻居数，第 0 层为 2M
+    int ef_construction = 200;     // 建图时的候选集大小
+    int ef_search = 64;            // 检索时的候选集大小（至少为 k）
+    size_t initial_capacity = 4096;
+};
+
+// ==================== 跨摄像头 ReID 特征库 ====================
+// HNSW 近似最近邻索引，存放在一个内存映射文件中：
+//   [文件头 4KB][节点 0][节点 1]...   每个节点定长：特征 | 来源 | 第 0 层邻居 | 上层邻居
+// 节点按入库顺序追加，写完节点后才更新文件头中的计数，重启时直接 mmap 打开，无需重建索引。
+// 容量不足时文件按 2 倍扩展并重新映射。
+// 并发：检索持共享锁、可并行；入库持独占锁，与检索互斥。入库排队时新的检索先等待，
+// 避免检索不断时入库饿死。
+class ReidGallery {
+    public:
+        // path 为空时使用匿名内存（不持久化）；文件存在时打开（图参数以文件为准，dim 不一致抛异常），否则新建
+        explicit ReidGallery(const std::string& path = "", const ReidGalleryConfig& config = ReidGalleryConfig());
+        ~ReidGallery();
+
+        ReidGallery(const ReidGallery&) = delete;
+        ReidGallery& operator=(const ReidGallery&) = delete;
+
+        // 入库一个已 L2 归一化的特征（dim() 个 float），返回库内编号
+        uint32_t add(const float* feature, const GalleryRecord& record);
+
+        // 检索与 feature 最近的 k 个特征，按距离升序写入 out
+        void search(const float* feature, size_t k, std::vector<GalleryMatch>& out) const;
+
+        void setEfSearch(int ef) { ef_search_ = ef; }
+        size_t size() const;
+        size_t dim() const { return dim_; }
+        // 映射的字节数（文件大小）
+        size_t mappedBytes() const;
+
+        // 把映射内容同步到文件
+        void flush();
+
+    private:
+        struct FileHeader;
+        struct NodeMeta;
+        using Candidate = std::pair<float, uint32_t>;   // (距离, 节点)
+
+        static constexpr int kMaxUpperLevels = 4;       // 上层最多 4 层（M=16 时约百万分之一的节点会被截断）
+        static constexpr size_t kHeaderBytes = 4096;
+
+        FileHeader* _header() const { return reinterpret_cast<FileHeader*>(data_); }
+        const float* _vector(uint32_t id) const {
+            return reinterpret_cast<const float*>(data_ + kHeaderBytes + id * record_bytes_);
+        }
+        NodeMeta* _meta(uint32_t id) const;
+        // 节点在第 level 层的邻居表：[0] 为邻居数，其后为邻居编号
+        uint32_t* _links(uint32_t id, int level) const;
+
+        void _layout(int M);
+        void _map(size_t bytes);
+        void _grow();
+        int _random_level();
+
+        float _distance(const float* a, uint32_t id) const;
+        uint32_t _greedy(const float* q, uint32_t ep, int from_level, int to_level) const;
+        // 在第 level 层从 ep 出发做 best-first 搜索，返回最近的 ef 个节点（升序）
+        void _search_layer(const float* q, uint32_t ep, int ef, int level, std::vector<Candidate>& out) const;
+        // HNSW 启发式选邻：候选按距离升序，保留不被已选邻居“遮挡”的至多 m 个
+        void _select_neighbors(std::vector<Candidate>& candidates, int m) const;
+        void _connect(uint32_t id, uint32_t neighbor, int level);
+
+        std::string path_;
+        int fd_ = -1;
+        char* data_ = nullptr;
+        size_t mapped_bytes_ = 0;
+
+        size_t dim_;
+        int M_ = 16, M0_ = 32;
+        int ef_construction_;
+        std::atomic<int> ef_search_;
+        size_t meta_offset_ = 0, links0_offset_ = 0, upper_offset_ = 0, record_bytes_ = 0;
+        double level_mult_ = 0.0;
+        std::mt19937 rng_;
+
+        mutable std::shared_mutex mutex_;
+        mutable std::mutex write_gate_;                 // 入库方持有期间，新的检索不能拿到共享锁
+};
+
+#endif // REID_GALLERY_H
@@ -2,39 +2,144 @@
 #define KALMAN_FILTER_H
 
 #include <Eigen/Dense>
+#include "motion_models.h"
 
+// 默认模型的状态类型（即 KalmanFilter<ConstantVelocityXYAH>::Mean / Covariance）；
+// 其他模型用 KalmanFilter<Model>::Mean / Covariance
+using KalmanMean = Eigen::Matrix<float, 8, 1>;
+using KalmanCovariance = Eigen::Matrix<float, 8, 8>;
+
+// ==================== 马氏距离门控 ====================
+// 4 自由度 χ² 分布的 0.95 分位数（DeepSORT chi2inv95[4]），马氏距离平方超过此值视为不可能的配对
+constexpr float kChi2Inv95Dof4 = 9.4877f;
+
+// ==================== Kalman 滤波器 ====================
+// 运动模型在编译期选定（见 motion_models.h），状态 / 协方差 / 观测全部为定长 Eigen 类型，
+// 所有成员函数在头文件中定义，随调用方内联展开：不做运行时分派，也不做堆分配。
+template <class Model = ConstantVelocityXYAH>
 class KalmanFilter {
     public:
+        static constexpr int kStateDim = Model::kStateDim;
+        static constexpr int kMeasDim = Model::kMeasDim;
+        static_assert(kStateDim > kMeasDim, "观测必须是状态的真子集（H = [I 0]）");
+
+        using Params = typename Model::Params;
+        using Mean = Eigen::Matrix<float, kStateDim, 1>;
+        using Covariance = Eigen::Matrix<float, kStateDim, kStateDim>;
+        using Measurement = Eigen::Matrix<float, kMeasDim, 1>;
+        using MeasurementCovariance = Eigen::Matrix<float, kMeasDim, kMeasDim>;
+
         // 构造函数：可选传入超参数，使用默认值（DeepSORT 推荐值）
-        KalmanFilter(
-            float q_pos = 1.0f / 20.0f,
-            float q_vel = 1.0f / 160.0f,
-            float r = 0.05f,
-            float init_P = 1000.0f
-        );
+        explicit KalmanFilter(const Params& params = Params());
 
         ~KalmanFilter() = default;
 
-        Eigen::Vector4f predict();
-        void update(const Eigen::Vector4f& z);
+        // dt：距上次预测经过的时间，以标称帧为单位（可为小数；丢帧时一次调用外推多帧）
+        Measurement predict(float dt = 1.0f);
+        void update(const Measurement& z);
+
+        // 作用于外部状态的版本：滤波器只提供模型（F/H/Q/R），状态由调用方持有
+        void initiate(Mean& x, Covariance& P) const;
+        Measurement predict(Mean& x, Covariance& P, float dt = 1.0f) const;
+        void update(Mean& x, Covariance& P, const Measurement& z) const;
+
+        // 投影到观测空间（门控用）：mean = H x，S = H P H^T + R + Model::gatingVariance(mean)
+        void project(const Mean& x, const Covariance& P, Measurement& mean, MeasurementCovariance& S) const;
 
-        const Eigen::VectorXf& getState() const { return x_; }
-        const Eigen::MatrixXf& getCovariance() const { return P_; }
+        const Params& params() const { return params_; }
+        const Mean& getState() const { return x_; }
+        const Covariance& getCovariance() const { return P_; }
 
     private:
-        // === 超参数（全部在 private 中定义）===
-        float q_pos_;      // 位置过程噪声标准差
-        float q_vel_;      // 速度过程噪声标准差
-        float r_;          // 观测噪声标准差
-        float init_P_;     // 初始状态协方差（标量，用于对角初始化）
+        // === 超参数 ===
+        Params params_;
+
+        // === 模型结构（不显式存放 F/H/Q/R 矩阵）===
+        // F 由 Model::transition 按分块展开，H = [I 0]，Q = dt · diag(q_)，R = diag(r2_)
+        Mean q_;             // Q / dt 的对角元素
+        Measurement r2_;     // R 的对角元素
 
         // === Kalman 滤波器内部变量 ===
-        Eigen::MatrixXf F_; // 8x8   状态转移矩阵
-        Eigen::MatrixXf H_; // 4x8    观测矩阵
-        Eigen::MatrixXf Q_; // 8x8   位置过程噪声协方差
-        Eigen::MatrixXf R_; // 4x4    观测噪声协方差
-        Eigen::VectorXf x_; // 8x1   状态向量
-        Eigen::MatrixXf P_; // 8x8   状态协方差
+        Mean x_;             // 状态向量
+        Covariance P_;       // 状态协方差
 };
 
-#endif
\ No newline at end of file
+template <class Model>
+inline KalmanFilter<Model>::KalmanFilter(const Params& params)
+    : params_(params),
+      q_(Model::processNoise(params)),
+      r2_(Model::measurementNoise(params)) {
+
+    // 初始化状态向量和协方差矩阵 P
+    initiate(x_, P_);
+}
+
+template <class Model>
+inline typename KalmanFilter<Model>::Measurement KalmanFilter<Model>::predict(float dt) {
+    return predict(x_, P_, dt);
+}
+
+template <class Model>
+inline void KalmanFilter<Model>::update(const Measurement& z) {
+    update(x_, P_, z);
+}
+
+// ==================== 外部状态版本 ====================
+
+template <class Model>
+inline void KalmanFilter<Model>::initiate(Mean& x, Covariance& P) const {
+    x.setZero();
+    P = Covariance::Identity() * params_.init_P;
+}
+
+template <class Model>
+inline typename KalmanFilter<Model>::Measurement
+KalmanFilter<Model>::predict(Mean& x, Covariance& P, float dt) const {
+    // x = F x，P = F P F^T + Q
+    Model::transition(x, P, dt);
+    P.diagonal() += dt * q_;
+    return x.template head<kMeasDim>();
+}
+
+template <class Model>
+inline void KalmanFilter<Model>::update(Mean& x, Covariance& P, const Measurement& z) const {
+    constexpr int M = kMeasDim, B = kStateDim - kMeasDim;
+
+    // H = [I 0]，记 P = [A B; C D]（A 为 M x M），则 H P = [A B]，S = A + R
+    MeasurementCovariance S = P.template topLeftCorner<M, M>();
+    S.diagonal() += r2_;
+    Eigen::LLT<MeasurementCovariance> llt(S);
+
+    // K^T = S^{-1} [A B]（M x N），用 Cholesky 求解代替求逆。
+    // 逐列求解：多右端项的三角求解会申请分块工作区（堆分配），单列走向量路径则不会
+    Eigen::Matrix<float, M, kStateDim> Kt = P.template topRows<M>();
+    for (int j = 0; j < kStateDim; ++j) llt.solveInPlace(Kt.col(j));
+
+    // 更新状态：x += K (z - H x)
+    Measurement y = z - x.template head<M>();
+    x.noalias() += Kt.transpose() * y;
+
+    // 更新协方差：P' = P - K H P，按分块展开：
+    //   [A' B'] = [A B] - A S^{-1} [A B] = R S^{-1} [A B] = R K^T（避免 I - K 的大数相消）
+    //   D' = D - C S^{-1} B
+    Eigen::Matrix<float, B, B> D = P.template bottomRightCorner<B, B>();
+    D.noalias() -= P.template bottomLeftCorner<B, M>() * Kt.template rightCols<B>();
+    P.template topRows<M>() = r2_.asDiagonal() * Kt;
+    P.template bottomLeftCorner<B, M>() = P.template topRightCorner<M, B>().transpose();
+
+    // 强制对称（应对浮点误差）
+    P.template topLeftCorner<M, M>() =
+        (P.template topLeftCorner<M, M>() + P.template topLeftCorner<M, M>().transpose()) * 0.5f;
+    P.template bottomRightCorner<B, B>() = (D + D.transpose()) * 0.5f;
+}
+
+template <class Model>
+inline void KalmanFilter<Model>::project(const Mean& x, const Covariance& P,
+                                         Measurement& mean, MeasurementCovariance& S) const {
+    mean = x.template head<kMeasDim>();
+    S = P.template topLeftCorner<kMeasDim, kMeasDim>();
+    S.diagonal() += Model::gatingVariance(mean);
+    S.diagonal() += r2_;
+}
+
+#endif
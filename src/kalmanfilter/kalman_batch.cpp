@@ -0,0 +1,494 @@
+#include "kalman_batch.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// ==================== SIMD 通道抽象 ====================
+// 每种通道类型提供：宽度、load/store（非对齐）、set1、sqrt；
+// 加减乘使用 GCC/Clang 向量扩展的运算符，标量路径直接是 float。
+namespace {
+
+struct ScalarLanes {
+    using T = float;
+    static constexpr size_t width = 1;
+    static T load(const float* p) { return *p; }
+    static void store(float* p, T v) { *p = v; }
+    static T set1(float v) { return v; }
+    static T sqrt(T v) { return std::sqrt(v); }
+    using Mask = bool;
+    static Mask mask(const float* p) { return *p != 0.0f; }
+    static T select(Mask m, T a, T b) { return m ? a : b; }
+};
+
+#if defined(__AVX2__)
+struct Avx2Lanes {
+    using T = __m256;
+    static constexpr size_t width = 8;
+    static T load(const float* p) { return _mm256_loadu_ps(p); }
+    static void store(float* p, T v) { _mm256_storeu_ps(p, v); }
+    static T set1(float v) { return _mm256_set1_ps(v); }
+    static T sqrt(T v) { return _mm256_sqrt_ps(v); }
+    using Mask = __m256;
+    static Mask mask(const float* p) { return _mm256_cmp_ps(_mm256_loadu_ps(p), _mm256_setzero_ps(), _CMP_NEQ_OQ); }
+    static T select(Mask m, T a, T b) { return _mm256_blendv_ps(b, a, m); }
+};
+#endif
+
+#if defined(__AVX512F__)
+struct Avx512Lanes {
+    using T = __m512;
+    static constexpr size_t width = 16;
+    static T load(const float* p) { return _mm512_loadu_ps(p); }
+    static void store(float* p, T v) { _mm512_storeu_ps(p, v); }
+    static T set1(float v) { return _mm512_set1_ps(v); }
+    static T sqrt(T v) { return _mm512_sqrt_ps(v); }
+    using Mask = __mmask16;
+    static Mask mask(const float* p) { return _mm512_cmp_ps_mask(_mm512_loadu_ps(p), _mm512_setzero_ps(), _CMP_NEQ_OQ); }
+    static T select(Mask m, T a, T b) { return _mm512_mask_blend_ps(m, b, a); }
+};
+#endif
+
+#if defined(__AVX512F__)
+using WideLanes = Avx512Lanes;
+#elif defined(__AVX2__)
+using WideLanes = Avx2Lanes;
+#else
+using WideLanes = ScalarLanes;
+#endif
+
+// ==================== 预测核 ====================
+// 对通道 [begin, end) 执行 x = F x，P = F P F^T + Q（F = [I dt·I; 0 I]，Q = dt · diag(q_pos², q_vel²)）
+// kMean / kCov 选择只预测均值或只预测协方差（另一项可传 nullptr）
+template <typename L, bool kMean = true, bool kCov = true>
+size_t predict_lanes(float* mean, float* cov, size_t stride, size_t begin, size_t end,
+                     float q_pos2, float q_vel2, float dt) {
+    using T = typename L::T;
+    const T qp = L::set1(dt * q_pos2);
+    const T qv = L::set1(dt * q_vel2);
+    const T vdt = L::set1(dt);
+    size_t i = begin;
+    for (; i + L::width <= end; i += L::width) {
+        // 均值：位置 += dt * 速度
+        if (kMean) {
+            for (int k = 0; k < 4; ++k) {
+                float* pos = mean + k * stride + i;
+                T v = L::load(pos) + vdt * L::load(mean + (k + 4) * stride + i);
+                L::store(pos, v);
+            }
+        }
+        if (!kCov) continue;
+        // 协方差：先右乘 F^T（左 4 列 += dt * 右 4 列），再左乘 F（上 4 行 += dt * 下 4 行）
+        for (int r = 0; r < 8; ++r) {
+            for (int c = 0; c < 4; ++c) {
+                float* dst = cov + (r * 8 + c) * stride + i;
+                L::store(dst, L::load(dst) + vdt * L::load(cov + (r * 8 + c + 4) * stride + i));
+            }
+        }
+        for (int r = 0; r < 4; ++r) {
+            for (int c = 0; c < 8; ++c) {
+                float* dst = cov + (r * 8 + c) * stride + i;
+                T v = L::load(dst) + vdt * L::load(cov + ((r + 4) * 8 + c) * stride + i);
+                if (c == r) v = v + qp;
+                L::store(dst, v);
+            }
+        }
+        for (int k = 4; k < 8; ++k) {
+            float* dst = cov + (k * 8 + k) * stride + i;
+            L::store(dst, L::load(dst) + qv);
+        }
+    }
+    return i;
+}
+
+// ==================== 更新核 ====================
+// 对连续通道 [begin, end) 执行观测更新（H = [I 0]，R = r² I）：
+//   S = A + r² I，4x4 Cholesky 分解后求 K^T = S^{-1} [A B]
+//   x += K (z - H x)
+//   A' = r² S^{-1} A，B' = r² S^{-1} B，D' = D - C S^{-1} B
+// 与 KalmanFilter::update 的分块公式一致。
+// mask 非空时只写回 mask[i] != 0 的通道（原地处理稠密匹配，其余通道保持不变）
+template <typename L>
+size_t update_lanes(float* mean, float* cov, const float* z, const float* mask, size_t stride,
+                    size_t begin, size_t end, float r2) {
+    using T = typename L::T;
+    const T vr2 = L::set1(r2);
+    const T one = L::set1(1.0f);
+    const T half = L::set1(0.5f);
+    auto P = [&](int r, int c, size_t i) { return cov + (r * 8 + c) * stride + i; };
+
+    size_t i = begin;
+    for (; i + L::width <= end; i += L::width) {
+        typename L::Mask m{};
+        if (mask != nullptr) m = L::mask(mask + i);
+        auto put = [&](float* p, T v) {
+            L::store(p, mask != nullptr ? L::select(m, v, L::load(p)) : v);
+        };
+
+        // --- S = A + r² I 的 Cholesky 分解（只用下三角）---
+        T s00 = L::load(P(0, 0, i)) + vr2;
+        T s10 = L::load(P(1, 0, i)), s11 = L::load(P(1, 1, i)) + vr2;
+        T s20 = L::load(P(2, 0, i)), s21 = L::load(P(2, 1, i)), s22 = L::load(P(2, 2, i)) + vr2;
+        T s30 = L::load(P(3, 0, i)), s31 = L::load(P(3, 1, i)), s32 = L::load(P(3, 2, i));
+        T s33 = L::load(P(3, 3, i)) + vr2;
+
+        T l00 = L::sqrt(s00), i00 = one / l00;
+        T l10 = s10 * i00, l20 = s20 * i00, l30 = s30 * i00;
+        T l11 = L::sqrt(s11 - l10 * l10), i11 = one / l11;
+        T l21 = (s21 - l20 * l10) * i11, l31 = (s31 - l30 * l10) * i11;
+        T l22 = L::sqrt(s22 - l20 * l20 - l21 * l21), i22 = one / l22;
+        T l32 = (s32 - l30 * l20 - l31 * l21) * i22;
+        T l33 = L::sqrt(s33 - l30 * l30 - l31 * l31 - l32 * l32), i33 = one / l33;
+
+        // --- K^T 的每一列：解 L L^T w = P(0:4, c) ---
+        T kt[4][8];
+        for (int c = 0; c < 8; ++c) {
+            T b0 = L::load(P(0, c, i)), b1 = L::load(P(1, c, i));
+            T b2 = L::load(P(2, c, i)), b3 = L::load(P(3, c, i));
+            T u0 = b0 * i00;
+            T u1 = (b1 - l10 * u0) * i11;
+            T u2 = (b2 - l20 * u0 - l21 * u1) * i22;
+            T u3 = (b3 - l30 * u0 - l31 * u1 - l32 * u2) * i33;
+            T w3 = u3 * i33;
+            T w2 = (u2 - l32 * w3) * i22;
+            T w1 = (u1 - l21 * w2 - l31 * w3) * i11;
+            T w0 = (u0 - l10 * w1 - l20 * w2 - l30 * w3) * i00;
+            kt[0][c] = w0; kt[1][c] = w1; kt[2][c] = w2; kt[3][c] = w3;
+        }
+
+        // --- 状态：x += K y ---
+        T y[4];
+        for (int k = 0; k < 4; ++k) {
+            y[k] = L::load(z + k * stride + i) - L::load(mean + k * stride + i);
+        }
+        for (int c = 0; c < 8; ++c) {
+            float* xc = mean + c * stride + i;
+            put(xc, L::load(xc) + kt[0][c] * y[0] + kt[1][c] * y[1]
+                                + kt[2][c] * y[2] + kt[3][c] * y[3]);
+        }
+
+        // --- D' = D - C S^{-1} B（先算完再写，C 还要用旧值）---
+        T d[4][4];
+        for (int r = 0; r < 4; ++r) {
+            T c0 = L::load(P(4 + r, 0, i)), c1 = L::load(P(4 + r, 1, i));
+            T c2 = L::load(P(4 + r, 2, i)), c3 = L::load(P(4 + r, 3, i));
+            for (int c = 0; c < 4; ++c) {
+                d[r][c] = L::load(P(4 + r, 4 + c, i))
+                        - (c0 * kt[0][4 + c] + c1 * kt[1][4 + c] + c2 * kt[2][4 + c] + c3 * kt[3][4 + c]);
+            }
+        }
+
+        // --- 写回协方差（A'、D' 强制对称，C' = B'^T）---
+        for (int r = 0; r < 4; ++r) {
+            for (int c = 0; c < 4; ++c) {
+                put(P(r, c, i), (kt[r][c] + kt[c][r]) * half * vr2);
+                put(P(4 + r, 4 + c, i), (d[r][c] + d[c][r]) * half);
+            }
+            for (int c = 0; c < 4; ++c) {
+                T b = kt[r][4 + c] * vr2;
+                put(P(r, 4 + c, i), b);
+                put(P(4 + c, r, i), b);
+            }
+        }
+    }
+    return i;
+}
+
+// ==================== 定增益均值更新核 ====================
+// 所有通道共用同一个增益 K（8x4，行优先，gain[c * 4 + k] = K(c, k)）：x += K (z - H x)，协方差不参与计算。
+// mask 含义同 update_lanes
+template <typename L>
+size_t update_mean_lanes(float* mean, const float* z, const float* mask, const float* gain, size_t stride,
+                         size_t begin, size_t end) {
+    using T = typename L::T;
+    size_t i = begin;
+    for (; i + L::width <= end; i += L::width) {
+        T y[4];
+        for (int k = 0; k < 4; ++k) {
+            y[k] = L::load(z + k * stride + i) - L::load(mean + k * stride + i);
+        }
+        for (int c = 0; c < 8; ++c) {
+            float* xc = mean + c * stride + i;
+            const float* g = gain + c * 4;
+            T x = L::load(xc);
+            T v = x + L::set1(g[0]) * y[0] + L::set1(g[1]) * y[1] + L::set1(g[2]) * y[2] + L::set1(g[3]) * y[3];
+            L::store(xc, mask != nullptr ? L::select(L::mask(mask + i), v, x) : v);
+        }
+    }
+    return i;
+}
+
+} // namespace
+
+// ==================== KalmanBatch ====================
+
+template <class Model>
+KalmanBatch<Model>::KalmanBatch(const Params& params) : kf_(params) {
+    if constexpr (kSimd) {
+        q_pos2_ = params.q_pos * params.q_pos;
+        q_vel2_ = params.q_vel * params.q_vel;
+        r2_ = params.r * params.r;
+    }
+}
+
+template <class Model>
+const char* KalmanBatch<Model>::isaName() {
+    if (!kSimd) return "per-lane";
+#if defined(__AVX512F__)
+    return "AVX-512";
+#elif defined(__AVX2__)
+    return "AVX2";
+#else
+    return "scalar";
+#endif
+}
+
+template <class Model>
+void KalmanBatch<Model>::_load(const float* mean, const float* cov, size_t stride, size_t i,
+                               Mean* x, Covariance* P) {
+    constexpr int N = kStateDim;
+    if (x) {
+        for (int k = 0; k < N; ++k) (*x)[k] = mean[k * stride + i];
+    }
+    if (P) {
+        // 协方差对称，行优先 / 列优先相同
+        float* p = P->data();
+        for (int e = 0; e < N * N; ++e) p[e] = cov[e * stride + i];
+    }
+}
+
+template <class Model>
+void KalmanBatch<Model>::_store(float* mean, float* cov, size_t stride, size_t i,
+                                const Mean* x, const Covariance* P) {
+    constexpr int N = kStateDim;
+    if (x) {
+        for (int k = 0; k < N; ++k) mean[k * stride + i] = (*x)[k];
+    }
+    if (P) {
+        const float* p = P->data();
+        for (int e = 0; e < N * N; ++e) cov[e * stride + i] = p[e];
+    }
+}
+
+template <class Model>
+void KalmanBatch<Model>::initiate(float* mean, float* cov, size_t stride, size_t i) const {
+    Mean x;
+    Covariance P;
+    kf_.initiate(x, P);
+    _store(mean, cov, stride, i, &x, &P);
+}
+
+template <class Model>
+void KalmanBatch<Model>::project(const float* mean, const float* cov, size_t stride, size_t i, size_t lane,
+                                 float* z_mean, float* S) const {
+    constexpr int N = kStateDim, M = kMeasDim;
+    Mean x;
+    for (int k = 0; k < N; ++k) x[k] = mean[k * stride + i];
+    // 只需左上 M x M 块
+    Covariance P = Covariance::Zero();
+    for (int r = 0; r < M; ++r) {
+        for (int c = 0; c < M; ++c) P(r, c) = cov[(r * N + c) * stride + lane];
+    }
+    Measurement zm;
+    typename KalmanFilter<Model>::MeasurementCovariance s;
+    kf_.project(x, P, zm, s);
+    for (int r = 0; r < M; ++r) {
+        z_mean[r] = zm[r];
+        for (int c = 0; c < M; ++c) S[r * M + c] = s(r, c);
+    }
+}
+
+template <class Model>
+void KalmanBatch<Model>::predict(float* mean, float* cov, size_t stride, size_t n, float dt) const {
+    if constexpr (kSimd) {
+        size_t done = predict_lanes<WideLanes>(mean, cov, stride, 0, n, q_pos2_, q_vel2_, dt);
+        predict_lanes<ScalarLanes>(mean, cov, stride, done, n, q_pos2_, q_vel2_, dt);
+    } else {
+        for (size_t i = 0; i < n; ++i) {
+            Mean x;
+            Covariance P;
+            _load(mean, cov, stride, i, &x, &P);
+            kf_.predict(x, P, dt);
+            _store(mean, cov, stride, i, &x, &P);
+        }
+    }
+}
+
+template <class Model>
+void KalmanBatch<Model>::predictMean(float* mean, size_t stride, size_t n, float dt) const {
+    if constexpr (kSimd) {
+        size_t done = predict_lanes<WideLanes, true, false>(mean, nullptr, stride, 0, n, q_pos2_, q_vel2_, dt);
+        predict_lanes<ScalarLanes, true, false>(mean, nullptr, stride, done, n, q_pos2_, q_vel2_, dt);
+    } else {
+        for (size_t i = 0; i < n; ++i) {
+            Mean x;
+            _load(mean, nullptr, stride, i, &x, nullptr);
+            Model::transition(x, dt);
+            _store(mean, nullptr, stride, i, &x, nullptr);
+        }
+    }
+}
+
+template <class Model>
+void KalmanBatch<Model>::predictCovariance(float* cov, size_t stride, size_t n, float dt) const {
+    if constexpr (kSimd) {
+        size_t done = predict_lanes<WideLanes, false, true>(nullptr, cov, stride, 0, n, q_pos2_, q_vel2_, dt);
+        predict_lanes<ScalarLanes, false, true>(nullptr, cov, stride, done, n, q_pos2_, q_vel2_, dt);
+    } else {
+        for (size_t i = 0; i < n; ++i) {
+            Mean x = Mean::Zero();   // 均值不参与协方差的传播
+            Covariance P;
+            _load(nullptr, cov, stride, i, nullptr, &P);
+            kf_.predict(x, P, dt);
+            _store(nullptr, cov, stride, i, nullptr, &P);
+        }
+    }
+}
+
+template <class Model>
+size_t KalmanBatch<Model>::_mark_blocks(const uint32_t* indices, size_t m, size_t n) {
+    const size_t W = WideLanes::width;
+    size_t blocks = (n + W - 1) / W;
+    if (scratch_block_.size() < blocks) scratch_block_.resize(blocks);
+    std::fill(scratch_block_.begin(), scratch_block_.begin() + blocks, 0);
+    size_t touched = 0;
+    for (size_t j = 0; j < m; ++j) {
+        uint8_t& flag = scratch_block_[indices[j] / W];
+        touched += !flag;
+        flag = 1;
+    }
+    return touched;
+}
+
+template <class Model>
+void KalmanBatch<Model>::_scatter_masked(const uint32_t* indices, const float* z, size_t m, size_t stride,
+                                         size_t n) {
+    const size_t W = WideLanes::width;
+    if (scratch_z_.size() < 4 * stride) scratch_z_.resize(4 * stride);
+    if (scratch_mask_.size() < stride) scratch_mask_.resize(stride);
+    for (size_t b = 0; b * W < n; ++b) {
+        if (scratch_block_[b]) {
+            std::fill(scratch_mask_.begin() + b * W, scratch_mask_.begin() + std::min(b * W + W, n), 0.0f);
+        }
+    }
+    for (size_t j = 0; j < m; ++j) {
+        size_t t = indices[j];
+        for (int k = 0; k < 4; ++k) scratch_z_[k * stride + t] = z[4 * j + k];
+        scratch_mask_[t] = 1.0f;
+    }
+}
+
+template <class Model>
+void KalmanBatch<Model>::updateMean(float* mean, size_t stride, const uint32_t* indices, const float* z, size_t m,
+                                    const float* gain) {
+    if (m == 0) return;
+    constexpr int N = kStateDim, M = kMeasDim;
+
+    if constexpr (kSimd) {
+        size_t n = *std::max_element(indices, indices + m) + 1;
+        const size_t W = WideLanes::width;
+        if (_mark_blocks(indices, m, n) * W <= 4 * m) {
+            // 块内稠密：与 update 相同，按掩码原地处理含匹配的块
+            _scatter_masked(indices, z, m, stride, n);
+            for (size_t b = 0; b * W < n; ++b) {
+                if (!scratch_block_[b]) continue;
+                size_t end = std::min(b * W + W, n);
+                size_t done = update_mean_lanes<WideLanes>(mean, scratch_z_.data(), scratch_mask_.data(), gain,
+                                                           stride, b * W, end);
+                update_mean_lanes<ScalarLanes>(mean, scratch_z_.data(), scratch_mask_.data(), gain, stride, done,
+                                               end);
+            }
+            return;
+        }
+    }
+
+    // 稀疏（或无 SIMD 核的模型）：每条只有 N x M 次乘加，直接逐条计算
+    for (size_t j = 0; j < m; ++j) {
+        size_t t = indices[j];
+        float y[M];
+        for (int k = 0; k < M; ++k) y[k] = z[M * j + k] - mean[k * stride + t];
+        for (int c = 0; c < N; ++c) {
+            const float* g = gain + c * M;
+            float dx = 0.0f;
+            for (int k = 0; k < M; ++k) dx += g[k] * y[k];
+            mean[c * stride + t] += dx;
+        }
+    }
+}
+
+template <class Model>
+void KalmanBatch<Model>::update(float* mean, float* cov, size_t stride,
+                                const uint32_t* indices, const float* z, size_t m) {
+    if (m == 0) return;
+
+    if constexpr (!kSimd) {
+        // 逐通道取出定长状态，用 KalmanFilter 的分块公式更新
+        for (size_t j = 0; j < m; ++j) {
+            const size_t t = indices[j];
+            Mean x;
+            Covariance P;
+            _load(mean, cov, stride, t, &x, &P);
+            kf_.update(x, P, Eigen::Map<const Measurement>(z + kMeasDim * j));
+            _store(mean, cov, stride, t, &x, &P);
+        }
+    } else {
+        _update_simd(mean, cov, stride, indices, z, m);
+    }
+}
+
+template <class Model>
+void KalmanBatch<Model>::_update_simd(float* mean, float* cov, size_t stride,
+                                      const uint32_t* indices, const float* z, size_t m) {
+    size_t n = *std::max_element(indices, indices + m) + 1;
+    const size_t W = WideLanes::width;
+    if (_mark_blocks(indices, m, n) * W <= 4 * m) {
+        // 匹配在块内足够稠密（常见情况：大部分轨迹每帧都命中）：按掩码原地处理含匹配的 SIMD 块，
+        // 顺序读写每一行。按下标跨 stride 收集/写回 72 个分量时每个分量都是一次缓存行访问，
+        // 块内匹配不到四分之一时收集的代价才低于整块计算
+        _scatter_masked(indices, z, m, stride, n);
+        for (size_t b = 0; b * W < n; ++b) {
+            if (!scratch_block_[b]) continue;
+            size_t end = std::min(b * W + W, n);
+            size_t done = update_lanes<WideLanes>(mean, cov, scratch_z_.data(), scratch_mask_.data(),
+                                                  stride, b * W, end, r2_);
+            update_lanes<ScalarLanes>(mean, cov, scratch_z_.data(), scratch_mask_.data(),
+                                      stride, done, end, r2_);
+        }
+        return;
+    }
+
+    // 稀疏匹配：把匹配轨迹收集到连续的临时通道，批量计算后写回
+    size_t s = (m + kLaneAlign - 1) / kLaneAlign * kLaneAlign;
+    if (s > scratch_stride_) {
+        scratch_stride_ = s;
+        scratch_mean_.resize(8 * s);
+        scratch_cov_.resize(64 * s);
+    }
+    s = scratch_stride_;
+    if (scratch_z_.size() < 4 * s) scratch_z_.resize(4 * s);
+
+    for (size_t j = 0; j < m; ++j) {
+        size_t src = indices[j];
+        for (int k = 0; k < 8; ++k) scratch_mean_[k * s + j] = mean[k * stride + src];
+        for (int e = 0; e < 64; ++e) scratch_cov_[e * s + j] = cov[e * stride + src];
+        for (int k = 0; k < 4; ++k) scratch_z_[k * s + j] = z[4 * j + k];
+    }
+
+    size_t done = update_lanes<WideLanes>(scratch_mean_.data(), scratch_cov_.data(), scratch_z_.data(),
+                                          nullptr, s, 0, m, r2_);
+    update_lanes<ScalarLanes>(scratch_mean_.data(), scratch_cov_.data(), scratch_z_.data(),
+                              nullptr, s, done, m, r2_);
+
+    for (size_t j = 0; j < m; ++j) {
+        size_t dst = indices[j];
+        for (int k = 0; k < 8; ++k) mean[k * stride + dst] = scratch_mean_[k * s + j];
+        for (int e = 0; e < 64; ++e) cov[e * stride + dst] = scratch_cov_[e * s + j];
+    }
+}
+
+// 随库发布的运动模型
+template class KalmanBatch<ConstantVelocityXYAH>;
+template class KalmanBatch<ConstantVelocityXYWH>;
+template class KalmanBatch<ConstantAccelerationXYAH>;
@@ -0,0 +1,108 @@
+#ifndef KALMAN_BATCH_H
+#define KALMAN_BATCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+#include "kalman.h"
+
+// ==================== 批量 Kalman 滤波器 ====================
+// 所有轨迹共享同一组 F/H/Q/R（与 KalmanFilter<Model> 相同的运动模型），
+// 因此可以把 N 条轨迹放进 SIMD 的不同通道，一次调用完成全部预测或一批更新。
+//
+// 数据布局（lane-major，SoA），记 N = kStateDim：
+//   mean: N 行 × stride，第 k 个状态分量的第 i 条轨迹位于 mean[k * stride + i]
+//   cov : N² 行 × stride，协方差元素 (r, c) 的第 i 条轨迹位于 cov[(r * N + c) * stride + i]
+// 同一分量在不同轨迹之间连续存放，每个 SIMD 寄存器一次处理 8（AVX2）或 16（AVX-512）条轨迹。
+//
+// 匀速 xyah 模型（DeepSORT 默认）有手工展开的 SIMD 核：指令集在编译期选择，定义了 __AVX512F__ 时用 AVX-512，
+// 定义了 __AVX2__ 时用 AVX2，否则使用标量实现，各路径的计算公式完全一致。
+// 其余模型逐通道取出定长状态，调用 KalmanFilter<Model> 的分块实现（同样不做堆分配）。
+template <class Model = ConstantVelocityXYAH>
+class KalmanBatch {
+    public:
+        static constexpr int kStateDim = Model::kStateDim;
+        static constexpr int kMeasDim = Model::kMeasDim;
+        using Params = typename KalmanFilter<Model>::Params;
+
+        // 超参数与 KalmanFilter 相同（默认为 DeepSORT 推荐值）
+        explicit KalmanBatch(const Params& params = Params());
+
+        // 把第 i 条轨迹初始化为零状态 + init_P * I 协方差
+        void initiate(float* mean, float* cov, size_t stride, size_t i) const;
+
+        // 预测前 n 条轨迹：x = F x，P = F P F^T + Q
+        // - dt: 经过的时间（标称帧数），同一路视频的轨迹共享，F/Q 的构造同 KalmanFilter::predict
+        void predict(float* mean, float* cov, size_t stride, size_t n, float dt = 1.0f) const;
+
+        // 只预测前 n 条轨迹的均值（协方差由 KalmanGainCache 表示的轨迹）
+        void predictMean(float* mean, size_t stride, size_t n, float dt = 1.0f) const;
+        // 只预测前 n 个通道的协方差（TrackStore 协方差池中未进入缓存的轨迹）
+        void predictCovariance(float* cov, size_t stride, size_t n, float dt = 1.0f) const;
+
+        // 更新匹配到的子集：indices[j] 为轨迹下标（互不重复），z[M * j .. M * j + M - 1] 为其观测
+        // SIMD 核：含匹配的块中至少四分之一通道匹配时按掩码原地处理这些块；更稀疏时先收集到连续的临时通道，
+        // 批量计算后再写回
+        void update(float* mean, float* cov, size_t stride,
+                    const uint32_t* indices, const float* z, size_t m);
+
+        // 以同一个已知增益更新匹配子集的均值：x += K (z - H x)，协方差不变（KalmanGainCache 的稳态轨迹）
+        // - gain: K（N x M）行优先，K(c, k) 位于 gain[c * M + k]；indices / z 同 update
+        void updateMean(float* mean, size_t stride, const uint32_t* indices, const float* z, size_t m,
+                        const float* gain);
+
+        // 投影第 i 条轨迹到观测空间（门控用，与 KalmanFilter::project 相同）：
+        // z_mean[M] = H x，S[M * M]（行优先）= H P H^T + R + Model::gatingVariance(H x)
+        // - lane: 协方差所在通道（TrackStore 的协方差池中与均值的下标 i 不同）
+        void project(const float* mean, const float* cov, size_t stride, size_t i, size_t lane,
+                     float* z_mean, float* S) const;
+
+        const Params& params() const { return kf_.params(); }
+
+        // update 临时缓冲占用的字节数
+        size_t memoryBytes() const {
+            return (scratch_mean_.capacity() + scratch_cov_.capacity() +
+                    scratch_z_.capacity() + scratch_mask_.capacity()) * sizeof(float) + scratch_block_.capacity();
+        }
+
+        // 当前编译使用的指令集（"AVX-512" / "AVX2" / "scalar"；非 SIMD 模型为 "per-lane"）
+        static const char* isaName();
+
+        // SIMD 宽度（每次处理的轨迹数），存储 stride 取其整数倍即可整除
+        static constexpr size_t kLaneAlign = 16;
+
+    private:
+        using Mean = typename KalmanFilter<Model>::Mean;
+        using Covariance = typename KalmanFilter<Model>::Covariance;
+        using Measurement = typename KalmanFilter<Model>::Measurement;
+
+        // 是否走手工展开的 SIMD 核（只有匀速 xyah）
+        static constexpr bool kSimd = std::is_same<Model, ConstantVelocityXYAH>::value;
+
+        KalmanFilter<Model> kf_;   // 逐通道路径的模型（F/H/Q/R）
+        float q_pos2_ = 0.0f;      // SIMD 核：Q 位置块对角元素
+        float q_vel2_ = 0.0f;      // SIMD 核：Q 速度块对角元素
+        float r2_ = 0.0f;          // SIMD 核：R 对角元素
+
+        // 逐通道路径：lane-major 布局与定长状态互转
+        static void _load(const float* mean, const float* cov, size_t stride, size_t i, Mean* x, Covariance* P);
+        static void _store(float* mean, float* cov, size_t stride, size_t i, const Mean* x, const Covariance* P);
+
+        // update 的 SIMD 核路径（只有匀速 xyah 调用）
+        void _update_simd(float* mean, float* cov, size_t stride, const uint32_t* indices, const float* z, size_t m);
+        // 标记前 n 个通道中 indices 所在的 SIMD 块（scratch_block_），返回块数
+        size_t _mark_blocks(const uint32_t* indices, size_t m, size_t n);
+        // 在已标记的块内写掩码与观测（scratch_mask_ / scratch_z_，按 stride 布局）
+        void _scatter_masked(const uint32_t* indices, const float* z, size_t m, size_t stride, size_t n);
+
+        // update 的临时缓冲（按需增长，复用不释放）
+        std::vector<float> scratch_mean_;  // 稀疏路径：N × scratch_stride_
+        std::vector<float> scratch_cov_;   // 稀疏路径：N² × scratch_stride_
+        std::vector<float> scratch_z_;     // 观测：M × max(stride, scratch_stride_)
+        std::vector<float> scratch_mask_;  // 稠密路径：每个通道是否匹配
+        std::vector<uint8_t> scratch_block_; // 每个 SIMD 块是否含所选轨迹
+        size_t scratch_stride_ = 0;
+};
+
+#endif // KALMAN_BATCH_H
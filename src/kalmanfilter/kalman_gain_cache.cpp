@@ -0,0 +1,145 @@
+#include "kalman_gain_cache.h"
+#include <algorithm>
+#include <cmath>
+
+template <class Model>
+KalmanGainCache<Model>::KalmanGainCache(const GainCacheConfig& config, const Params& params)
+    : config_(config),
+      kf_(params),
+      r2_(Model::measurementNoise(params)) {
+    config_.max_misses = std::max(config_.max_misses, 0);
+    config_.max_transient_misses = std::max(config_.max_transient_misses, 0);
+    config_.max_nodes = std::max(config_.max_nodes, 1);
+
+    // 稳态：从出生开始连续命中，直到相邻两步的协方差不再变化
+    Mean x;
+    Covariance P;
+    const Measurement z = Measurement::Zero();   // 协方差与观测值无关
+    kf_.initiate(x, P);
+    kf_.update(x, P, z);
+    const Covariance birth = P;
+    for (int k = 0; k < 1000; ++k) {
+        const Covariance prev = P;
+        kf_.predict(x, P);
+        kf_.update(x, P, z);
+        if ((P - prev).cwiseAbs().maxCoeff() <= 1e-3f * config_.tolerance * P.cwiseAbs().maxCoeff()) break;
+    }
+    steady_scale_ = P.cwiseAbs().maxCoeff();
+
+    // 连续 m 次 dt = 1 的预测累积的过程噪声：noise_[m + 1] = F noise_[m] F^T + Q
+    const int max_m = std::max(config_.max_misses, config_.max_transient_misses) + 1;
+    noise_.resize(max_m + 1);
+    noise_[0].setZero();
+    for (int m = 1; m <= max_m; ++m) {
+        noise_[m] = noise_[m - 1];
+        kf_.predict(x, noise_[m]);
+    }
+
+    Node steady;
+    steady.P = P;
+    steady.dist = 0.0f;
+    nodes_.push_back(steady);
+    birth_ = _find_or_add(birth);
+
+    // 广度优先：nodes_ 在循环中增长，新节点排在队尾，依次补全它们的转移
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+        const int count = (i == 0) ? config_.max_misses + 1 : config_.max_transient_misses + 1;
+        nodes_[i].first = static_cast<int32_t>(transitions_.size());
+        nodes_[i].count = count;
+        Covariance prior = nodes_[i].P;
+        for (int m = 1; m <= count; ++m) {
+            kf_.predict(x, prior);
+            Transition t = _transition(prior);
+            Covariance post = prior;
+            kf_.update(x, post, z);
+            t.next = _find_or_add(post);   // 可能扩容 nodes_，之后只按下标访问
+            transitions_.push_back(t);
+        }
+    }
+}
+
+template <class Model>
+int32_t KalmanGainCache<Model>::_find_or_add(const Covariance& post) {
+    // 只并入离稳态不比 post 更远的节点：连续命中时离稳态的距离单调减小，不会在收敛前的节点间打转
+    // （收敛末段每步的变化可能小于容差，若允许并回更远的节点，轨迹会停在该节点上永远到不了稳态）。
+    // 逐元素比较、遇到超差立即跳过：多数节点在前一两个元素就能排除
+    constexpr int kElems = kStateDim * kStateDim;
+    const float limit = config_.tolerance * steady_scale_;
+    const float dist = (post - nodes_[0].P).cwiseAbs().maxCoeff();
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+        if (nodes_[i].dist > dist) continue;
+        const float* a = nodes_[i].P.data();
+        const float* b = post.data();
+        int e = 0;
+        while (e < kElems && std::abs(a[e] - b[e]) <= limit) ++e;
+        if (e == kElems) return static_cast<int32_t>(i);
+    }
+    if (static_cast<int>(nodes_.size()) >= config_.max_nodes) return kUncached;
+    Node node;
+    node.P = post;
+    node.dist = dist;
+    node.first = 0;
+    node.count = 0;
+    nodes_.push_back(node);
+    return static_cast<int32_t>(nodes_.size() - 1);
+}
+
+template <class Model>
+typename KalmanGainCache<Model>::Transition KalmanGainCache<Model>::_transition(const Covariance& prior) const {
+    // 与 KalmanFilter::update 相同：S = A + R，K^T = S^{-1} [A B]
+    MeasurementCovariance S = prior.template topLeftCorner<kMeasDim, kMeasDim>();
+    S.diagonal() += r2_;
+    Eigen::LLT<MeasurementCovariance> llt(S);
+    Transition t;
+    t.Kt = prior.template topRows<kMeasDim>();
+    for (int j = 0; j < kStateDim; ++j) llt.solveInPlace(t.Kt.col(j));
+    t.next = kUncached;
+    return t;
+}
+
+template <class Model>
+typename KalmanGainCache<Model>::Covariance KalmanGainCache<Model>::covariance(int32_t node, int m) const {
+    Covariance P = nodes_[node].P;
+    if (m == 0) return P;
+
+    // 连续 m 次 dt = 1 的预测：P_m = F^m P F^mT + Σ_{k<m} F^k Q F^kT，其中 F^m = F(m)（一次外推 m 帧），
+    // 噪声项按 m 预先累积；超出表的部分（只在退回完整传播时出现）逐步补齐
+    const int max_m = static_cast<int>(noise_.size()) - 1;
+    const int k = std::min(m, max_m);
+    Mean x = Mean::Zero();
+    Model::transition(x, P, static_cast<float>(k));
+    P += noise_[k];
+    for (int s = k; s < m; ++s) kf_.predict(x, P);
+    return P;
+}
+
+template <class Model>
+void KalmanGainCache<Model>::project(const Mean& x, int32_t node, int m,
+                                     Measurement& mean, MeasurementCovariance& S) const {
+    kf_.project(x, covariance(node, m), mean, S);
+}
+
+template <class Model>
+bool KalmanGainCache<Model>::isSteady(const Covariance& P) const {
+    return (P - nodes_[0].P).cwiseAbs().maxCoeff() <= config_.tolerance * steady_scale_;
+}
+
+template <class Model>
+bool KalmanGainCache<Model>::isSteady(const float* cov, size_t stride, size_t i) const {
+    const float limit = config_.tolerance * steady_scale_;
+    const float* ss = nodes_[0].P.data();   // 对称矩阵，行优先 / 列优先相同
+    for (int e = 0; e < kStateDim * kStateDim; ++e) {
+        if (std::abs(cov[e * stride + i] - ss[e]) > limit) return false;
+    }
+    return true;
+}
+
+template <class Model>
+size_t KalmanGainCache<Model>::memoryBytes() const {
+    return nodes_.capacity() * sizeof(Node) + transitions_.capacity() * sizeof(Transition) +
+           noise_.capacity() * sizeof(Covariance);
+}
+
+template class KalmanGainCache<ConstantVelocityXYAH>;
+template class KalmanGainCache<ConstantVelocityXYWH>;
+template class KalmanGainCache<ConstantAccelerationXYAH>;
@@ -0,0 +1,116 @@
+#ifndef KALMAN_GAIN_CACHE_H
+#define KALMAN_GAIN_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "kalman.h"
+
+// ==================== 稳态增益缓存配置 ====================
+struct GainCacheConfig {
+    bool enabled = false;          // 关闭时每条轨迹都完整传播协方差
+    int max_misses = 30;           // 稳态轨迹连续丢检不超过此数时，重新命中仍走缓存
+    int max_transient_misses = 1;  // 尚未收敛（出生 / 丢检后恢复中）的轨迹连续丢检不超过此数时仍走缓存
+    int max_nodes = 4096;          // 表的节点数上限，超出后新出现的协方差不再入表
+    float tolerance = 1e-3f;       // 两个协方差之差（最大元素 / 稳态最大元素）小于此值视为同一节点
+
+    bool operator==(const GainCacheConfig& o) const {
+        return enabled == o.enabled && max_misses == o.max_misses &&
+               max_transient_misses == o.max_transient_misses && max_nodes == o.max_nodes &&
+               tolerance == o.tolerance;
+    }
+    bool operator!=(const GainCacheConfig& o) const { return !(*this == o); }
+};
+
+// ==================== 稳态 Kalman 增益缓存 ====================
+// F/H/Q/R 对所有轨迹相同（同一运动模型，dt = 1），协方差 P 只取决于轨迹创建以来的预测 / 更新事件序列，
+// 且连续命中若干次后收敛到稳态 P_ss。因此可以按事件序列预先算好协方差和增益，所有轨迹共享：
+//
+//   节点：某次更新之后的协方差。从出生节点（initiate + 首次更新）出发，每个节点预测 m 次后命中
+//         （即 m - 1 次丢检）得到下一个协方差：与某个不比它离稳态更远的已有节点之差在 tolerance 内时
+//         并入该节点，否则新建，如此广度优先建成一张有限的图。
+//         稳态节点允许 max_misses 次丢检，其余节点允许 max_transient_misses 次。
+//   轨迹的协方差用 (节点, 距该次更新的预测次数 m) 表示：
+//     - 预测：m 加一，不做任何矩阵运算（任意 m 的协方差可一步算出，见 covariance()）
+//     - 命中：表内有转移时，x += K (z - H x) 用预先算好的增益，转到下一个节点
+//
+// 表外的事件（丢检超过上述次数、dt ≠ 1）由调用方退回完整传播，
+// 完整传播的轨迹收敛到稳态（isSteady()）后重新进入缓存。
+// 缓存构建完成后只读，可在多个 TrackStore 之间共享。
+template <class Model = ConstantVelocityXYAH>
+class KalmanGainCache {
+    public:
+        static constexpr int kStateDim = Model::kStateDim;
+        static constexpr int kMeasDim = Model::kMeasDim;
+        using Params = typename KalmanFilter<Model>::Params;
+        using Mean = typename KalmanFilter<Model>::Mean;
+        using Covariance = typename KalmanFilter<Model>::Covariance;
+        using Measurement = typename KalmanFilter<Model>::Measurement;
+        using MeasurementCovariance = typename KalmanFilter<Model>::MeasurementCovariance;
+
+        static constexpr int32_t kUncached = -1;
+
+        // 命中转移：K^T（M x N）与命中后的节点
+        struct Transition {
+            Eigen::Matrix<float, kMeasDim, kStateDim> Kt;
+            int32_t next;
+        };
+
+        // 超参数须与 TrackStore 的 KalmanBatch 相同（默认均为 DeepSORT 推荐值）
+        explicit KalmanGainCache(const GainCacheConfig& config = GainCacheConfig(),
+                                 const Params& params = Params());
+
+        const GainCacheConfig& config() const { return config_; }
+
+        // 新轨迹（initiate + 首次更新）所在的节点；稳态节点
+        int32_t birthNode() const { return birth_; }
+        int32_t steadyNode() const { return 0; }
+        size_t nodeCount() const { return nodes_.size(); }
+        size_t transitionCount() const { return transitions_.size(); }
+
+        // 节点 node 更新后又预测 m 次（dt = 1）的协方差：F(m) P F(m)^T 加预先累积的过程噪声，不逐步迭代
+        Covariance covariance(int32_t node, int m) const;
+        // 门控投影（与 KalmanFilter::project 相同）
+        void project(const Mean& x, int32_t node, int m, Measurement& mean, MeasurementCovariance& S) const;
+
+        // 在 (node, m) 处命中的转移；不在表内时返回 nullptr
+        const Transition* hit(int32_t node, int m) const {
+            const Node& n = nodes_[node];
+            if (m < 1 || m > n.count) return nullptr;
+            const Transition& t = transitions_[n.first + m - 1];
+            return t.next >= 0 ? &t : nullptr;
+        }
+
+        // 完整传播的协方差是否已收敛到稳态（可重新进入缓存）
+        bool isSteady(const Covariance& P) const;
+        // 从 lane-major 协方差中读第 i 条轨迹判断（stride 同 KalmanBatch）
+        bool isSteady(const float* cov, size_t stride, size_t i) const;
+
+        // 表占用的堆内存字节数
+        size_t memoryBytes() const;
+
+    private:
+        struct Node {
+            Covariance P;            // 更新后的协方差
+            float dist;              // 与稳态之差（最大元素）
+            int32_t first;           // 转移在 transitions_ 中的起点，m = 1..count 依次存放
+            int32_t count;
+        };
+
+        // 与 post 相差在容差内的已有节点；没有时新建（已达 max_nodes 时返回 kUncached）
+        int32_t _find_or_add(const Covariance& post);
+        // prior（预测后的协方差）处命中的增益；next 由调用方填写
+        Transition _transition(const Covariance& prior) const;
+
+        GainCacheConfig config_;
+        KalmanFilter<Model> kf_;
+        Measurement r2_;             // R 的对角元素（增益用）
+        float steady_scale_;         // 稳态协方差最大元素（容差的分母）
+        int32_t birth_ = 0;
+
+        std::vector<Node> nodes_;                 // nodes_[0] 为稳态节点
+        std::vector<Transition> transitions_;
+        std::vector<Covariance> noise_;           // noise_[m] = Σ_{k<m} F^k Q F^kT（表内最多预测次数为止）
+};
+
+#endif // KALMAN_GAIN_CACHE_H
@@ -0,0 +1,148 @@
+#ifndef MOTION_MODELS_H
+#define MOTION_MODELS_H
+
+#include <Eigen/Dense>
+
+// ==================== 运动模型（KalmanFilter<Model> 的模板参数）====================
+// 每个模型是一组编译期常量 + 静态函数，滤波器不做任何运行时分派：
+//   kStateDim / kMeasDim   状态维数 N、观测维数 M；观测为状态的前 M 个分量（H = [I 0]）
+//   Params                 超参数（默认值为 DeepSORT 推荐值）
+//   kName                  模型名（快照中记录，恢复时校验）
+//   transition(x, P, dt)   原地执行 x = F x，P = F P F^T（按 4x4 分块展开，不构造 F）
+//   transition(x, dt)      只推进均值（协方差由 KalmanGainCache 表示的轨迹）
+//   processNoise(p)        Q / dt 的对角元素（N 维）：过程噪声按经过的时间线性累积
+//   measurementNoise(p)    R 的对角元素（M 维）
+//   gatingVariance(z)      门控投影额外叠加的观测方差（M 维）
+//   fromTlwh / toTlwh      框 (x, y, w, h) 与观测向量互转
+// F(dt) 须满足 F(a) F(b) = F(a + b)（运动学模型均满足）：KalmanGainCache 用 F(m) 一步算出连续 m 次预测。
+
+// 门控投影额外叠加的观测噪声方差：与 DeepSORT 的 project() 一致，
+// 位置和高度的标准差按框高缩放（h / 20），宽高比取 0.1。
+// 滤波器自身的 R = r² I 是绝对量（r = 0.05 像素），单独用于门控会把几乎所有真实检测挡在门外。
+inline Eigen::Vector4f gating_measurement_variance(float h) {
+    float std_pos = h / 20.0f;
+    return Eigen::Vector4f(std_pos * std_pos, std_pos * std_pos, 0.01f, std_pos * std_pos);
+}
+
+// ---------- 匀速模型公共部分：状态 [观测 4 维, 各自的速度 4 维] ----------
+struct ConstantVelocityModel {
+    static constexpr int kStateDim = 8;
+    static constexpr int kMeasDim = 4;
+
+    struct Params {
+        float q_pos = 1.0f / 20.0f;     // 位置过程噪声标准差
+        float q_vel = 1.0f / 160.0f;    // 速度过程噪声标准差
+        float r = 0.05f;                // 观测噪声标准差
+        float init_P = 1000.0f;         // 初始状态协方差（对角）
+    };
+
+    // F = [I dt·I; 0 I]，记 P = [A B; C D]（各 4x4）：
+    //   A' = A + dt (B + C) + dt² D,  B' = B + dt D,  C' = C + dt D,  D' = D
+    // 先做列变换（右乘 F^T），再做行变换（左乘 F），与稠密乘法等价
+    static void transition(Eigen::Matrix<float, 8, 1>& x, Eigen::Matrix<float, 8, 8>& P, float dt) {
+        x.head<4>() += dt * x.tail<4>();
+        P.leftCols<4>() += dt * P.rightCols<4>();
+        P.topRows<4>() += dt * P.bottomRows<4>();
+    }
+
+    static void transition(Eigen::Matrix<float, 8, 1>& x, float dt) {
+        x.head<4>() += dt * x.tail<4>();
+    }
+
+    static Eigen::Matrix<float, 8, 1> processNoise(const Params& p) {
+        Eigen::Matrix<float, 8, 1> q;
+        q << Eigen::Vector4f::Constant(p.q_pos * p.q_pos), Eigen::Vector4f::Constant(p.q_vel * p.q_vel);
+        return q;
+    }
+
+    static Eigen::Vector4f measurementNoise(const Params& p) {
+        return Eigen::Vector4f::Constant(p.r * p.r);
+    }
+};
+
+// ---------- 匀速 xyah：观测 (cx, cy, w/h, h)，DeepSORT 原始模型 ----------
+struct ConstantVelocityXYAH : ConstantVelocityModel {
+    static constexpr const char* kName = "cv-xyah";
+
+    static Eigen::Vector4f gatingVariance(const Eigen::Vector4f& z) {
+        return gating_measurement_variance(z[3]);
+    }
+
+    static Eigen::Vector4f fromTlwh(float x, float y, float w, float h) {
+        return Eigen::Vector4f(x + 0.5f * w, y + 0.5f * h, w / h, h);
+    }
+
+    static Eigen::Vector4f toTlwh(const Eigen::Vector4f& z) {
+        const float w = z[2] * z[3];
+        return Eigen::Vector4f(z[0] - 0.5f * w, z[1] - 0.5f * z[3], w, z[3]);
+    }
+};
+
+// ---------- 匀速 xywh：观测 (cx, cy, w, h)，宽和高各自带速度 ----------
+// 宽高比随姿态变化明显的目标（行人摆臂、车辆转向）上框宽更贴合；门控方差的 x / w 分量按框宽缩放
+struct ConstantVelocityXYWH : ConstantVelocityModel {
+    static constexpr const char* kName = "cv-xywh";
+
+    static Eigen::Vector4f gatingVariance(const Eigen::Vector4f& z) {
+        const float std_w = z[2] / 20.0f, std_h = z[3] / 20.0f;
+        return Eigen::Vector4f(std_w * std_w, std_h * std_h, std_w * std_w, std_h * std_h);
+    }
+
+    static Eigen::Vector4f fromTlwh(float x, float y, float w, float h) {
+        return Eigen::Vector4f(x + 0.5f * w, y + 0.5f * h, w, h);
+    }
+
+    static Eigen::Vector4f toTlwh(const Eigen::Vector4f& z) {
+        return Eigen::Vector4f(z[0] - 0.5f * z[2], z[1] - 0.5f * z[3], z[2], z[3]);
+    }
+};
+
+// ---------- 匀加速 xyah：状态 [观测 4 维, 速度 4 维, 加速度 4 维] ----------
+// 起步、刹车、抛物运动等速度持续变化的目标上，丢检期间的外推误差比匀速模型小
+struct ConstantAccelerationXYAH {
+    static constexpr const char* kName = "ca-xyah";
+    static constexpr int kStateDim = 12;
+    static constexpr int kMeasDim = 4;
+
+    struct Params {
+        float q_pos = 1.0f / 20.0f;     // 位置过程噪声标准差
+        float q_vel = 1.0f / 160.0f;    // 速度过程噪声标准差
+        float q_acc = 1.0f / 320.0f;    // 加速度过程噪声标准差
+        float r = 0.05f;                // 观测噪声标准差
+        float init_P = 1000.0f;         // 初始状态协方差（对角）
+    };
+
+    // F = [I dt·I dt²/2·I; 0 I dt·I; 0 0 I]，列变换与行变换各两步（先改第 0 块，再改第 1 块，
+    // 保证第 0 块用到的是未修改的第 1 块）
+    static void transition(Eigen::Matrix<float, 12, 1>& x, Eigen::Matrix<float, 12, 12>& P, float dt) {
+        const float h = 0.5f * dt * dt;
+        x.head<4>() += dt * x.segment<4>(4) + h * x.tail<4>();
+        x.segment<4>(4) += dt * x.tail<4>();
+        P.leftCols<4>() += dt * P.middleCols<4>(4) + h * P.rightCols<4>();
+        P.middleCols<4>(4) += dt * P.rightCols<4>();
+        P.topRows<4>() += dt * P.middleRows<4>(4) + h * P.bottomRows<4>();
+        P.middleRows<4>(4) += dt * P.bottomRows<4>();
+    }
+
+    static void transition(Eigen::Matrix<float, 12, 1>& x, float dt) {
+        x.head<4>() += dt * x.segment<4>(4) + 0.5f * dt * dt * x.tail<4>();
+        x.segment<4>(4) += dt * x.tail<4>();
+    }
+
+    static Eigen::Matrix<float, 12, 1> processNoise(const Params& p) {
+        Eigen::Matrix<float, 12, 1> q;
+        q << Eigen::Vector4f::Constant(p.q_pos * p.q_pos), Eigen::Vector4f::Constant(p.q_vel * p.q_vel),
+             Eigen::Vector4f::Constant(p.q_acc * p.q_acc);
+        return q;
+    }
+
+    static Eigen::Vector4f measurementNoise(const Params& p) {
+        return Eigen::Vector4f::Constant(p.r * p.r);
+    }
+
+    static Eigen::Vector4f gatingVariance(const Eigen::Vector4f& z) { return ConstantVelocityXYAH::gatingVariance(z); }
+    static Eigen::Vector4f fromTlwh(float x, float y, float w, float h) { return ConstantVelocityXYAH::fromTlwh(x, y, w, h); }
+    static Eigen::Vector4f toTlwh(const Eigen::Vector4f& z) { return ConstantVelocityXYAH::toTlwh(z); }
+};
+
+#endif // MOTION_MODELS_H
@@ -1,35 +1,25 @@
 #include "DeepSortTracker.h"
 #include <algorithm>
+#include <chrono>
 #include <numeric>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 // ==================== Track ====================
 
-Track::Track(int id, const cv::Rect_<float>& box, const std::vector<float>& feature, int n_init)
-    : id(id), box(box), feature(feature), n_init_(n_init),
-      time_since_update(0), hits(1), age(1), state(TrackState::Tentative) {
-    std::vector<float> xyah = tlwh_to_xyah({box.x, box.y, box.width, box.height});
-    Eigen::Vector4f z(xyah[0], xyah[1], xyah[2], xyah[3]);
-    kalman.update(z);
-}
-
-void Track::predict() {
-    Eigen::Vector4f pred = kalman.predict();
-    std::vector<float> tlwh = xyah_to_tlwh({pred[0], pred[1], pred[2], pred[3]});
-    box = cv::Rect_<float>(tlwh[0], tlwh[1], tlwh[2], tlwh[3]);
-    age++;
-    time_since_update++;
-}
-
-void Track::update(const cv::Rect_<float>& box, const std::vector<float>& feature) {
-    this->box = box;
-    this->feature = feature;
-    std::vector<float> xyah = tlwh_to_xyah({box.x, box.y, box.width, box.height});
-    Eigen::Vector4f z(xyah[0], xyah[1], xyah[2], xyah[3]);
-    kalman.update(z);
-    hits++;
-    time_since_update = 0;
-    if (state == TrackState::Tentative && hits >= n_init_) {
-        state = TrackState::Confirmed;
+template <class Model>
+Track::Track(const TrackStore<Model>& store, size_t index)
+    : id(store.id(index)), box(store.box(index)),
+      time_since_update(store.timeSinceUpdate(index)), hits(store.hits(index)),
+      age(store.age(index)), state(store.state(index)) {
+    const float* f = store.feature(index);
+    if (f != nullptr) {
+        feature.assign(f, f + store.featureDim());
     }
 }
 
@@ -39,135 +29,795 @@ cv::Rect_<float> Track::to_tlwh() const {
 
 // ==================== DeepSortTracker ====================
 
-DeepSortTracker::DeepSortTracker(
+template <class Model>
+DeepSortTracker<Model>::DeepSortTracker(
     const std::string& reid_model_path,
     float max_iou_distance,
     int max_age,
     int n_init,
-    float max_cosine_distance
+    float max_cosine_distance,
+    AssignmentMode assignment_mode,
+    const GalleryConfig& gallery,
+    bool lazy_reid,
+    float high_score_threshold
+)
+    : DeepSortTracker<Model>(loadReidModel(reid_model_path), max_iou_distance, max_age, n_init,
+                      max_cosine_distance, assignment_mode, gallery, lazy_reid, high_score_threshold) {}
+
+template <class Model>
+DeepSortTracker<Model>::DeepSortTracker(
+    std::shared_ptr<MNNInfer> reid_model,
+    float max_iou_distance,
+    int max_age,
+    int n_init,
+    float max_cosine_distance,
+    AssignmentMode assignment_mode,
+    const GalleryConfig& gallery,
+    bool lazy_reid,
+    float high_score_threshold
 )
-    : next_id_(1),
+    : tracks_(n_init, gallery),
+      next_id_(1),
       max_iou_distance_(max_iou_distance),
       max_age_(max_age),
       n_init_(n_init),
-      max_cosine_distance_(max_cosine_distance) {
-    
+      max_cosine_distance_(max_cosine_distance),
+      assignment_mode_(assignment_mode),
+      lazy_reid_(lazy_reid),
+      high_score_threshold_(high_score_threshold),
+      reid_model_(std::move(reid_model)) {}
+
+template <class Model>
+size_t DeepSortTracker<Model>::memoryBytes() const {
+    auto bytes = [](const auto& v) { return v.capacity() * sizeof(v[0]); };
+    size_t total = sizeof(*this) + tracks_.memoryBytes() + grid_.memoryBytes() + det_grid_.memoryBytes();
+    total += bytes(high_dets_) + bytes(low_dets_) + bytes(proj_mean_) + bytes(proj_chol_) + bytes(det_z_);
+    total += bytes(search_regions_) + bytes(cand_ptr_) + bytes(cand_det_) + bytes(det_col_) + bytes(query_buf_);
+    total += bytes(sparse_cost_.row_ptr) + bytes(sparse_cost_.col_idx) + bytes(sparse_cost_.values);
+    total += bytes(det_features_) + appearance_.size() * sizeof(float) + bytes(publish_buf_) + bytes(snapshot_buf_);
+    total += flow_.memoryBytes() + bytes(flow_from_) + bytes(flow_to_) + bytes(refine_idx_) + bytes(refine_boxes_);
+    total += flow_ok_.capacity() / 8;
+    total += (track_used_.capacity() + det_used_.capacity() + keep_.capacity()) / 8;
+    const AssignmentWorkspace& ws = assignment_ws_;
+    total += bytes(ws.u) + bytes(ws.v) + bytes(ws.minv) + bytes(ws.p) + bytes(ws.way) + bytes(ws.used);
+    total += bytes(ws.dist) + bytes(ws.price) + bytes(ws.pred) + bytes(ws.col_row) + bytes(ws.row_col);
+    total += bytes(ws.touched) + bytes(ws.scanned) + bytes(ws.heap) + bytes(ws.candidates) + bytes(ws.cost);
+    return total;
+}
+
+template <class Model>
+void DeepSortTracker<Model>::setReidGallery(std::shared_ptr<ReidGallery> gallery, int camera_id) {
+    reid_gallery_ = std::move(gallery);
+    camera_id_ = camera_id;
+}
+
+template <class Model>
+void DeepSortTracker<Model>::snapshot(std::vector<char>& out, bool full_gallery) {
+    saved_state_.next_id = next_id_;
+    saved_state_.max_age = max_age_;
+    saved_state_.n_init = n_init_;
+    saved_state_.assignment_mode = static_cast<int32_t>(assignment_mode_);
+    saved_state_.max_iou_distance = max_iou_distance_;
+    saved_state_.max_cosine_distance = max_cosine_distance_;
+    saved_state_.high_score_threshold = high_score_threshold_;
+    saved_state_.lazy_reid = lazy_reid_ ? 1 : 0;
+    saved_state_.frame_index = frame_index_;
+    saved_state_.frame_interval = frame_interval_;
+    saved_state_.last_timestamp = last_timestamp_;
+
+    snapshot_writer_.clear();
+    snapshot_writer_.addValue(SnapshotTag("DSST"), saved_state_);
+    snapshot_writer_.addValue(SnapshotTag("DSRS"), reid_stats_);
+    tracks_.saveState(snapshot_writer_, full_gallery);
+    snapshot_writer_.finish(out);
+}
+
+template <class Model>
+void DeepSortTracker<Model>::restore(const void* data, size_t size) {
+    SnapshotReader reader(data, size);
+    const SavedState st = reader.readValue<SavedState>(SnapshotTag("DSST"));
+    const ReidStats stats = reader.readValue<ReidStats>(SnapshotTag("DSRS"));
+    if (st.assignment_mode != static_cast<int32_t>(AssignmentMode::Greedy) &&
+        st.assignment_mode != static_cast<int32_t>(AssignmentMode::LAPJV)) {
+        throw std::runtime_error("snapshot: invalid tracker state");
+    }
+    // 先恢复到临时存储：格式错误时抛异常，跟踪器保持原状。
+    // 带上当前的增益缓存表：与快照配置相同时沿用（多路共享的表不会被各自的副本替换）
+    TrackStore<Model> tracks;
+    tracks.setGainCache(tracks_.gainCache());
+    tracks.loadState(reader);
+    tracks_ = std::move(tracks);
+
+    next_id_ = st.next_id;
+    max_age_ = st.max_age;
+    n_init_ = st.n_init;
+    assignment_mode_ = static_cast<AssignmentMode>(st.assignment_mode);
+    max_iou_distance_ = st.max_iou_distance;
+    max_cosine_distance_ = st.max_cosine_distance;
+    high_score_threshold_ = st.high_score_threshold;
+    lazy_reid_ = st.lazy_reid != 0;
+    frame_index_ = st.frame_index;
+    frame_interval_ = st.frame_interval;
+    last_timestamp_ = st.last_timestamp;
+    reid_stats_ = stats;
+    // 光流参考帧不在快照中：恢复后的第一帧需要检测
+    flow_.reset();
+    frames_since_keyframe_ = 0;
+    force_detect_ = false;
+}
+
+template <class Model>
+void DeepSortTracker<Model>::saveSnapshot(const std::string& path, bool full_gallery) {
+    snapshot(snapshot_buf_, full_gallery);
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+        f.write(snapshot_buf_.data(), static_cast<std::streamsize>(snapshot_buf_.size()));
+        if (!f) throw std::runtime_error("Failed to write snapshot: " + tmp);
+    }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        throw std::runtime_error("Failed to rename snapshot to " + path);
+    }
+}
+
+template <class Model>
+void DeepSortTracker<Model>::loadSnapshot(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("Failed to open snapshot: " + path);
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size == 0) {
+        ::close(fd);
+        throw std::runtime_error("Failed to read snapshot: " + path);
+    }
+    const size_t size = static_cast<size_t>(st.st_size);
+    void* data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) throw std::runtime_error("Failed to map snapshot: " + path);
+    try {
+        restore(data, size);
+    } catch (...) {
+        ::munmap(data, size);
+        throw;
+    }
+    ::munmap(data, size);
+}
+
+template <class Model>
+void DeepSortTracker<Model>::_publish(size_t i) {
+    const size_t dim = tracks_.featureDim();
+    if (dim == 0 || dim != reid_gallery_->dim()) return;
+    publish_buf_.resize(dim);
+    if (!tracks_.representativeFeature(i, publish_buf_.data())) return;
+
+    GalleryRecord record;
+    record.camera_id = camera_id_;
+    record.track_id = tracks_.id(i);
+    record.frame = frame_index_;
+    reid_gallery_->add(publish_buf_.data(), record);
+}
+
+template <class Model>
+std::shared_ptr<MNNInfer> DeepSortTracker<Model>::loadReidModel(const std::string& reid_model_path, int num_sessions) {
+    // SORT 模式：不加载 ReID 模型，只做运动 + IoU 跟踪
+    if (reid_model_path.empty()) {
+        return nullptr;
+    }
+
     // 初始化 ReID 模型（使用你的 MNNInfer）
     float mean[3] = {0.485f, 0.456f, 0.406f}; // ImageNet mean
     float std[3]  = {0.229f, 0.224f, 0.225f}; // ImageNet std
-    reid_model_ = std::make_unique<MNNInfer>(reid_model_path, mean, std);
-    
-    if (reid_model_->loadModel() != 0) {
+    auto model = std::make_shared<MNNInfer>(reid_model_path, mean, std, num_sessions);
+
+    if (model->loadModel() != 0) {
         throw std::runtime_error("Failed to load ReID model!");
     }
+    return model;
 }
 
-std::vector<Track> DeepSortTracker::update(
+template <class Model>
+std::vector<Track> DeepSortTracker<Model>::update(
     const cv::Mat& frame,
-    const std::vector<cv::Rect_<float>>& detections) {
+    const std::vector<cv::Rect_<float>>& detections,
+    double timestamp) {
 
-    // Step 1: 提取 ReID 特征
-    std::vector<cv::Mat> crops;
+    _step(frame, detections, std::vector<cv::Rect_<float>>(), _elapsed_frames(timestamp));
+    std::vector<Track> results;
+    _collect(results);
+    return results;
+}
+
+template <class Model>
+void DeepSortTracker<Model>::update(
+    const cv::Mat& frame,
+    const std::vector<cv::Rect_<float>>& detections,
+    std::vector<TrackOutput>& outputs,
+    double timestamp) {
+
+    _step(frame, detections, std::vector<cv::Rect_<float>>(), _elapsed_frames(timestamp));
+    _collect(outputs);
+}
+
+template <class Model>
+std::vector<Track> DeepSortTracker<Model>::update(
+    const cv::Mat& frame,
+    const std::vector<detect_result>& detections,
+    double timestamp) {
+
+    _split_by_score(detections);
+    _step(frame, high_dets_, low_dets_, _elapsed_frames(timestamp));
+    std::vector<Track> results;
+    _collect(results);
+    return results;
+}
+
+template <class Model>
+void DeepSortTracker<Model>::update(
+    const cv::Mat& frame,
+    const std::vector<detect_result>& detections,
+    std::vector<TrackOutput>& outputs,
+    double timestamp) {
+
+    _split_by_score(detections);
+    _step(frame, high_dets_, low_dets_, _elapsed_frames(timestamp));
+    _collect(outputs);
+}
+
+template <class Model>
+float DeepSortTracker<Model>::_elapsed_frames(double timestamp) {
+    if (timestamp < 0.0) {
+        last_timestamp_ = kNoTimestamp;
+        return 1.0f;
+    }
+    float dt = 1.0f;
+    if (last_timestamp_ >= 0.0) {
+        dt = static_cast<float>((timestamp - last_timestamp_) / frame_interval_);
+        dt = std::clamp(dt, 0.0f, static_cast<float>(std::max(max_age_, 1)));
+    }
+    last_timestamp_ = timestamp;
+    return dt;
+}
+
+template <class Model>
+void DeepSortTracker<Model>::_split_by_score(const std::vector<detect_result>& detections) {
+    high_dets_.clear();
+    low_dets_.clear();
     for (const auto& det : detections) {
-        cv::Rect_<int> roi(
-            static_cast<int>(det.x),
-            static_cast<int>(det.y),
-            static_cast<int>(det.width),
-            static_cast<int>(det.height)
+        cv::Rect_<float> box(
+            static_cast<float>(det.box.x),
+            static_cast<float>(det.box.y),
+            static_cast<float>(det.box.width),
+            static_cast<float>(det.box.height)
         );
-        // 边界检查
-        roi &= cv::Rect(0, 0, frame.cols, frame.rows);
-        if (roi.area() <= 0) {
-            crops.push_back(cv::Mat()); // 空图
-        } else {
-            crops.push_back(frame(roi).clone());
-        }
+        if (det.confidence >= high_score_threshold_) high_dets_.push_back(box);
+        else low_dets_.push_back(box);
     }
+}
 
-    std::vector<std::vector<float>> features;
-    std::vector<std::vector<float>> outputs;
-
-    if (reid_model_->runInference(crops, outputs) != 0 || outputs.empty()) {
-        // 推理失败，用零向量填充
-        features.resize(detections.size(), std::vector<float>(512, 0.0f)); // 注意：维度应匹配模型
-    } else {
-        // ✅ 直接赋值！outputs[i] 就是第 i 个检测的特征
-        if (outputs.size() != detections.size()) {
-            std::cerr << "⚠️ Output count mismatch! Expected " 
-                    << detections.size() << ", got " << outputs.size() << std::endl;
-            features.resize(detections.size(), std::vector<float>(512, 0.0f));
-        } else {
-            features = std::move(outputs); // ✅ 直接移动，无需拆分
+template <class Model>
+void DeepSortTracker<Model>::_collect(std::vector<Track>& results) const {
+    // 返回 confirmed 轨迹
+    results.clear();
+    for (size_t i = 0; i < tracks_.size(); ++i) {
+        if (tracks_.state(i) == TrackState::Confirmed) {
+            results.emplace_back(tracks_, i);
         }
     }
+}
+
+template <class Model>
+void DeepSortTracker<Model>::_collect(std::vector<TrackOutput>& outputs) const {
+    outputs.clear();
+    for (size_t i = 0; i < tracks_.size(); ++i) {
+        if (tracks_.state(i) != TrackState::Confirmed) continue;
+        TrackOutput out;
+        out.id = tracks_.id(i);
+        out.handle = tracks_.handle(i);
+        out.box = tracks_.box(i);
+        out.state = tracks_.state(i);
+        out.age = tracks_.age(i);
+        out.velocity = tracks_.velocity(i);
+        outputs.push_back(out);
+    }
+}
+
+template <class Model>
+void DeepSortTracker<Model>::_step(
+    const cv::Mat& frame,
+    const std::vector<cv::Rect_<float>>& detections,
+    const std::vector<cv::Rect_<float>>& low_detections,
+    float dt) {
 
-    // Step 2: 预测所有轨迹
-    for (auto& track : tracks_) {
-        track.predict();
+    // 分阶段计时（每个阶段一次 steady_clock 读数）
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point t_begin = Clock::now();
+    Clock::time_point t_stage = t_begin;
+    auto lap = [&](TrackerStage stage) {
+        const Clock::time_point now = Clock::now();
+        last_timings_[stage] = std::chrono::duration<float, std::milli>(now - t_stage).count();
+        t_stage = now;
+    };
+    last_timings_ = StageTimings();
+
+    // 飞行记录：在状态改变之前取槽位（必要时保存回放起点的快照），耗时计入本帧
+    FlightFrame* rec = recorder_ ? &recorder_->beginFrame(*this, frame_index_ + 1, _has_reid()) : nullptr;
+    if (rec) {
+        rec->detections.assign(detections.begin(), detections.end());
+        rec->low_detections.assign(low_detections.begin(), low_detections.end());
+        rec->dt = dt;
     }
+    lap(TrackerStage::Record);
+
+    frame_index_++;
+    last_dt_ = dt;
+
+    // Step 1: 预测所有轨迹（按距上一帧经过的标称帧数外推）
+    tracks_.predictAll(dt);
+    lap(TrackerStage::Predict);
+
+    // Step 2: 门控准备与候选配对（只依赖框，不需要外观特征）
+    _prepare_candidates(detections);
+    lap(TrackerStage::Gating);
 
-    // Step 3: 匹配
+    // Step 3: 运动上无歧义的配对直接匹配，其余检测才提取 ReID 特征
     std::vector<std::pair<size_t, size_t>> matches;
+    std::vector<bool> need_reid;
+    _match_unambiguous(detections, matches, need_reid);
+    lap(TrackerStage::Unambiguous);
+
+    std::vector<std::vector<float>> features;
+    _extract_features(frame, detections, need_reid, features);
+    if (rec) {
+        for (size_t j = 0; j < features.size(); ++j) {
+            if (features[j].empty()) continue;
+            if (rec->feature_dim == 0) rec->feature_dim = features[j].size();
+            if (features[j].size() != rec->feature_dim) continue;
+            rec->feature_dets.push_back(static_cast<int32_t>(j));
+            rec->features.insert(rec->features.end(), features[j].begin(), features[j].end());
+        }
+    }
+    lap(TrackerStage::Reid);
+
+    // Step 3.5: 匹配级联 + IoU 匹配（跳过已匹配的轨迹和检测）
     std::vector<size_t> unmatched_tracks, unmatched_dets;
     _match(detections, features, matches, unmatched_tracks, unmatched_dets);
+    lap(TrackerStage::Match);
 
     // Step 4: 更新匹配的轨迹
-    std::vector<bool> track_used(tracks_.size(), false);
-    std::vector<bool> det_used(detections.size(), false);
+    std::vector<bool>& track_used = track_used_;
+    std::vector<bool>& det_used = det_used_;
+    track_used.assign(tracks_.size(), false);
+    det_used.assign(detections.size(), false);
 
+    tracks_.update(matches, detections, features);  // 所有匹配轨迹一次批量 Kalman 更新
     for (const auto& [t_idx, d_idx] : matches) {
-        tracks_[t_idx].update(detections[d_idx], features[d_idx]);
         track_used[t_idx] = true;
         det_used[d_idx] = true;
+        if (rec) rec->matches.push_back({tracks_.id(t_idx), static_cast<int32_t>(d_idx)});
     }
 
-    // Step 5: 处理未匹配轨迹
-    std::vector<Track> new_tracks;
-    for (size_t i = 0; i < tracks_.size(); ++i) {
-        if (!track_used[i]) {
-            tracks_[i].time_since_update++;
-            if (tracks_[i].time_since_update <= max_age_) {
-                if (tracks_[i].state == TrackState::Confirmed || tracks_[i].hits >= n_init_) {
-                    new_tracks.push_back(std::move(tracks_[i]));
-                }
-                // Tentative 未命中直接丢弃
+    // Step 4.5: 低分检测只用 IoU 关联剩余的轨迹（ByteTrack 第二阶段），不提取 ReID、不更新特征库
+    if (!low_detections.empty() && !unmatched_tracks.empty()) {
+        std::vector<std::pair<size_t, size_t>> low_matches;
+        _match_low_score(low_detections, unmatched_tracks, low_matches);
+        std::vector<std::vector<float>> no_features(low_detections.size());
+        tracks_.update(low_matches, low_detections, no_features);
+        for (const auto& m : low_matches) {
+            track_used[m.first] = true;
+            if (rec) rec->low_matches.push_back({tracks_.id(m.first), static_cast<int32_t>(m.second)});
+        }
+    }
+
+    // 本帧刚确认的轨迹入跨摄像头特征库
+    if (reid_gallery_) {
+        for (size_t i = 0; i < tracks_.size(); ++i) {
+            if (track_used[i] && tracks_.state(i) == TrackState::Confirmed && tracks_.hits(i) == n_init_) {
+                _publish(i);
             }
-        } else {
-            new_tracks.push_back(std::move(tracks_[i]));
         }
     }
 
-    // Step 6: 创建新轨迹
+    // Step 5: 处理未匹配轨迹（原地压缩，删除轨迹的 slot 回收复用）
+    _remove_stale(track_used);
+
+    // Step 6: 创建新轨迹（只用高分检测；未匹配的低分检测直接丢弃）
     for (size_t j = 0; j < detections.size(); ++j) {
         if (!det_used[j]) {
-            Track new_track(next_id_++, detections[j], features[j], n_init_);
+            size_t idx = tracks_.add(next_id_++, detections[j], features[j].data(), features[j].size());
             if (n_init_ == 1) {
-                new_track.state = TrackState::Confirmed;
+                tracks_.setState(idx, TrackState::Confirmed);
+                if (reid_gallery_) _publish(idx);
             }
-            new_tracks.push_back(std::move(new_track));
         }
     }
 
-    tracks_ = std::move(new_tracks);
+    // 关键帧：本帧成为插帧光流的参考帧
+    if (force_detect_ && frames_since_keyframe_ + 1 < keyframe_config_.detect_interval) {
+        keyframe_stats_.forced_keyframes++;
+    }
+    keyframe_stats_.keyframes++;
+    frames_since_keyframe_ = 0;
+    force_detect_ = false;
+    if (keyframe_config_.detect_interval > 1) flow_.setReference(frame);
+    lap(TrackerStage::Update);
+    last_timings_.total_ms = std::chrono::duration<float, std::milli>(t_stage - t_begin).count();
 
-    // 返回 confirmed 轨迹
-    std::vector<Track> results;
-    for (const auto& track : tracks_) {
-        if (track.state == TrackState::Confirmed) {
-            results.push_back(track);
+    if (rec) {
+        rec->timings = last_timings_;
+        recorder_->endFrame();
+    }
+}
+
+template <class Model>
+void DeepSortTracker<Model>::_remove_stale(const std::vector<bool>& track_used) {
+    std::vector<bool>& keep = keep_;
+    keep.assign(tracks_.size(), true);
+    for (size_t i = 0; i < tracks_.size(); ++i) {
+        if (!track_used[i]) {
+            tracks_.markMissed(i);
+            // Tentative 未命中直接丢弃
+            keep[i] = tracks_.timeSinceUpdate(i) <= max_age_ &&
+                      (tracks_.state(i) == TrackState::Confirmed || tracks_.hits(i) >= n_init_);
+            // 已确认轨迹删除前把最终的代表特征入库
+            if (!keep[i] && reid_gallery_ && tracks_.state(i) == TrackState::Confirmed) {
+                _publish(i);
+            }
         }
     }
-    return results;
+    tracks_.compact(keep);
+}
+
+template <class Model>
+void DeepSortTracker<Model>::setKeyframeConfig(const KeyframeConfig& config) {
+    keyframe_config_ = config;
+    flow_.setConfig(config);
+    if (config.detect_interval <= 1) flow_.reset();
+    force_detect_ = false;
+}
+
+template <class Model>
+bool DeepSortTracker<Model>::needsDetection() const {
+    return keyframe_config_.detect_interval <= 1 || force_detect_ || !flow_.hasReference() ||
+           frames_since_keyframe_ + 1 >= keyframe_config_.detect_interval;
+}
+
+template <class Model>
+void DeepSortTracker<Model>::propagate(const cv::Mat& frame, std::vector<TrackOutput>& outputs, double timestamp) {
+    _interframe(frame, _elapsed_frames(timestamp));
+    _collect(outputs);
+}
+
+template <class Model>
+void DeepSortTracker<Model>::_interframe(const cv::Mat& frame, float dt) {
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point t_begin = Clock::now();
+    Clock::time_point t_stage = t_begin;
+    auto lap = [&](TrackerStage stage) {
+        const Clock::time_point now = Clock::now();
+        last_timings_[stage] = std::chrono::duration<float, std::milli>(now - t_stage).count();
+        t_stage = now;
+    };
+    last_timings_ = StageTimings();
+
+    FlightFrame* rec = recorder_ ? &recorder_->beginFrame(*this, frame_index_ + 1, _has_reid()) : nullptr;
+    if (rec) {
+        rec->dt = dt;
+        rec->interframe = true;
+    }
+    lap(TrackerStage::Record);
+
+    frame_index_++;
+    last_dt_ = dt;
+
+    // Step 1: 预测；上一帧结束时的框即参考帧上的位置，是光流的起点
+    flow_from_.assign(tracks_.boxes().begin(), tracks_.boxes().end());
+    tracks_.predictAll(dt);
+    lap(TrackerStage::Predict);
+
+    // Step 2: 光流观测（回放时直接取记录的观测框）
+    const size_t n = tracks_.size();
+    if (replay_frame_ != nullptr) {
+        flow_to_ = flow_from_;
+        flow_ok_.assign(n, false);
+        for (const FlightFlow& f : replay_frame_->flows) {
+            for (size_t i = 0; i < n; ++i) {
+                if (tracks_.id(i) != f.track_id) continue;
+                flow_to_[i] = f.box;
+                flow_ok_[i] = true;
+                break;
+            }
+        }
+    } else {
+        flow_.track(frame, flow_from_, flow_to_, flow_ok_);
+    }
+
+    // Step 3: 漂移判定：光流框中心偏离 Kalman 预测过远时不采用，只保留预测
+    refine_idx_.clear();
+    refine_boxes_.clear();
+    size_t confirmed = 0, bad = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const bool is_confirmed = tracks_.state(i) == TrackState::Confirmed;
+        confirmed += is_confirmed;
+        if (!flow_ok_[i]) {
+            keyframe_stats_.flow_failed++;
+            bad += is_confirmed;
+            continue;
+        }
+        const cv::Rect_<float>& pred = tracks_.box(i);
+        const cv::Rect_<float>& obs = flow_to_[i];
+        const float dx = (obs.x + 0.5f * obs.width) - (pred.x + 0.5f * pred.width);
+        const float dy = (obs.y + 0.5f * obs.height) - (pred.y + 0.5f * pred.height);
+        if (std::sqrt(dx * dx + dy * dy) > keyframe_config_.drift_threshold * std::max(pred.height, 1.0f)) {
+            keyframe_stats_.flow_drifted++;
+            bad += is_confirmed;
+            continue;
+        }
+        keyframe_stats_.flow_tracked++;
+        refine_idx_.push_back(static_cast<uint32_t>(i));
+        refine_boxes_.push_back(obs);
+        if (rec) rec->flows.push_back({tracks_.id(i), obs});
+    }
+    lap(TrackerStage::Flow);
+
+    // Step 4: 观测更新；光流失败或漂移的轨迹计一次未匹配（不新建轨迹）
+    tracks_.refine(refine_idx_, refine_boxes_);
+    track_used_.assign(n, false);
+    for (uint32_t i : refine_idx_) track_used_[i] = true;
+    _remove_stale(track_used_);
+
+    frames_since_keyframe_++;
+    keyframe_stats_.interframes++;
+    if (confirmed > 0 && static_cast<float>(bad) > keyframe_config_.max_drift_ratio * confirmed) {
+        force_detect_ = true;
+    }
+    lap(TrackerStage::Update);
+    last_timings_.total_ms = std::chrono::duration<float, std::milli>(t_stage - t_begin).count();
+
+    if (rec) {
+        rec->timings = last_timings_;
+        recorder_->endFrame();
+    }
 }
 
-void DeepSortTracker::_match(
+template <class Model>
+void DeepSortTracker<Model>::replay(const FlightFrame& frame, bool with_reid, std::vector<TrackOutput>& outputs) {
+    replay_frame_ = &frame;
+    replay_reid_ = with_reid;
+    try {
+        if (frame.interframe) _interframe(cv::Mat(), frame.dt);
+        else _step(cv::Mat(), frame.detections, frame.low_detections, frame.dt);
+    } catch (...) {
+        replay_frame_ = nullptr;
+        throw;
+    }
+    replay_frame_ = nullptr;
+    _collect(outputs);
+}
+
+template <class Model>
+void DeepSortTracker<Model>::_match_low_score(
+    const std::vector<cv::Rect_<float>>& low_detections,
+    const std::vector<size_t>& unmatched_tracks,
+    std::vector<std::pair<size_t, size_t>>& low_matches) {
+
+    // 只考虑上一帧仍在跟踪中的 Confirmed 轨迹（与 ByteTrack 一致，丢失的轨迹等高分检测找回）
+    std::vector<size_t> track_ids;
+    for (size_t i : unmatched_tracks) {
+        if (tracks_.state(i) == TrackState::Confirmed && tracks_.timeSinceUpdate(i) == 1) {
+            track_ids.push_back(i);
+        }
+    }
+    if (track_ids.empty()) return;
+
+    det_grid_.build(low_detections);
+    sparse_cost_.reset(static_cast<int>(low_detections.size()));
+    for (size_t i : track_ids) {
+        query_buf_.clear();
+        det_grid_.query(tracks_.box(i), query_buf_);
+        for (int j : query_buf_) {
+            float cost = 1.0f - CalculateIoU(tracks_.box(i), low_detections[j]);
+            if (cost <= kLowScoreIoUDistance) sparse_cost_.push(j, cost);
+        }
+        sparse_cost_.endRow();
+    }
+
+    std::vector<std::pair<size_t, size_t>> local_matches;
+    std::vector<size_t> local_unmatched_tracks, local_unmatched_dets;
+    LinearAssignment(
+        sparse_cost_,
+        kLowScoreIoUDistance,
+        assignment_mode_,
+        assignment_ws_,
+        local_matches,
+        local_unmatched_tracks,
+        local_unmatched_dets
+    );
+    for (const auto& [r, c] : local_matches) {
+        low_matches.emplace_back(track_ids[r], c);
+    }
+}
+
+template <class Model>
+void DeepSortTracker<Model>::_extract_features(
+    const cv::Mat& frame,
+    const std::vector<cv::Rect_<float>>& detections,
+    const std::vector<bool>& need_reid,
+    std::vector<std::vector<float>>& features) {
+
+    features.assign(detections.size(), std::vector<float>());
+
+    const size_t num_extract = static_cast<size_t>(std::count(need_reid.begin(), need_reid.end(), true));
+    reid_stats_.crops_total += detections.size();
+    reid_stats_.crops_extracted += num_extract;
+    reid_stats_.crops_skipped += detections.size() - num_extract;
+    reid_stats_.last_frame_extracted = num_extract;
+    reid_stats_.last_frame_skipped = detections.size() - num_extract;
+
+    // 回放：特征取自记录（feature_dets 升序），不裁剪、不推理
+    if (replay_frame_ != nullptr) {
+        const FlightFrame& rf = *replay_frame_;
+        size_t k = 0;
+        for (size_t j = 0; j < detections.size(); ++j) {
+            if (!need_reid[j]) continue;
+            while (k < rf.feature_dets.size() && static_cast<size_t>(rf.feature_dets[k]) < j) ++k;
+            if (k == rf.feature_dets.size() || static_cast<size_t>(rf.feature_dets[k]) != j) continue;
+            const float* f = rf.features.data() + k * rf.feature_dim;
+            features[j].assign(f, f + rf.feature_dim);
+        }
+        return;
+    }
+
+    std::vector<cv::Mat> crops;
+    std::vector<size_t> crop_dets;
+    for (size_t j = 0; j < detections.size(); ++j) {
+        if (!need_reid[j]) continue;
+        const auto& det = detections[j];
+        cv::Rect_<int> roi(
+            static_cast<int>(det.x),
+            static_cast<int>(det.y),
+            static_cast<int>(det.width),
+            static_cast<int>(det.height)
+        );
+        // 边界检查
+        roi &= cv::Rect(0, 0, frame.cols, frame.rows);
+        if (roi.area() <= 0) {
+            crops.push_back(cv::Mat()); // 空图
+        } else {
+            crops.push_back(frame(roi).clone());
+        }
+        crop_dets.push_back(j);
+    }
+
+    if (crops.empty()) return;
+
+    // 三参数版本不写共享的 output_shapes，多路跟踪器可在不同线程同时调用同一个模型
+    std::vector<std::vector<float>> outputs;
+    std::vector<std::pair<std::string, std::vector<int>>> shapes;
+    if (reid_model_->runInference(crops, outputs, shapes) != 0 || outputs.empty()) {
+        // 推理失败，用零向量填充
+        outputs.assign(crops.size(), std::vector<float>(512, 0.0f)); // 注意：维度应匹配模型
+    } else if (outputs.size() != crops.size()) {
+        std::cerr << "⚠️ Output count mismatch! Expected "
+                  << crops.size() << ", got " << outputs.size() << std::endl;
+        outputs.assign(crops.size(), std::vector<float>(512, 0.0f));
+    }
+
+    // outputs[k] 是第 crop_dets[k] 个检测的特征；只在产生时归一化一次，匹配阶段的余弦距离退化为点积
+    for (size_t k = 0; k < crop_dets.size(); ++k) {
+        features[crop_dets[k]] = std::move(outputs[k]);
+        L2Normalize(features[crop_dets[k]]);
+    }
+}
+
+template <class Model>
+void DeepSortTracker<Model>::_match_unambiguous(
+    const std::vector<cv::Rect_<float>>& detections,
+    std::vector<std::pair<size_t, size_t>>& matches,
+    std::vector<bool>& need_reid) {
+
+    matches.clear();
+    need_reid.assign(detections.size(), _has_reid());
+    if (!_has_reid() || !lazy_reid_ || tracks_.empty() || detections.empty()) return;
+
+    // 门控候选（马氏距离通过或框有重叠）的个数，以及唯一候选时对方的下标
+    const size_t num_tracks = tracks_.size();
+    const size_t num_dets = detections.size();
+    std::vector<int> track_count(num_tracks, 0), track_only(num_tracks, -1);
+    std::vector<int> det_count(num_dets, 0), det_only(num_dets, -1);
+    for (size_t i = 0; i < num_tracks; ++i) {
+        for (int k = cand_ptr_[i]; k < cand_ptr_[i + 1]; ++k) {
+            const int j = cand_det_[k];
+            Eigen::Vector4f y = det_z_[j] - proj_mean_[i];
+            float d2 = proj_chol_[i].triangularView<Eigen::Lower>().solve(y).squaredNorm();
+            if (d2 > kChi2Inv95Dof4 && (tracks_.box(i) & detections[j]).area() <= 0) continue;
+            track_count[i]++;
+            track_only[i] = j;
+            det_count[j]++;
+            det_only[j] = static_cast<int>(i);
+        }
+    }
+
+    // 与其他检测框重叠的检测（人群、遮挡）视为有歧义
+    det_grid_.build(detections);
+    for (size_t j = 0; j < num_dets; ++j) {
+        if (det_count[j] != 1) continue;
+        const size_t i = det_only[j];
+        if (track_count[i] != 1) continue;
+        // 只对上一帧刚匹配过、已有外观特征的确认轨迹跳过 ReID；
+        // 新建 / 重新激活的轨迹，以及每 kReidRefreshHits 次命中一次的特征刷新，都照常提取
+        if (tracks_.state(i) != TrackState::Confirmed || tracks_.timeSinceUpdate(i) != 1 ||
+            tracks_.galleryCount(i) == 0 || (tracks_.hits(i) + 1) % kReidRefreshHits == 0) {
+            continue;
+        }
+        if (CalculateIoU(tracks_.box(i), detections[j]) < kUnambiguousIoU) continue;
+        query_buf_.clear();
+        det_grid_.query(detections[j], query_buf_);
+        if (query_buf_.size() > 1) continue;
+
+        matches.emplace_back(i, j);
+        need_reid[j] = false;
+    }
+}
+
+template <class Model>
+void DeepSortTracker<Model>::_prepare_candidates(const std::vector<cv::Rect_<float>>& detections) {
+    if (tracks_.empty() || detections.empty()) return;
+
+    // 门控准备：轨迹投影及其 Cholesky 因子、检测在观测空间的表示（每帧各算一次）
+    size_t num_tracks = tracks_.size();
+    size_t num_dets = detections.size();
+    proj_mean_.resize(num_tracks);
+    proj_chol_.resize(num_tracks);
+    for (size_t i = 0; i < num_tracks; ++i) {
+        Eigen::Matrix4f S;
+        tracks_.project(i, proj_mean_[i], S);
+        proj_chol_[i] = S.llt().matrixL();
+    }
+    det_z_.resize(num_dets);
+    for (size_t j = 0; j < num_dets; ++j) {
+        const cv::Rect_<float>& d = detections[j];
+        det_z_[j] = Model::fromTlwh(d.x, d.y, d.width, d.height);
+    }
+
+    // 候选配对：网格索引轨迹搜索区域，用检测框查询，再按轨迹整理成 CSR
+    // 门控椭圆 y^T S^-1 y <= χ² 在 x/y 方向的半宽为 sqrt(χ² * S_xx) / sqrt(χ² * S_yy)
+    search_regions_.resize(num_tracks);
+    for (size_t i = 0; i < num_tracks; ++i) {
+        const Eigen::Matrix4f& L = proj_chol_[i];
+        float rx = std::sqrt(kChi2Inv95Dof4 * L(0, 0) * L(0, 0));
+        float ry = std::sqrt(kChi2Inv95Dof4 * (L(1, 0) * L(1, 0) + L(1, 1) * L(1, 1)));
+        cv::Rect_<float> gate(proj_mean_[i][0] - rx, proj_mean_[i][1] - ry, 2 * rx, 2 * ry);
+        search_regions_[i] = gate | tracks_.box(i);
+    }
+    grid_.build(search_regions_);
+
+    cand_ptr_.assign(num_tracks + 1, 0);
+    query_buf_.clear();
+    std::vector<int>& hits = query_buf_;   // 依次存放每个检测的候选轨迹
+    std::vector<int> det_ptr(num_dets + 1, 0);
+    for (size_t j = 0; j < num_dets; ++j) {
+        grid_.query(detections[j], hits);
+        det_ptr[j + 1] = static_cast<int>(hits.size());
+    }
+    for (int i : hits) cand_ptr_[i + 1]++;
+    for (size_t i = 0; i < num_tracks; ++i) cand_ptr_[i + 1] += cand_ptr_[i];
+    cand_det_.resize(hits.size());
+    std::vector<int> fill(cand_ptr_.begin(), cand_ptr_.end() - 1);
+    for (size_t j = 0; j < num_dets; ++j) {
+        for (int k = det_ptr[j]; k < det_ptr[j + 1]; ++k) {
+            cand_det_[fill[hits[k]]++] = static_cast<int>(j);
+        }
+    }
+    det_col_.assign(num_dets, -1);
+}
+
+template <class Model>
+void DeepSortTracker<Model>::_match(
     const std::vector<cv::Rect_<float>>& detections,
     const std::vector<std::vector<float>>& features,
     std::vector<std::pair<size_t, size_t>>& matches,
     std::vector<size_t>& unmatched_tracks,
     std::vector<size_t>& unmatched_dets) {
 
-    matches.clear();
     unmatched_tracks.clear();
     unmatched_dets.clear();
 
@@ -177,36 +827,153 @@ void DeepSortTracker::_match(
         return;
     }
 
-    // 构建代价矩阵 (tracks x detections)
-    size_t num_tracks = tracks_.size();
-    size_t num_dets = detections.size();
-    cv::Mat cost_matrix = cv::Mat::zeros((int)num_tracks, (int)num_dets, CV_32F);
+    // matches 中已有的配对（无歧义直接匹配）不再参与级联和 IoU 匹配
+    const size_t num_tracks = tracks_.size();
+    const size_t num_dets = detections.size();
+    std::vector<bool> track_matched(num_tracks, false);
+    std::vector<bool> det_matched(num_dets, false);
+    for (const auto& [i, j] : matches) {
+        track_matched[i] = true;
+        det_matched[j] = true;
+    }
+
+    // 检测特征按轨迹特征维度打包；维度不一致的检测视为无效特征（零向量，距离为 1）
+    const size_t dim = tracks_.featureDim();
+    det_features_.assign(num_dets * dim, 0.0f);
+    for (size_t j = 0; j < num_dets; ++j) {
+        if (features[j].size() == dim) {
+            std::copy(features[j].begin(), features[j].end(), det_features_.begin() + j * dim);
+        }
+    }
+    // GEMM 每个元素的吞吐约为逐对点积的 2~3 倍（见 test_utils），候选数超过全矩阵的 1/kDenseRatio 时整体计算更快
+    const size_t kDenseRatio = 2;
+    appearance_dense_ = dim > 0 && num_tracks * num_dets <= kDenseRatio * cand_det_.size();
+    if (appearance_dense_) {
+        tracks_.appearanceDistanceMatrix(det_features_.data(), num_dets, appearance_);
+    }
 
+    std::vector<size_t> confirmed, unconfirmed;
     for (size_t i = 0; i < num_tracks; ++i) {
-        for (size_t j = 0; j < num_dets; ++j) {
-            // 计算余弦距离
-            float cos_dist = CosineLoss(tracks_[i].feature, features[j]);
-            // 计算 1 - IoU
-            float iou_dist = 1.0f - CalculateIoU(tracks_[i].box, detections[j]);
-            // 融合策略：可调整权重
-            cost_matrix.at<float>((int)i, (int)j) = iou_dist;
-        }
-    }
-
-    // ✅ 使用通用匈牙利匹配函数（带门控）
-    HungarianAlgorithm(
-        cost_matrix,
-        max_cosine_distance_,  // 门控阈值（也可用独立的匹配阈值）
-        matches,
-        unmatched_tracks,
-        unmatched_dets
-    );
+        if (track_matched[i]) continue;
+        if (tracks_.state(i) == TrackState::Confirmed) confirmed.push_back(i);
+        else unconfirmed.push_back(i);
+    }
+    for (size_t j = 0; j < num_dets; ++j) {
+        if (!det_matched[j]) unmatched_dets.push_back(j);
+    }
+
+    // SORT 模式：没有外观特征，所有未匹配轨迹直接做一次 IoU 匹配
+    if (!_has_reid()) {
+        std::vector<size_t> iou_tracks = unconfirmed;
+        iou_tracks.insert(iou_tracks.end(), confirmed.begin(), confirmed.end());
+        if (!iou_tracks.empty() && !unmatched_dets.empty()) {
+            _min_cost_matching(iou_tracks, unmatched_dets, false, detections, matches);
+        }
+        for (const auto& m : matches) track_matched[m.first] = true;
+        for (size_t i = 0; i < num_tracks; ++i) {
+            if (!track_matched[i]) unmatched_tracks.push_back(i);
+        }
+        return;
+    }
+
+    // Step A: 匹配级联，最近更新过的轨迹优先挑选检测
+    std::vector<size_t> level_tracks;
+    for (int level = 0; level < max_age_ && !unmatched_dets.empty(); ++level) {
+        level_tracks.clear();
+        for (size_t i : confirmed) {
+            if (tracks_.timeSinceUpdate(i) == 1 + level) level_tracks.push_back(i);
+        }
+        if (level_tracks.empty()) continue;
+        _min_cost_matching(level_tracks, unmatched_dets, true, detections, matches);
+    }
+
+    // Step B: IoU 匹配（未确认轨迹 + 仅丢失一帧的已确认轨迹）
+    for (const auto& m : matches) track_matched[m.first] = true;
+    std::vector<size_t> iou_tracks = unconfirmed;
+    for (size_t i : confirmed) {
+        if (!track_matched[i] && tracks_.timeSinceUpdate(i) == 1) iou_tracks.push_back(i);
+    }
+    if (!iou_tracks.empty() && !unmatched_dets.empty()) {
+        _min_cost_matching(iou_tracks, unmatched_dets, false, detections, matches);
+    }
+
+    for (const auto& m : matches) track_matched[m.first] = true;
+    for (size_t i = 0; i < num_tracks; ++i) {
+        if (!track_matched[i]) unmatched_tracks.push_back(i);
+    }
 }
 
-std::vector<cv::Rect_<float>> DeepSortTracker::_get_predicted_boxes() const {
-    std::vector<cv::Rect_<float>> boxes;
-    for (const auto& track : tracks_) {
-        boxes.push_back(track.box);
+template <class Model>
+void DeepSortTracker<Model>::_min_cost_matching(
+    const std::vector<size_t>& track_ids,
+    std::vector<size_t>& det_ids,
+    bool appearance,
+    const std::vector<cv::Rect_<float>>& detections,
+    std::vector<std::pair<size_t, size_t>>& matches) {
+
+    // 只在网格候选中建 CSR 代价矩阵；不在矩阵中的配对即不可匹配
+    const float threshold = appearance ? max_cosine_distance_ : max_iou_distance_;
+    for (size_t c = 0; c < det_ids.size(); ++c) det_col_[det_ids[c]] = static_cast<int>(c);
+    sparse_cost_.reset(static_cast<int>(det_ids.size()));
+
+    for (size_t i : track_ids) {
+        for (int k = cand_ptr_[i]; k < cand_ptr_[i + 1]; ++k) {
+            const int j = cand_det_[k];
+            const int c = det_col_[j];
+            if (c < 0) continue;
+            float cost;
+            if (appearance) {
+                // 先用马氏距离排除运动上不可能的配对，再计算外观代价
+                Eigen::Vector4f y = det_z_[j] - proj_mean_[i];
+                float d2 = proj_chol_[i].triangularView<Eigen::Lower>().solve(y).squaredNorm();
+                if (d2 > kChi2Inv95Dof4) continue;
+                const size_t dim = tracks_.featureDim();
+                if (dim == 0) {
+                    cost = 1.0f;
+                } else if (appearance_dense_) {
+                    cost = appearance_(i, j);
+                } else {
+                    cost = tracks_.appearanceDistance(i, det_features_.data() + j * dim);
+                }
+            } else {
+                cost = 1.0f - CalculateIoU(tracks_.box(i), detections[j]);
+            }
+            if (cost > threshold) continue;   // 超阈值的配对不会被采纳，不必进入矩阵
+            sparse_cost_.push(c, cost);
+        }
+        sparse_cost_.endRow();
+    }
+    for (size_t j : det_ids) det_col_[j] = -1;
+
+    std::vector<std::pair<size_t, size_t>> local_matches;
+    std::vector<size_t> local_unmatched_tracks, local_unmatched_dets;
+    LinearAssignment(
+        sparse_cost_,
+        threshold,
+        assignment_mode_,
+        assignment_ws_,
+        local_matches,
+        local_unmatched_tracks,
+        local_unmatched_dets
+    );
+
+    for (const auto& [r, c] : local_matches) {
+        matches.emplace_back(track_ids[r], det_ids[c]);
     }
-    return boxes;
-}
\ No newline at end of file
+    std::vector<size_t> remaining;
+    remaining.reserve(local_unmatched_dets.size());
+    for (size_t c : local_unmatched_dets) remaining.push_back(det_ids[c]);
+    det_ids.swap(remaining);
+}
+
+template <class Model>
+std::vector<cv::Rect_<float>> DeepSortTracker<Model>::_get_predicted_boxes() const {
+    return tracks_.boxes();
+}
+
+template Track::Track(const TrackStore<ConstantVelocityXYAH>&, size_t);
+template Track::Track(const TrackStore<ConstantVelocityXYWH>&, size_t);
+template Track::Track(const TrackStore<ConstantAccelerationXYAH>&, size_t);
+template class DeepSortTracker<ConstantVelocityXYAH>;
+template class DeepSortTracker<ConstantVelocityXYWH>;
+template class DeepSortTracker<ConstantAccelerationXYAH>;
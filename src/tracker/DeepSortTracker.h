@@ -9,82 +9,285 @@
 
 // ==================== 自定义模块 ====================
 #include "kalmanfilter/kalman.h"        // Kalman 滤波器，用于目标运动预测
+#include "tracker/TrackStore.h"         // 轨迹 SoA 存储（框、Kalman 状态、计数器、特征）
 #include "yolo/onnx_yolo_detecter.h"    // YOLO 检测器（此处仅声明依赖，实际在 cpp 中使用）
 #include "InferMNN/mnnInfer.h"          // MNN ReID 特征提取器（用于外观特征）
 #include "utils/utils.h"                // 工具函数：IoU、余弦距离、坐标转换等
-
-// ==================== 轨迹状态枚举 ====================
-// 定义轨迹的三种生命周期状态，用于控制轨迹是否输出
-enum class TrackState {
-    Tentative,   // 试探态：刚创建，尚未确认（避免误检输出）
-    Confirmed,   // 已确认：连续命中多次，可信度高，参与输出和匹配
-    Deleted      // 已删除：长时间未匹配，从跟踪列表中移除
-};
+#include "utils/spatial_grid.h"         // 均匀网格空间索引（稀疏代价矩阵的候选配对）
+#include "gallery/ReidGallery.h"        // 跨摄像头 ReID 特征库（HNSW）
+#include "tracker/FlightRecorder.h"     // 飞行记录仪（逐帧输入、匹配决策与分阶段耗时）
+#include "tracker/FlowRefiner.h"        // 插帧的稀疏光流框跟踪
 
 // ==================== 轨迹类（Track） ====================
-// 每个目标对应一个 Track 实例，封装状态、滤波器、特征和生命周期
+// 对外接口使用的轻量轨迹快照：轨迹数据本体保存在 TrackStore 的 SoA 数组中，
+// Track 只在输出时从存储中取出 id、框、特征和生命周期信息，不再持有 Kalman 滤波器
 class Track {
     public:
-        // 构造函数：用首次检测框和 ReID 特征初始化轨迹
-        // - id: 全局唯一轨迹 ID
-        // - box: 检测框（格式：x, y, w, h，即 tlwh）
-        // - feature: ReID 外观特征向量（如 128 维 float 向量）
-        Track(int id, const cv::Rect_<float>& box, const std::vector<float>& feature, int n_init);
-        
-        // 预测：调用 Kalman 滤波器预测下一帧位置，并更新内部 box
-        void predict();
-        
-        // 更新：当轨迹与检测匹配时，用新观测更新 Kalman 状态和特征
-        // - box: 新的检测框（tlwh）
-        // - feature: 新提取的 ReID 特征
-        void update(const cv::Rect_<float>& box, const std::vector<float>& feature);
+        Track() = default;
+
+        // 从 SoA 存储中取出第 index 条轨迹
+        template <class Model>
+        Track(const TrackStore<Model>& store, size_t index);
 
         // 获取当前轨迹框（tlwh 格式），用于输出或可视化
         cv::Rect_<float> to_tlwh() const;
 
         // =============== 公有成员变量（便于访问）===============
-        int id;                          // 轨迹唯一 ID
+        int id = 0;                      // 轨迹唯一 ID
         cv::Rect_<float> box;            // 当前位置（tlwh 格式）
         std::vector<float> feature;      // 最新 ReID 特征（用于外观匹配）
-        KalmanFilter kalman;             // Kalman 滤波器实例（每轨迹独享）
-        
+
         // 生命周期计数器
-        int time_since_update;  // 自上次成功匹配以来经过的帧数（用于判断是否删除）
-        int hits;               // 连续成功匹配的次数（用于从 Tentative 升级为 Confirmed）
-        int age;                // 轨迹总存活帧数（从创建至今）
-        TrackState state;       // 当前轨迹状态（Tentative / Confirmed / Deleted）
-        int n_init_;            // Track 自己保存 n_init 轨迹确认所需最小命中次数
+        int time_since_update = 0;  // 自上次成功匹配以来经过的帧数（用于判断是否删除）
+        int hits = 0;               // 连续成功匹配的次数（用于从 Tentative 升级为 Confirmed）
+        int age = 0;                // 轨迹总存活帧数（从创建至今）
+        TrackState state = TrackState::Tentative; // 当前轨迹状态（Tentative / Confirmed / Deleted）
+};
+
+// ==================== 轨迹输出（TrackOutput） ====================
+// 逐帧输出只需要的字段：不含特征和 Kalman 状态，写入调用方复用的缓冲区，无逐轨迹堆分配
+struct TrackOutput {
+    int id = 0;                      // 轨迹唯一 ID
+    TrackHandle handle;              // 稳定 slot 句柄，可直接索引调用方的逐轨迹数据
+    cv::Rect_<float> box;            // 当前位置（tlwh 格式）
+    TrackState state = TrackState::Tentative;
+    int age = 0;                     // 轨迹总存活帧数
+    cv::Point2f velocity;            // Kalman 估计的中心点速度（像素/帧）
+};
+
+// ==================== ReID 提取统计 ====================
+// 懒提取模式下，运动上无歧义的检测不做 ReID；累计计数用于评估节省的推理量
+struct ReidStats {
+    size_t crops_total = 0;          // 累计检测数
+    size_t crops_extracted = 0;      // 累计送入 ReID 的裁剪图数
+    size_t crops_skipped = 0;        // 累计跳过的裁剪图数
+    size_t last_frame_extracted = 0; // 最近一帧送入 ReID 的数量
+    size_t last_frame_skipped = 0;   // 最近一帧跳过的数量
+};
+
+// ==================== 关键帧 / 插帧统计 ====================
+struct KeyframeStats {
+    size_t keyframes = 0;            // 累计关键帧（带检测的 update()）
+    size_t interframes = 0;          // 累计插帧（propagate()）
+    size_t forced_keyframes = 0;     // 因光流漂移提前到来的关键帧
+    size_t flow_tracked = 0;         // 插帧中光流观测被采用的轨迹次数
+    size_t flow_failed = 0;          // 插帧中光流失败的轨迹次数
+    size_t flow_drifted = 0;         // 插帧中光流与 Kalman 预测偏差过大、被丢弃的轨迹次数
 };
 
 // ==================== DeepSORT 跟踪器主类 ====================
 // 封装多目标跟踪的核心逻辑：预测、匹配、更新、创建、删除
+// - Model: Kalman 运动模型（见 motion_models.h），默认为 DeepSORT 的匀速 xyah；
+//   门控与 IoU 关联都在由检测框换算的 4 维观测上进行，可选模型的观测均为 4 维
+template <class Model = ConstantVelocityXYAH>
 class DeepSortTracker {
     public:
         // 构造函数：初始化跟踪器参数和 ReID 模型
-        // - reid_model_path: ReID 模型文件路径（.mnn）
+        // - reid_model_path: ReID 模型文件路径（.mnn）；为空时为 SORT 模式：
+        //   不加载 ReID 模型、不裁剪检测、轨迹不存特征，只用 Kalman 运动 + IoU 关联（frame 可传空 Mat）
         // - max_iou_distance: IoU 匹配阈值（用于初步筛选）
         // - max_age: 轨迹最大存活时间（未匹配超过此帧数则删除）
         // - n_init: 轨迹确认所需最小连续命中次数（如 3 帧）
         // - max_cosine_distance: 余弦距离阈值（> 此值认为外观不匹配）
+        // - assignment_mode: 分配算法（默认 LAPJV 最优分配，可选贪心）
+        // - gallery: 每条轨迹的外观特征库（容量 nn_budget、聚合方式、内存上限）
+        // - lazy_reid: 先做运动关联，只对有歧义、新建或重新激活的检测提取 ReID 特征
+        // - high_score_threshold: detect_result 接口的高/低分检测分界（ByteTrack 两阶段关联）
         DeepSortTracker(
             const std::string& reid_model_path,
             float max_iou_distance = 0.7f,
             int max_age = 30,
             int n_init = 3,
-            float max_cosine_distance = 0.2f
+            float max_cosine_distance = 0.2f,
+            AssignmentMode assignment_mode = AssignmentMode::LAPJV,
+            const GalleryConfig& gallery = GalleryConfig(),
+            bool lazy_reid = true,
+            float high_score_threshold = 0.5f
+        );
+
+        // 共享 ReID 模型的构造：多路跟踪器（见 TrackerManager）共用同一个 MNNInfer，权重只加载一次
+        // - reid_model: 已加载的 ReID 模型；为空指针时为 SORT 模式
+        // 其余参数同上
+        DeepSortTracker(
+            std::shared_ptr<MNNInfer> reid_model,
+            float max_iou_distance = 0.7f,
+            int max_age = 30,
+            int n_init = 3,
+            float max_cosine_distance = 0.2f,
+            AssignmentMode assignment_mode = AssignmentMode::LAPJV,
+            const GalleryConfig& gallery = GalleryConfig(),
+            bool lazy_reid = true,
+            float high_score_threshold = 0.5f
         );
 
+        // 加载 ReID 模型（路径为空时返回空指针，加载失败时抛出 std::runtime_error）
+        // - num_sessions: 会话池大小；多个跟踪器在不同线程共享该模型时设为线程数
+        static std::shared_ptr<MNNInfer> loadReidModel(const std::string& reid_model_path, int num_sessions = 1);
+
+        // 不提供帧时间戳：按相邻两次 update() 相隔一个标称帧预测
+        static constexpr double kNoTimestamp = -1.0;
+
         // 主接口：输入当前帧图像和检测结果，输出跟踪轨迹
         // - frame: 当前视频帧（用于 ReID 特征提取）
         // - detections: YOLO 等检测器输出的边界框列表（tlwh 格式）
+        // - timestamp: 帧时间戳（秒，非负且单调）；Kalman 按与上一帧的实际间隔 / frameInterval() 外推，
+        //   丢帧、抽帧或帧率与标称值不同时运动预测仍然正确；kNoTimestamp 时按一帧预测
         // - 返回: 所有 Confirmed 状态的轨迹（可用于可视化或后续处理）
-        std::vector<Track> update(const cv::Mat& frame, const std::vector<cv::Rect_<float>>& detections);
+        // 便捷接口：每条轨迹拷贝出完整快照（含特征）；逐帧调用建议使用下方的 TrackOutput 版本
+        std::vector<Track> update(const cv::Mat& frame, const std::vector<cv::Rect_<float>>& detections,
+                                  double timestamp = kNoTimestamp);
+
+        // 轻量接口：与上面相同的跟踪流程，Confirmed 轨迹写入 outputs（先清空，复用其容量）
+        void update(const cv::Mat& frame, const std::vector<cv::Rect_<float>>& detections,
+                    std::vector<TrackOutput>& outputs, double timestamp = kNoTimestamp);
+
+        // 带置信度的检测（ONNXYoloDetector 的输出），ByteTrack 式两阶段关联：
+        // - confidence >= high_score_threshold：与上面的接口相同（外观级联 + IoU），未匹配的创建新轨迹
+        // - 低分检测：只用 IoU 关联第一阶段剩下的、上一帧仍在跟踪的轨迹，不送入 ReID，也不创建新轨迹
+        // 检测器的置信度阈值因此可以放低，召回低分的遮挡目标而不增加 ReID 开销
+        std::vector<Track> update(const cv::Mat& frame, const std::vector<detect_result>& detections,
+                                  double timestamp = kNoTimestamp);
+        void update(const cv::Mat& frame, const std::vector<detect_result>& detections,
+                    std::vector<TrackOutput>& outputs, double timestamp = kNoTimestamp);
+
+        // ==== 变帧间隔预测 ====
+        // 标称帧间隔（秒，默认 1/30）：Kalman 的 q_pos / q_vel 和输出速度都以一个标称帧为单位，
+        // 带时间戳的 update() 按 (timestamp - 上一帧时间戳) / frameInterval() 一次外推多帧（可为小数）。
+        // 单次外推最多 max_age 帧（长时间断流后不再外推到画面之外）；时间戳回退时按 0 帧处理。
+        // age、time_since_update 与 max_age 仍按 update() 调用次数计，抽帧不会让轨迹更快被删除
+        void setFrameInterval(double seconds) { frame_interval_ = seconds; }
+        double frameInterval() const { return frame_interval_; }
+        // 最近一帧实际使用的外推步长（标称帧数）
+        float lastDt() const { return last_dt_; }
+
+        // ==== 关键帧 / 插帧（检测器每 k 帧运行一次）====
+        // 调用方每帧先问 needsDetection()：为 true 时检测并调用 update()（关键帧），
+        // 否则跳过检测和 ReID，调用 propagate()（插帧）。detect_interval = 1（默认）时每帧都是关键帧
+        void setKeyframeConfig(const KeyframeConfig& config);
+        const KeyframeConfig& keyframeConfig() const { return keyframe_config_; }
+        // 下一帧是否需要检测：插帧关闭、距上一关键帧已满 detect_interval 帧、上一插帧判定漂移，
+        // 或还没有光流参考帧（刚创建 / restore() 之后）时为 true
+        bool needsDetection() const;
+        // 插帧：不做检测和 ReID。所有轨迹按 Kalman 预测，再以缩小灰度图上的稀疏光流框作为观测更新；
+        // 光流失败或与预测偏差超过 drift_threshold 的轨迹只保留预测（计一次未匹配），
+        // 这类 Confirmed 轨迹占比超过 max_drift_ratio 时下一帧强制检测。不新建轨迹，不更新特征库
+        // - frame: 当前帧（必须与关键帧同尺寸）；timestamp 同 update()
+        void propagate(const cv::Mat& frame, std::vector<TrackOutput>& outputs, double timestamp = kNoTimestamp);
+        // 关键帧 / 插帧统计（累计值，可随时清零）
+        const KeyframeStats& keyframeStats() const { return keyframe_stats_; }
+        void resetKeyframeStats() { keyframe_stats_ = KeyframeStats(); }
+
+        // ==== 稳态 Kalman 增益缓存 ====
+        // 开启后协方差已收敛的轨迹跳过协方差传播，预测只推进均值、命中时用预先算好的增益（见 KalmanGainCache）。
+        // 只作用于 dt = 1 的帧（按帧号驱动，或时间戳恰为标称帧间隔）；其余帧自动退回完整传播
+        void setGainCache(const GainCacheConfig& config) { tracks_.setGainCache(config); }
+        // 多路共享同一张表（表只读，可跨线程共享）
+        void setGainCache(std::shared_ptr<const KalmanGainCache<Model>> cache) { tracks_.setGainCache(std::move(cache)); }
+        const GainCacheConfig& gainCacheConfig() const { return tracks_.gainCacheConfig(); }
+        // 当前使用的表（未开启时为空）
+        const std::shared_ptr<const KalmanGainCache<Model>>& gainCache() const { return tracks_.gainCache(); }
+        // 当前协方差由缓存表示的轨迹数
+        size_t gainCachedTracks() const { return tracks_.cachedCount(); }
+
+        // 本跟踪器（一路视频）的状态占用的堆内存字节数：轨迹存储、特征库和逐帧复用的缓冲，
+        // 不含共享的 ReID 模型
+        size_t memoryBytes() const;
+
+        // 是否为 SORT 模式（构造时 reid_model_path 为空）
+        bool sortMode() const { return reid_model_ == nullptr; }
+
+        // ReID 提取统计（累计值，可随时清零）
+        const ReidStats& reidStats() const { return reid_stats_; }
+        void resetReidStats() { reid_stats_ = ReidStats(); }
+
+        // 接入跨摄像头特征库（可多路共享）：轨迹确认时、以及已确认轨迹被删除时，
+        // 把其代表特征（特征库均值）连同 camera_id、轨迹 ID、帧号入库；传空指针断开
+        // 特征维度与特征库不一致时不入库
+        void setReidGallery(std::shared_ptr<ReidGallery> gallery, int camera_id);
+
+        // ==== 快照（故障转移时把一路的跟踪状态交给另一个进程）====
+        // 序列化全部跟踪状态：轨迹（框、Kalman 均值/协方差、计数器、slot 池、特征库）、
+        // 下一个 ID、帧号、ReID 统计和超参数；out 的容量跨次复用
+        // - full_gallery = false：每条轨迹只保存最新特征，快照小得多，恢复后特征库重新积累
+        void snapshot(std::vector<char>& out, bool full_gallery = true);
+        // 从 snapshot() 的输出恢复（可直接传入 mmap 的文件内容），替换当前全部状态；
+        // ReID 模型和跨摄像头特征库不在快照中，保持不变；已接入的增益缓存表与快照配置相同时沿用（不另建副本）。
+        // 格式、版本或运动模型不符时抛出 std::runtime_error
+        void restore(const void* data, size_t size);
+        // 写入文件（先写临时文件再重命名，不会留下半个快照）/ mmap 读取文件并恢复
+        void saveSnapshot(const std::string& path, bool full_gallery = true);
+        void loadSnapshot(const std::string& path);
+
+        // ==== 飞行记录与回放（复现线上的耗时尖峰）====
+        // 最近一帧的分阶段耗时（每帧都测量）
+        const StageTimings& lastTimings() const { return last_timings_; }
+        // 接入飞行记录仪：此后每帧记录检测、ReID 特征、匹配决策和分阶段耗时；传空指针断开
+        void setFlightRecorder(std::shared_ptr<FlightRecorder> recorder) { recorder_ = std::move(recorder); }
+        // 回放一帧记录：检测取自记录，ReID 特征取自记录而不做推理（不需要图像和模型），
+        // 从记录起点的快照 restore() 后逐帧回放，匹配结果与记录时一致
+        // - with_reid: 按记录时的模式走 DeepSORT（true）或 SORT（false）流程，见 FlightRecord::with_reid
+        void replay(const FlightFrame& frame, bool with_reid, std::vector<TrackOutput>& outputs);
 
     private:
-        // 匹配函数：将现有轨迹与当前检测进行关联
+        // 一帧完整流程：预测、候选配对、无歧义匹配、按需 ReID、级联匹配、更新、删除、创建（两个 update 接口共用）
+        // - low_detections: 低分检测，只参与第二阶段 IoU 关联
+        // - dt: Kalman 外推的标称帧数（见 _elapsed_frames）
+        void _step(const cv::Mat& frame, const std::vector<cv::Rect_<float>>& detections,
+                   const std::vector<cv::Rect_<float>>& low_detections, float dt);
+
+        // 由帧时间戳算出距上一帧的标称帧数，并记下本帧时间戳；kNoTimestamp 时为 1
+        float _elapsed_frames(double timestamp);
+
+        // 插帧流程：预测、光流观测（回放时取自记录）、漂移判定、观测更新、删除
+        void _interframe(const cv::Mat& frame, float dt);
+
+        // 未匹配轨迹累加 time_since_update，超过 max_age 或未确认的删除（原地压缩，slot 回收复用）
+        void _remove_stale(const std::vector<bool>& track_used);
+
+        // 按 high_score_threshold_ 把检测分到 high_dets_ / low_dets_
+        void _split_by_score(const std::vector<detect_result>& detections);
+
+        // 输出 Confirmed 轨迹
+        void _collect(std::vector<Track>& results) const;
+        void _collect(std::vector<TrackOutput>& outputs) const;
+
+        // 第二阶段：低分检测与第一阶段未匹配、上一帧仍在跟踪的 Confirmed 轨迹做 IoU 匹配
+        // - low_matches: 输出（轨迹索引, 低分检测索引）
+        void _match_low_score(
+            const std::vector<cv::Rect_<float>>& low_detections,
+            const std::vector<size_t>& unmatched_tracks,
+            std::vector<std::pair<size_t, size_t>>& low_matches
+        );
+
+        // 门控准备（轨迹投影、Cholesky 因子、检测 xyah）与网格候选配对，每帧一次
+        void _prepare_candidates(const std::vector<cv::Rect_<float>>& detections);
+
+        // 运动上无歧义的配对直接匹配，不需要外观特征：
+        // 检测与轨迹互为唯一的门控候选、IoU >= kUnambiguousIoU、检测框不与其他检测重叠，
+        // 且轨迹为上一帧刚匹配过、已有外观特征的 Confirmed 轨迹。
+        // - matches: 输出直接匹配的配对
+        // - need_reid: 输出每个检测是否仍需提取 ReID 特征
+        void _match_unambiguous(
+            const std::vector<cv::Rect_<float>>& detections,
+            std::vector<std::pair<size_t, size_t>>& matches,
+            std::vector<bool>& need_reid
+        );
+
+        // 只对 need_reid 的检测裁剪并批量推理，其余检测的特征为空
+        void _extract_features(
+            const cv::Mat& frame,
+            const std::vector<cv::Rect_<float>>& detections,
+            const std::vector<bool>& need_reid,
+            std::vector<std::vector<float>>& features
+        );
+
+        // 匹配函数：将现有轨迹与当前检测进行关联（DeepSORT 匹配级联）
+        // 1. 已确认轨迹按 time_since_update 由小到大分层，逐层用外观代价匹配（马氏距离门控）
+        // 2. 未确认轨迹 + 上一帧刚匹配过但本层未匹配的已确认轨迹，用 IoU 匹配剩余检测
+        // SORT 模式下跳过 1，所有未匹配轨迹一起做 IoU 匹配
         // - detections: 当前帧检测框
         // - features: 对应的 ReID 特征
-        // - matches: 输出匹配对（轨迹索引, 检测索引）
+        // - matches: 输入已直接匹配的配对，追加级联和 IoU 匹配的结果（轨迹索引, 检测索引）
         // - unmatched_tracks: 未匹配的轨迹索引
         // - unmatched_dets: 未匹配的检测索引
         void _match(
@@ -95,11 +298,30 @@ class DeepSortTracker {
             std::vector<size_t>& unmatched_dets
         );
 
+        // 单层最小代价匹配：在 track_ids x det_ids 子集上建稀疏（CSR）代价矩阵并求解分配
+        // 只考虑空间网格给出的候选配对，其余配对视为不可匹配
+        // - appearance = true：先做马氏距离 χ² 门控，只对通过门控的配对计算余弦距离（级联阶段）
+        // - appearance = false：代价为 1 - IoU（IoU 阶段）
+        // 匹配结果追加到 matches，det_ids 中删去已匹配的检测
+        void _min_cost_matching(
+            const std::vector<size_t>& track_ids,
+            std::vector<size_t>& det_ids,
+            bool appearance,
+            const std::vector<cv::Rect_<float>>& detections,
+            std::vector<std::pair<size_t, size_t>>& matches
+        );
+
+        // 本帧是否走外观流程：有 ReID 模型，或回放一段带 ReID 的记录
+        bool _has_reid() const { return replay_frame_ != nullptr ? replay_reid_ : reid_model_ != nullptr; }
+
         // 辅助函数：获取所有轨迹的预测框（用于匹配）
         std::vector<cv::Rect_<float>> _get_predicted_boxes() const;
 
+        // 把第 i 条轨迹的代表特征写入跨摄像头特征库
+        void _publish(size_t i);
+
         // =============== 私有成员变量 ===============
-        std::vector<Track> tracks_;      // 当前所有活跃轨迹（包括 Tentative 和 Confirmed）
+        TrackStore<Model> tracks_;       // 当前所有活跃轨迹（包括 Tentative 和 Confirmed），按字段连续存放
         int next_id_;                    // 下一个新轨迹的 ID（自增）
 
         // 跟踪超参数（可在构造时配置）
@@ -107,9 +329,98 @@ class DeepSortTracker {
         int max_age_;                    // 轨迹最大未匹配帧数
         int n_init_;                     // 轨迹确认所需最小命中次数
         float max_cosine_distance_;      // 余弦距离阈值（越小越严格）
+        AssignmentMode assignment_mode_; // 分配算法（贪心 / LAPJV）
+        AssignmentWorkspace assignment_ws_; // 分配求解器工作区（跨帧复用）
+
+        // 懒 ReID
+        static constexpr float kUnambiguousIoU = 0.5f;  // 无歧义配对的最小 IoU
+        static constexpr int kReidRefreshHits = 10;     // 无歧义轨迹每命中这么多次仍提取一次特征，保持特征库更新
+        bool lazy_reid_;                 // 是否启用懒提取
+        ReidStats reid_stats_;           // 提取统计
+        SpatialGrid det_grid_;           // 检测框网格（判断检测之间是否重叠、低分检测候选）
+
+        // 快照
+        struct SavedState {
+            int32_t next_id;
+            int32_t max_age;
+            int32_t n_init;
+            int32_t assignment_mode;
+            float max_iou_distance;
+            float max_cosine_distance;
+            float high_score_threshold;
+            int32_t lazy_reid;
+            int64_t frame_index;
+            double frame_interval;
+            double last_timestamp;
+        };
+        SavedState saved_state_;
+        SnapshotWriter snapshot_writer_;
+        std::vector<char> snapshot_buf_; // saveSnapshot 的序列化缓冲
+
+        // 跨摄像头特征库
+        std::shared_ptr<ReidGallery> reid_gallery_;
+        int camera_id_ = 0;
+        int64_t frame_index_ = 0;        // 已处理帧数（入库记录的帧号）
+        std::vector<float> publish_buf_; // 代表特征缓冲
+
+        // 飞行记录与回放
+        StageTimings last_timings_;
+        std::shared_ptr<FlightRecorder> recorder_;
+        const FlightFrame* replay_frame_ = nullptr;  // 回放中的记录帧（非回放时为空）
+        bool replay_reid_ = false;
+
+        // 变帧间隔预测
+        double frame_interval_ = 1.0 / 30.0;         // 标称帧间隔（秒）
+        double last_timestamp_ = kNoTimestamp;       // 上一帧时间戳
+        float last_dt_ = 1.0f;                       // 上一帧的外推步长
+
+        // 关键帧 / 插帧
+        KeyframeConfig keyframe_config_;
+        KeyframeStats keyframe_stats_;
+        FlowRefiner flow_;
+        int frames_since_keyframe_ = 0;              // 上一关键帧之后的插帧数
+        bool force_detect_ = false;                  // 上一插帧判定漂移，下一帧强制检测
+        std::vector<cv::Rect_<float>> flow_from_;    // 参考帧上的框（光流起点）
+        std::vector<cv::Rect_<float>> flow_to_;      // 光流测得的框
+        std::vector<bool> flow_ok_;
+        std::vector<uint32_t> refine_idx_;           // 采用光流观测的轨迹与其观测框
+        std::vector<cv::Rect_<float>> refine_boxes_;
+
+        // 两阶段关联
+        static constexpr float kLowScoreIoUDistance = 0.5f;  // 低分检测的 IoU 距离阈值（ByteTrack 第二阶段）
+        float high_score_threshold_;     // 高/低分检测分界
+
+        // 逐帧标记缓冲（复用容量，稳态帧不重新分配）
+        std::vector<bool> track_used_;
+        std::vector<bool> det_used_;
+        std::vector<bool> keep_;
+        std::vector<cv::Rect_<float>> high_dets_;  // detect_result 接口的分组缓冲（逐帧复用）
+        std::vector<cv::Rect_<float>> low_dets_;
+
+        // 马氏距离门控的逐帧缓存（每帧每条轨迹/检测只算一次）
+        std::vector<Eigen::Vector4f> proj_mean_;   // 轨迹投影均值 H x
+        std::vector<Eigen::Matrix4f> proj_chol_;   // 投影协方差 S 的 Cholesky 下三角因子
+        std::vector<Eigen::Vector4f> det_z_;       // 检测框在观测空间的表示（Model::fromTlwh）
+
+        // 稀疏代价矩阵构建（每帧重建，跨帧复用内存）
+        // 轨迹搜索区域 = 预测框 ∪ 门控椭圆外接框，是马氏门控和 IoU > 0 两种条件的超集，
+        // 因此只在区域与检测框相交的配对上计算代价，结果与稠密代价矩阵一致
+        SpatialGrid grid_;                         // 轨迹搜索区域的网格索引
+        std::vector<cv::Rect_<float>> search_regions_;
+        std::vector<int> cand_ptr_;                // 第 i 条轨迹的候选检测位于 cand_det_[cand_ptr_[i], cand_ptr_[i + 1])
+        std::vector<int> cand_det_;
+        std::vector<int> det_col_;                 // 检测在当前 det_ids 中的列号，-1 表示已匹配
+        std::vector<int> query_buf_;
+        SparseCostMatrix sparse_cost_;
+
+        // 外观距离（特征均已 L2 归一化，由 TrackStore 在每条轨迹的特征库上聚合）
+        // 候选配对足够稠密时逐轨迹 GEMM 算出 轨迹 x 检测 全矩阵，否则只对候选逐对计算
+        std::vector<float> det_features_;          // 检测特征：num_dets x featureDim 行优先
+        RowMajorMatrixXf appearance_;              // GEMM 结果：num_tracks x num_dets
+        bool appearance_dense_ = false;            // 本帧是否使用 appearance_
 
-        // ReID 模型实例（使用智能指针自动管理内存）
-        std::unique_ptr<MNNInfer> reid_model_;
+        // ReID 模型实例（可由多路跟踪器共享；SORT 模式下为空）
+        std::shared_ptr<MNNInfer> reid_model_;
 };
 
 #endif // DEEPSORTTRACKER_H
\ No newline at end of file
@@ -0,0 +1,286 @@
+#include "FlightRecorder.h"
+#include "DeepSortTracker.h"
+#include "utils/snapshot.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+
+// 转储文件头（FRHD 节）
+struct DumpHeader {
+    int32_t with_reid;
+    int32_t num_frames;
+    int64_t checkpoint_frame;      // 快照之后的第一帧，等于第一条记录的帧号
+    int64_t trigger_frame;
+    float trigger_ms;
+    float threshold_ms;
+};
+
+// 每帧的定长部分（FRFM 节）；变长数据按帧顺序拼接在各自的节中
+struct FrameMeta {
+    int64_t frame_index;
+    int64_t timestamp_us;
+    uint32_t num_dets;
+    uint32_t num_low_dets;
+    uint32_t num_features;
+    uint32_t feature_dim;
+    uint32_t num_matches;
+    uint32_t num_low_matches;
+    uint32_t interframe;
+    uint32_t num_flows;
+    float dt;
+    StageTimings timings;
+};
+
+} // namespace
+
+const char* StageTimings::name(TrackerStage s) {
+    switch (s) {
+        case TrackerStage::Record:      return "record";
+        case TrackerStage::Predict:     return "predict";
+        case TrackerStage::Flow:        return "flow";
+        case TrackerStage::Gating:      return "gating";
+        case TrackerStage::Unambiguous: return "unambiguous";
+        case TrackerStage::Reid:        return "reid";
+        case TrackerStage::Match:       return "match";
+        case TrackerStage::Update:      return "update";
+        default:                        return "?";
+    }
+}
+
+void FlightFrame::clear() {
+    detections.clear();
+    low_detections.clear();
+    dt = 1.0f;
+    interframe = false;
+    flows.clear();
+    feature_dets.clear();
+    features.clear();
+    feature_dim = 0;
+    matches.clear();
+    low_matches.clear();
+    timings = StageTimings();
+}
+
+FlightRecorder::FlightRecorder(const FlightRecorderConfig& config)
+    : config_(config), ring_(std::max<size_t>(config.capacity_frames, 2)) {}
+
+void FlightRecorder::reset() {
+    head_ = 0;
+    count_ = 0;
+    last_frame_ = -1;
+    current_ = nullptr;
+    for (Checkpoint& c : checkpoints_) c.frame_index = -1;
+    latest_checkpoint_ = -1;
+    frames_since_checkpoint_ = 0;
+    cooldown_ = 0;
+}
+
+std::vector<char>* FlightRecorder::_checkpoint(int64_t frame_index, bool with_reid) {
+    if (last_frame_ >= 0 && frame_index != last_frame_ + 1) reset();
+    last_frame_ = frame_index;
+    with_reid_ = with_reid;
+
+    // 每半个窗口保存一次快照：转储时总有一个快照落在缓冲覆盖的范围内，且其后至少有半个窗口的帧
+    std::vector<char>* data = nullptr;
+    if (latest_checkpoint_ < 0 || frames_since_checkpoint_ >= ring_.size() / 2) {
+        latest_checkpoint_ = latest_checkpoint_ < 0 ? 0 : 1 - latest_checkpoint_;
+        Checkpoint& c = checkpoints_[latest_checkpoint_];
+        c.frame_index = frame_index;
+        data = &c.data;
+        frames_since_checkpoint_ = 0;
+    }
+    frames_since_checkpoint_++;
+    return data;
+}
+
+FlightFrame& FlightRecorder::_begin_frame(int64_t frame_index) {
+    current_ = &ring_[head_];
+    head_ = (head_ + 1) % ring_.size();
+    count_ = std::min(count_ + 1, ring_.size());
+
+    current_->clear();
+    current_->frame_index = frame_index;
+    current_->timestamp_us = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    return *current_;
+}
+
+void FlightRecorder::endFrame() {
+    if (current_ == nullptr) return;
+    const FlightFrame& f = *current_;
+    current_ = nullptr;
+
+    if (cooldown_ > 0) {
+        cooldown_--;
+        return;
+    }
+    if (config_.spike_threshold_ms <= 0.0f || f.timings.total_ms <= config_.spike_threshold_ms) return;
+
+    // 自动转储发生在跟踪线程上，失败只告警，不影响跟踪
+    const std::string path = config_.dump_prefix + "_" + std::to_string(f.frame_index) + ".fdr";
+    try {
+        dump(path);
+    } catch (const std::exception& e) {
+        std::cerr << "⚠️ Flight recorder dump failed: " << e.what() << std::endl;
+    }
+    cooldown_ = ring_.size() / 2;
+}
+
+size_t FlightRecorder::dump(const std::string& path) {
+    if (count_ == 0 || latest_checkpoint_ < 0) return 0;
+
+    // 选缓冲仍覆盖的最早快照，转储它之后的全部帧
+    const int64_t oldest = frame(0).frame_index;
+    const Checkpoint* ckpt = &checkpoints_[latest_checkpoint_];
+    const Checkpoint& older = checkpoints_[1 - latest_checkpoint_];
+    if (older.frame_index >= oldest && older.frame_index < ckpt->frame_index) ckpt = &older;
+    const size_t first = static_cast<size_t>(ckpt->frame_index - oldest);
+    const FlightFrame& last = frame(count_ - 1);
+
+    DumpHeader header;
+    header.with_reid = with_reid_ ? 1 : 0;
+    header.num_frames = static_cast<int32_t>(count_ - first);
+    header.checkpoint_frame = ckpt->frame_index;
+    header.trigger_frame = last.frame_index;
+    header.trigger_ms = last.timings.total_ms;
+    header.threshold_ms = config_.spike_threshold_ms;
+
+    std::vector<FrameMeta> metas;
+    std::vector<cv::Rect_<float>> rects;
+    std::vector<int32_t> feature_dets;
+    std::vector<float> features;
+    std::vector<FlightMatch> matches;
+    std::vector<FlightFlow> flows;
+    metas.reserve(header.num_frames);
+    for (size_t k = first; k < count_; ++k) {
+        const FlightFrame& f = frame(k);
+        FrameMeta m;
+        m.frame_index = f.frame_index;
+        m.timestamp_us = f.timestamp_us;
+        m.num_dets = static_cast<uint32_t>(f.detections.size());
+        m.num_low_dets = static_cast<uint32_t>(f.low_detections.size());
+        m.num_features = static_cast<uint32_t>(f.feature_dets.size());
+        m.feature_dim = static_cast<uint32_t>(f.feature_dim);
+        m.num_matches = static_cast<uint32_t>(f.matches.size());
+        m.num_low_matches = static_cast<uint32_t>(f.low_matches.size());
+        m.interframe = f.interframe ? 1 : 0;
+        m.num_flows = static_cast<uint32_t>(f.flows.size());
+        m.dt = f.dt;
+        m.timings = f.timings;
+        metas.push_back(m);
+        rects.insert(rects.end(), f.detections.begin(), f.detections.end());
+        rects.insert(rects.end(), f.low_detections.begin(), f.low_detections.end());
+        feature_dets.insert(feature_dets.end(), f.feature_dets.begin(), f.feature_dets.end());
+        features.insert(features.end(), f.features.begin(), f.features.end());
+        matches.insert(matches.end(), f.matches.begin(), f.matches.end());
+        matches.insert(matches.end(), f.low_matches.begin(), f.low_matches.end());
+        flows.insert(flows.end(), f.flows.begin(), f.flows.end());
+    }
+
+    SnapshotWriter writer;
+    writer.addValue(SnapshotTag("FRHD"), header);
+    writer.add(SnapshotTag("FRCK"), ckpt->data);
+    writer.add(SnapshotTag("FRFM"), metas);
+    writer.add(SnapshotTag("FRDT"), rects);
+    writer.add(SnapshotTag("FRFI"), feature_dets);
+    writer.add(SnapshotTag("FRFV"), features);
+    writer.add(SnapshotTag("FRMA"), matches);
+    writer.add(SnapshotTag("FRFL"), flows);
+    writer.finish(dump_buf_);
+
+    // 先写临时文件再重命名，不会留下半个转储
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+        f.write(dump_buf_.data(), static_cast<std::streamsize>(dump_buf_.size()));
+        if (!f) throw std::runtime_error("Failed to write flight record: " + tmp);
+    }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        throw std::runtime_error("Failed to rename flight record to " + path);
+    }
+    dumps_++;
+    last_dump_path_ = path;
+    return metas.size();
+}
+
+FlightRecord FlightRecorder::load(const std::string& path) {
+    std::ifstream f(path, std::ios::binary | std::ios::ate);
+    if (!f) throw std::runtime_error("Failed to open flight record: " + path);
+    std::vector<char> data(static_cast<size_t>(f.tellg()));
+    f.seekg(0);
+    f.read(data.data(), static_cast<std::streamsize>(data.size()));
+    if (!f) throw std::runtime_error("Failed to read flight record: " + path);
+
+    SnapshotReader reader(data.data(), data.size());
+    const DumpHeader header = reader.readValue<DumpHeader>(SnapshotTag("FRHD"));
+    size_t num_metas = 0, num_rects = 0, num_fi = 0, num_fv = 0, num_matches = 0, num_flows = 0;
+    const FrameMeta* metas = reader.get<FrameMeta>(SnapshotTag("FRFM"), num_metas);
+    const cv::Rect_<float>* rects = reader.get<cv::Rect_<float>>(SnapshotTag("FRDT"), num_rects);
+    const int32_t* fi = reader.get<int32_t>(SnapshotTag("FRFI"), num_fi);
+    const float* fv = reader.get<float>(SnapshotTag("FRFV"), num_fv);
+    const FlightMatch* matches = reader.get<FlightMatch>(SnapshotTag("FRMA"), num_matches);
+    const FlightFlow* flows = reader.get<FlightFlow>(SnapshotTag("FRFL"), num_flows);
+    if (num_metas != static_cast<size_t>(header.num_frames)) {
+        throw std::runtime_error("flight record: frame count mismatch");
+    }
+
+    FlightRecord record;
+    record.with_reid = header.with_reid != 0;
+    record.trigger_frame = header.trigger_frame;
+    record.trigger_ms = header.trigger_ms;
+    reader.read(SnapshotTag("FRCK"), record.checkpoint);
+    record.frames.resize(num_metas);
+
+    size_t r = 0, i = 0, v = 0, m = 0, fl = 0;
+    auto take = [](size_t& pos, size_t n, size_t total) {
+        if (n > total - pos) throw std::runtime_error("flight record: section length mismatch");
+        size_t begin = pos;
+        pos += n;
+        return begin;
+    };
+    for (size_t k = 0; k < num_metas; ++k) {
+        FrameMeta meta;
+        std::memcpy(&meta, metas + k, sizeof(meta));
+        FlightFrame& fr = record.frames[k];
+        fr.frame_index = meta.frame_index;
+        fr.timestamp_us = meta.timestamp_us;
+        fr.dt = meta.dt;
+        fr.interframe = meta.interframe != 0;
+        fr.timings = meta.timings;
+        fr.feature_dim = meta.feature_dim;
+
+        size_t b = take(r, meta.num_dets, num_rects);
+        fr.detections.assign(rects + b, rects + b + meta.num_dets);
+        b = take(r, meta.num_low_dets, num_rects);
+        fr.low_detections.assign(rects + b, rects + b + meta.num_low_dets);
+        b = take(i, meta.num_features, num_fi);
+        fr.feature_dets.assign(fi + b, fi + b + meta.num_features);
+        const size_t nv = static_cast<size_t>(meta.num_features) * meta.feature_dim;
+        b = take(v, nv, num_fv);
+        fr.features.assign(fv + b, fv + b + nv);
+        b = take(m, meta.num_matches, num_matches);
+        fr.matches.assign(matches + b, matches + b + meta.num_matches);
+        b = take(m, meta.num_low_matches, num_matches);
+        fr.low_matches.assign(matches + b, matches + b + meta.num_low_matches);
+        b = take(fl, meta.num_flows, num_flows);
+        fr.flows.assign(flows + b, flows + b + meta.num_flows);
+    }
+    return record;
+}
+
+size_t FlightRecorder::memoryBytes() const {
+    auto bytes = [](const auto& v) { return v.capacity() * sizeof(v[0]); };
+    size_t total = sizeof(*this) + bytes(ring_) + bytes(dump_buf_);
+    for (const FlightFrame& f : ring_) {
+        total += bytes(f.detections) + bytes(f.low_detections) + bytes(f.feature_dets);
+        total += bytes(f.features) + bytes(f.matches) + bytes(f.low_matches) + bytes(f.flows);
+    }
+    for (const Checkpoint& c : checkpoints_) total += bytes(c.data);
+    return total;
+}
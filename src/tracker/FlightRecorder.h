@@ -0,0 +1,151 @@
+#ifndef FLIGHTRECORDER_H
+#define FLIGHTRECORDER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <opencv2/core.hpp>
+
+// ==================== 逐帧分阶段耗时 ====================
+enum class TrackerStage {
+    Record,        // 飞行记录（取槽位、拷贝输入、定期的回放起点快照）；未接记录仪时为 0
+    Predict,       // Kalman 预测
+    Flow,          // 插帧的光流观测（关键帧为 0）
+    Gating,        // 门控准备与候选配对
+    Unambiguous,   // 运动无歧义配对
+    Reid,          // ReID 特征提取
+    Match,         // 级联 + IoU 匹配
+    Update,        // Kalman 更新、低分关联、删除与新建
+    Count
+};
+
+struct StageTimings {
+    float ms[static_cast<int>(TrackerStage::Count)] = {};
+    float total_ms = 0.0f;
+
+    float& operator[](TrackerStage s) { return ms[static_cast<int>(s)]; }
+    float operator[](TrackerStage s) const { return ms[static_cast<int>(s)]; }
+
+    static const char* name(TrackerStage s);
+};
+
+// 一次匹配决策：轨迹 ID 与检测下标（POD，直接写入转储文件）
+struct FlightMatch {
+    int32_t track_id;
+    int32_t det;
+};
+
+// 插帧的一条光流观测：轨迹 ID 与观测框（POD）
+struct FlightFlow {
+    int32_t track_id;
+    cv::Rect_<float> box;
+};
+
+// ==================== 一帧的飞行记录 ====================
+// 回放所需的全部输入（检测、ReID 特征、插帧的光流观测）+ 匹配结果 + 耗时
+struct FlightFrame {
+    int64_t frame_index = 0;                          // 跟踪器帧号
+    int64_t timestamp_us = 0;                         // 记录时刻（steady_clock）
+    std::vector<cv::Rect_<float>> detections;         // 高分检测
+    std::vector<cv::Rect_<float>> low_detections;     // 低分检测（第二阶段）
+    float dt = 1.0f;                                  // Kalman 外推的标称帧数（由帧时间戳得出）
+    bool interframe = false;                          // 插帧（无检测，只有光流观测）
+    std::vector<FlightFlow> flows;                    // 插帧的光流观测（回放时直接使用，不需要图像）
+    std::vector<int32_t> feature_dets;                // 提取了 ReID 特征的检测下标
+    std::vector<float> features;                      // feature_dets.size() x feature_dim，已 L2 归一化
+    size_t feature_dim = 0;
+    std::vector<FlightMatch> matches;                 // 高分检测的匹配（无歧义 + 级联 + IoU）
+    std::vector<FlightMatch> low_matches;             // 低分检测的匹配（ByteTrack 第二阶段）
+    StageTimings timings;
+
+    void clear();
+};
+
+// 从文件读出的一段记录：起点的跟踪器快照 + 其后的逐帧记录
+struct FlightRecord {
+    bool with_reid = false;            // 记录时是否有 ReID（回放时按此选择 DeepSORT / SORT 流程）
+    int64_t trigger_frame = 0;         // 触发转储的帧（按需转储时为最后一帧）
+    float trigger_ms = 0.0f;
+    std::vector<char> checkpoint;      // DeepSortTracker::snapshot() 的输出，回放前 restore
+    std::vector<FlightFrame> frames;
+};
+
+struct FlightRecorderConfig {
+    size_t capacity_frames = 300;      // 环形缓冲帧数（30 fps 下约 10 秒）
+    float spike_threshold_ms = 0.0f;   // 单帧总耗时超过该值时自动转储，0 表示不自动转储
+    std::string dump_prefix = "flight";// 自动转储的文件名前缀：<prefix>_<帧号>.fdr
+    // 回放起点快照是否包含完整特征库。false 时每条轨迹只存最新特征（与 EMA 特征），快照开销不随 nn_budget 增长；
+    // 回放在 SORT 模式与 EMA 度量下仍逐帧一致，Min / Mean 度量下特征库重新积累期间外观距离可能与记录不同。
+    // 需要逐帧复现 Min / Mean 度量的匹配时设为 true
+    bool full_gallery_checkpoints = false;
+};
+
+// ==================== 飞行记录仪 ====================
+// 常开的定长环形缓冲：每帧记录检测、ReID 特征、匹配结果和分阶段耗时，
+// 槽位的容量跨圈复用，稳态下不分配内存；每 capacity_frames / 2 帧保存一次跟踪器快照作为回放起点。
+// 单帧耗时超过阈值（或调用 dump()）时，把最近一个完整覆盖的快照及其后的全部帧写入文件，
+// 用 FlightRecorder::load() 读出后逐帧交给 DeepSortTracker::replay() 即可确定性地重现。
+// 由 DeepSortTracker::setFlightRecorder() 接入；一个记录仪只服务一个跟踪器。
+class FlightRecorder {
+    public:
+        explicit FlightRecorder(const FlightRecorderConfig& config = FlightRecorderConfig());
+
+        // 跟踪器在每帧开始时调用（状态尚未改变）：必要时保存快照，返回第 frame_index 帧的记录槽位。
+        // 帧号不连续（跟踪器 restore() 过）时丢弃此前的记录
+        // - tracker: 任一运动模型的 DeepSortTracker（只调用其 snapshot()）
+        template <class Tracker>
+        FlightFrame& beginFrame(Tracker& tracker, int64_t frame_index, bool with_reid) {
+            if (std::vector<char>* checkpoint = _checkpoint(frame_index, with_reid)) {
+                tracker.snapshot(*checkpoint, config_.full_gallery_checkpoints);
+            }
+            return _begin_frame(frame_index);
+        }
+        // 跟踪器在每帧结束时调用：超过阈值时自动转储（转储后半个窗口内不再重复触发）
+        void endFrame();
+
+        // 按需转储到 path；返回写入的帧数（缓冲为空时为 0，不写文件）
+        size_t dump(const std::string& path);
+
+        // 读取转储文件；格式或版本不符时抛出 std::runtime_error
+        static FlightRecord load(const std::string& path);
+
+        // 清空记录和快照
+        void reset();
+
+        size_t size() const { return count_; }
+        // 缓冲中第 k 旧的帧（0 为最旧）
+        const FlightFrame& frame(size_t k) const { return ring_[(head_ + ring_.size() - count_ + k) % ring_.size()]; }
+        size_t dumps() const { return dumps_; }
+        const std::string& lastDumpPath() const { return last_dump_path_; }
+        // 环形缓冲与快照占用的堆内存字节数
+        size_t memoryBytes() const;
+
+    private:
+        struct Checkpoint {
+            int64_t frame_index = -1;      // 快照之后的第一帧
+            std::vector<char> data;
+        };
+
+        // beginFrame 的两步：检查帧号连续性，本帧需要保存快照时返回其缓冲（否则为 nullptr）；取出记录槽位
+        std::vector<char>* _checkpoint(int64_t frame_index, bool with_reid);
+        FlightFrame& _begin_frame(int64_t frame_index);
+
+        FlightRecorderConfig config_;
+        std::vector<FlightFrame> ring_;
+        size_t head_ = 0;                  // 下一帧写入的槽位
+        size_t count_ = 0;
+        int64_t last_frame_ = -1;          // 最近一帧的帧号（检查连续性）
+        FlightFrame* current_ = nullptr;
+
+        Checkpoint checkpoints_[2];        // 最近两次快照
+        int latest_checkpoint_ = -1;
+        size_t frames_since_checkpoint_ = 0;
+
+        bool with_reid_ = false;
+        size_t cooldown_ = 0;              // 自动转储后的冷却帧数
+        size_t dumps_ = 0;
+        std::string last_dump_path_;
+        std::vector<char> dump_buf_;       // 转储的序列化缓冲
+};
+
+#endif // FLIGHTRECORDER_H
@@ -0,0 +1,116 @@
+#include "FlowRefiner.h"
+#include <opencv2/imgproc.hpp>
+#include <opencv2/video/tracking.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// 原地求中位数（会打乱顺序）
+float median(std::vector<float>& v) {
+    auto mid = v.begin() + v.size() / 2;
+    std::nth_element(v.begin(), mid, v.end());
+    return *mid;
+}
+
+} // namespace
+
+void FlowRefiner::_prepare(const cv::Mat& frame, cv::Mat& gray) {
+    const cv::Mat* src = &frame;
+    if (config_.flow_scale != 1.0f) {
+        cv::resize(frame, scaled_, cv::Size(), config_.flow_scale, config_.flow_scale, cv::INTER_AREA);
+        src = &scaled_;
+    }
+    if (src->channels() == 3) cv::cvtColor(*src, gray, cv::COLOR_BGR2GRAY);
+    else if (src->channels() == 4) cv::cvtColor(*src, gray, cv::COLOR_BGRA2GRAY);
+    else src->copyTo(gray);
+}
+
+void FlowRefiner::setReference(const cv::Mat& frame) {
+    if (frame.empty()) {
+        prev_.release();
+        return;
+    }
+    _prepare(frame, prev_);
+}
+
+void FlowRefiner::track(const cv::Mat& frame, const std::vector<cv::Rect_<float>>& boxes,
+                        std::vector<cv::Rect_<float>>& out, std::vector<bool>& ok) {
+    out = boxes;
+    ok.assign(boxes.size(), false);
+    if (frame.empty()) {
+        prev_.release();
+        return;
+    }
+    _prepare(frame, cur_);
+    if (prev_.empty() || boxes.empty() || prev_.size() != cur_.size()) {
+        std::swap(prev_, cur_);
+        return;
+    }
+
+    // 所有框的网格点合并为一次 LK：框内缩 10%，避开边缘的背景
+    const int g = std::max(config_.flow_grid, 2);
+    const int per_box = g * g;
+    const float s = config_.flow_scale;
+    pts0_.clear();
+    for (const cv::Rect_<float>& b : boxes) {
+        const float x0 = (b.x + 0.1f * b.width) * s, y0 = (b.y + 0.1f * b.height) * s;
+        const float sx = 0.8f * b.width * s / (g - 1), sy = 0.8f * b.height * s / (g - 1);
+        for (int r = 0; r < g; ++r) {
+            for (int c = 0; c < g; ++c) pts0_.emplace_back(x0 + c * sx, y0 + r * sy);
+        }
+    }
+
+    const cv::Size win(15, 15);
+    const int levels = 2;
+    cv::calcOpticalFlowPyrLK(prev_, cur_, pts0_, pts1_, status_, err_, win, levels);
+    cv::calcOpticalFlowPyrLK(cur_, prev_, pts1_, pts_back_, status_back_, err_, win, levels);
+
+    const int min_valid = std::max(3, static_cast<int>(std::ceil(config_.min_valid_ratio * per_box)));
+    const float max_fb2 = config_.max_fb_error * config_.max_fb_error;
+    for (size_t i = 0; i < boxes.size(); ++i) {
+        valid_.clear();
+        for (int k = 0; k < per_box; ++k) {
+            const size_t p = i * per_box + k;
+            if (!status_[p] || !status_back_[p]) continue;
+            const cv::Point2f fb = pts_back_[p] - pts0_[p];
+            if (fb.dot(fb) <= max_fb2) valid_.push_back(static_cast<int>(p));
+        }
+        if (static_cast<int>(valid_.size()) < min_valid) continue;
+
+        // 位移：有效点位移的中位数；尺度：有效点两两距离比的中位数
+        dx_.clear();
+        dy_.clear();
+        ratios_.clear();
+        for (size_t a = 0; a < valid_.size(); ++a) {
+            const int p = valid_[a];
+            dx_.push_back(pts1_[p].x - pts0_[p].x);
+            dy_.push_back(pts1_[p].y - pts0_[p].y);
+            for (size_t b = a + 1; b < valid_.size(); ++b) {
+                const int q = valid_[b];
+                const float d0 = static_cast<float>(cv::norm(pts0_[p] - pts0_[q]));
+                if (d0 < 1.0f) continue;
+                ratios_.push_back(static_cast<float>(cv::norm(pts1_[p] - pts1_[q])) / d0);
+            }
+        }
+        const float dx = median(dx_) / s, dy = median(dy_) / s;
+        const float scale = ratios_.empty() ? 1.0f : median(ratios_);
+        if (!(scale > 0.5f && scale < 2.0f)) continue;
+
+        const cv::Rect_<float>& b = boxes[i];
+        const float cx = b.x + 0.5f * b.width + dx, cy = b.y + 0.5f * b.height + dy;
+        const float w = b.width * scale, h = b.height * scale;
+        out[i] = cv::Rect_<float>(cx - 0.5f * w, cy - 0.5f * h, w, h);
+        ok[i] = true;
+    }
+    std::swap(prev_, cur_);
+}
+
+size_t FlowRefiner::memoryBytes() const {
+    auto bytes = [](const auto& v) { return v.capacity() * sizeof(v[0]); };
+    auto mat = [](const cv::Mat& m) { return m.total() * m.elemSize(); };
+    size_t total = mat(prev_) + mat(cur_) + mat(scaled_);
+    total += bytes(pts0_) + bytes(pts1_) + bytes(pts_back_) + bytes(status_) + bytes(status_back_);
+    total += bytes(err_) + bytes(dx_) + bytes(dy_) + bytes(ratios_) + bytes(valid_);
+    return total;
+}
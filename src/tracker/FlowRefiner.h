@@ -0,0 +1,61 @@
+#ifndef FLOWREFINER_H
+#define FLOWREFINER_H
+
+#include <vector>
+#include <opencv2/core.hpp>
+
+// ==================== 关键帧 / 插帧配置 ====================
+// 检测器每 detect_interval 帧运行一次（关键帧），其余帧（插帧）不做检测和 ReID：
+// 轨迹先按 Kalman 预测，再用缩小灰度图上的稀疏光流测得的框位移作为观测做一次 Kalman 更新。
+// 光流失败或与预测偏差过大的 Confirmed 轨迹占比超过 max_drift_ratio 时，下一帧强制检测
+struct KeyframeConfig {
+    int detect_interval = 1;        // k：每 k 帧检测一次；1 为每帧检测（关闭插帧）
+    float flow_scale = 0.5f;        // 光流在按此比例缩小的灰度图上计算
+    int flow_grid = 4;              // 每个框内均匀采样 flow_grid x flow_grid 个点
+    float max_fb_error = 1.0f;      // 前后向光流误差上限（缩小图像素），超过的点丢弃
+    float min_valid_ratio = 0.5f;   // 有效点比例低于此值视为该框光流失败
+    float drift_threshold = 0.25f;  // 光流框中心与 Kalman 预测中心的距离 / 框高 超过此值计为漂移
+    float max_drift_ratio = 0.3f;   // 漂移或失败的 Confirmed 轨迹占比超过此值时下一帧强制检测
+};
+
+// ==================== 稀疏光流框跟踪 ====================
+// MedianFlow 式的逐框位移估计：每个框内取网格点，所有框的点合并为一次金字塔 LK（前向 + 后向），
+// 前后向误差过大的点丢弃，框的位移取有效点位移的中位数，尺度取点对距离比的中位数。
+// 参考帧为上一次 setReference() / track() 的图像，只保存缩小后的灰度图。
+class FlowRefiner {
+    public:
+        explicit FlowRefiner(const KeyframeConfig& config = KeyframeConfig()) : config_(config) {}
+
+        void setConfig(const KeyframeConfig& config) { config_ = config; }
+
+        // 把 frame 缩小、转灰度后作为参考帧（关键帧处理完后调用）
+        void setReference(const cv::Mat& frame);
+        bool hasReference() const { return !prev_.empty(); }
+        // 丢弃参考帧（跟踪器 restore() 后参考帧已不对应当前轨迹）
+        void reset() { prev_.release(); }
+
+        // 以参考帧上的框 boxes（原图 tlwh）为起点，估计它们在 frame 上的位置：
+        // ok[i] 为 true 时 out[i] 为新框，否则 out[i] 不变；随后 frame 成为新的参考帧
+        void track(const cv::Mat& frame, const std::vector<cv::Rect_<float>>& boxes,
+                   std::vector<cv::Rect_<float>>& out, std::vector<bool>& ok);
+
+        // 参考帧与逐帧缓冲占用的堆内存字节数
+        size_t memoryBytes() const;
+
+    private:
+        // 缩小 + 灰度
+        void _prepare(const cv::Mat& frame, cv::Mat& gray);
+
+        KeyframeConfig config_;
+        cv::Mat prev_, cur_;                        // 参考帧 / 当前帧（缩小灰度图）
+        cv::Mat scaled_;                            // 缩放中间结果
+
+        // 逐帧复用的缓冲
+        std::vector<cv::Point2f> pts0_, pts1_, pts_back_;
+        std::vector<unsigned char> status_, status_back_;
+        std::vector<float> err_;
+        std::vector<float> dx_, dy_, ratios_;
+        std::vector<int> valid_;
+};
+
+#endif // FLOWREFINER_H
@@ -0,0 +1,832 @@
+#include "TrackStore.h"
+#include "utils/utils.h"
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+
+namespace {
+
+template <typename T>
+size_t capacity_bytes(const std::vector<T>& v) {
+    return v.capacity() * sizeof(T);
+}
+
+} // namespace
+
+template <class Model>
+TrackStore<Model>::TrackStore(int n_init, const GalleryConfig& gallery)
+    : n_init_(n_init),
+      gallery_config_(gallery),
+      budget_(gallery.metric == GalleryMetric::EMA ? 1 : std::max(1, gallery.nn_budget)) {}
+
+template <class Model>
+void TrackStore<Model>::reserve(size_t n) {
+    ids_.reserve(n);
+    boxes_.reserve(n);
+    time_since_update_.reserve(n);
+    hits_.reserve(n);
+    ages_.reserve(n);
+    states_.reserve(n);
+    slots_.reserve(n);
+    cov_node_.reserve(n);
+    cov_age_.reserve(n);
+    if (gain_cache_) {
+        cov_lane_.reserve(n);
+        lane_track_.reserve(n);
+    }
+    slot_index_.reserve(n);
+    slot_generation_.reserve(n);
+    free_slots_.reserve(n);
+    gallery_count_.reserve(n);
+    gallery_head_.reserve(n);
+    _reserve_lanes(n);
+}
+
+template <class Model>
+void TrackStore<Model>::clear() {
+    ids_.clear();
+    boxes_.clear();
+    time_since_update_.clear();
+    hits_.clear();
+    ages_.clear();
+    states_.clear();
+    // 所有 slot 回收，代数加一使旧句柄失效
+    for (uint32_t slot : slots_) {
+        slot_index_[slot] = -1;
+        slot_generation_[slot]++;
+        free_slots_.push_back(slot);
+    }
+    slots_.clear();
+    cov_node_.clear();
+    cov_age_.clear();
+    cov_lane_.clear();
+    lane_track_.clear();
+    gallery_.clear();
+    gallery_count_.clear();
+    gallery_head_.clear();
+    ema_.clear();
+}
+
+template <class Model>
+void TrackStore<Model>::_reserve_lanes(size_t n) {
+    if (n <= capacity_) return;
+
+    constexpr size_t kAlign = KalmanBatch<Model>::kLaneAlign;
+    size_t cap = std::max({n, capacity_ * 2, kAlign});
+    cap = (cap + kAlign - 1) / kAlign * kAlign;
+
+    // stride 改变，需要按新 stride 重排已有轨迹
+    std::vector<float> means(kStateDim * cap, 0.0f);
+    std::vector<float> covs(kStateDim * kStateDim * cap, 0.0f);
+    size_t n_old = ids_.size();
+    for (int k = 0; k < kStateDim; ++k) {
+        std::copy_n(means_.begin() + k * capacity_, n_old, means.begin() + k * cap);
+    }
+    for (int e = 0; e < kStateDim * kStateDim; ++e) {
+        std::copy_n(covariances_.begin() + e * capacity_, n_old, covs.begin() + e * cap);
+    }
+    means_.swap(means);
+    covariances_.swap(covs);
+    capacity_ = cap;
+    if (gain_cache_) pool_means_.resize(kStateDim * cap);
+}
+
+template <class Model>
+size_t TrackStore<Model>::add(int id, const cv::Rect_<float>& box, const float* feature, size_t feature_dim) {
+    size_t i = ids_.size();
+    _reserve_lanes(i + 1);
+    if (feature_dim_ == 0 && feature_dim > 0) {
+        feature_dim_ = feature_dim;
+    }
+
+    ids_.push_back(id);
+    boxes_.push_back(box);
+    time_since_update_.push_back(0);
+    hits_.push_back(1);
+    ages_.push_back(1);
+    states_.push_back(TrackState::Tentative);
+
+    // 优先复用空闲 slot
+    uint32_t slot;
+    if (!free_slots_.empty()) {
+        slot = free_slots_.back();
+        free_slots_.pop_back();
+    } else {
+        slot = static_cast<uint32_t>(slot_index_.size());
+        slot_index_.push_back(-1);
+        slot_generation_.push_back(0);
+    }
+    slot_index_[slot] = static_cast<int>(i);
+    slots_.push_back(slot);
+
+    gallery_count_.push_back(0);
+    gallery_head_.push_back(0);
+    _reserve_gallery(i + 1);
+    _write_feature(i, feature, feature_dim);
+
+    // 与原 Track 构造一致：零状态 + 大协方差，再用首个观测更新一次
+    const Measurement z = _measurement(box);
+    cov_node_.push_back(GainCache::kUncached);
+    cov_age_.push_back(0);
+    if (!gain_cache_) {
+        uint32_t idx = static_cast<uint32_t>(i);
+        kalman_.initiate(means_.data(), covariances_.data(), capacity_, i);
+        kalman_.update(means_.data(), covariances_.data(), capacity_, &idx, z.data(), 1);
+        return i;
+    }
+
+    // 在协方差池中完成首次更新；更新后的协方差即缓存的出生节点，随即归还通道
+    cov_lane_.push_back(-1);
+    uint32_t lane = _acquire_lane(i);
+    kalman_.initiate(pool_means_.data(), covariances_.data(), capacity_, lane);
+    kalman_.update(pool_means_.data(), covariances_.data(), capacity_, &lane, z.data(), 1);
+    for (int k = 0; k < kStateDim; ++k) means_[k * capacity_ + i] = pool_means_[k * capacity_ + lane];
+    if (gain_cache_->birthNode() != GainCache::kUncached) {
+        _release_lane(i);
+        cov_node_[i] = gain_cache_->birthNode();
+    }
+    return i;
+}
+
+template <class Model>
+void TrackStore<Model>::predictAll(float dt) {
+    const size_t n = ids_.size();
+    if (gain_cache_) {
+        // 缓存中的轨迹只推进均值和节点上的预测次数，协方差只预测池中的通道。
+        // 缓存只描述 dt = 1 的预测，其余帧全部退出缓存、完整传播
+        if (dt == 1.0f) {
+            for (size_t i = 0; i < n; ++i) cov_age_[i] += cov_node_[i] != GainCache::kUncached;
+        } else {
+            for (size_t i = 0; i < n; ++i) {
+                if (cov_node_[i] != GainCache::kUncached) _uncache_covariance(i);
+            }
+        }
+        kalman_.predictMean(means_.data(), capacity_, n, dt);
+        kalman_.predictCovariance(covariances_.data(), capacity_, lane_track_.size(), dt);
+    } else {
+        kalman_.predict(means_.data(), covariances_.data(), capacity_, n, dt);
+    }
+    for (size_t i = 0; i < n; ++i) {
+        _refresh_box(i);
+        ages_[i]++;
+        time_since_update_[i]++;
+    }
+}
+
+template <class Model>
+void TrackStore<Model>::update(size_t i, const cv::Rect_<float>& box, const float* feature, size_t feature_dim) {
+    const Measurement z = _measurement(box);
+    uint32_t idx = static_cast<uint32_t>(i);
+    _kalman_update(&idx, z.data(), 1);
+
+    boxes_[i] = box;
+    _write_feature(i, feature, feature_dim);
+    hits_[i]++;
+    time_since_update_[i] = 0;
+    if (states_[i] == TrackState::Tentative && hits_[i] >= n_init_) {
+        states_[i] = TrackState::Confirmed;
+    }
+}
+
+template <class Model>
+void TrackStore<Model>::update(const std::vector<std::pair<size_t, size_t>>& matches,
+                        const std::vector<cv::Rect_<float>>& detections,
+                        const std::vector<std::vector<float>>& features) {
+    update_indices_.clear();
+    update_z_.clear();
+    for (const auto& [t_idx, d_idx] : matches) {
+        const Measurement z = _measurement(detections[d_idx]);
+        update_indices_.push_back(static_cast<uint32_t>(t_idx));
+        update_z_.insert(update_z_.end(), z.data(), z.data() + kMeasDim);
+    }
+    _kalman_update(update_indices_.data(), update_z_.data(), update_indices_.size());
+
+    for (const auto& [i, d_idx] : matches) {
+        boxes_[i] = detections[d_idx];
+        _write_feature(i, features[d_idx].data(), features[d_idx].size());
+        hits_[i]++;
+        time_since_update_[i] = 0;
+        if (states_[i] == TrackState::Tentative && hits_[i] >= n_init_) {
+            states_[i] = TrackState::Confirmed;
+        }
+    }
+}
+
+template <class Model>
+void TrackStore<Model>::refine(const std::vector<uint32_t>& indices, const std::vector<cv::Rect_<float>>& boxes) {
+    update_z_.clear();
+    for (const cv::Rect_<float>& box : boxes) {
+        const Measurement z = _measurement(box);
+        update_z_.insert(update_z_.end(), z.data(), z.data() + kMeasDim);
+    }
+    _kalman_update(indices.data(), update_z_.data(), indices.size());
+
+    for (uint32_t i : indices) {
+        _refresh_box(i);
+        time_since_update_[i] = std::max(time_since_update_[i] - 1, 0);
+    }
+}
+
+template <class Model>
+void TrackStore<Model>::_kalman_update(const uint32_t* indices, const float* z, size_t m) {
+    if (!gain_cache_) {
+        kalman_.update(means_.data(), covariances_.data(), capacity_, indices, z, m);
+        return;
+    }
+
+    // 稳态轨迹（稳态节点预测一次后命中）共用同一个增益，批量做均值更新；
+    // 未收敛节点上的命中逐条用各自节点的增益；其余在协方差池中完整更新：
+    // 均值按通道收集到 pool_means_，full_indices_ 记通道号
+    const int32_t steady_node = gain_cache_->steadyNode();
+    const typename GainCache::Transition* steady = gain_cache_->hit(steady_node, 1);
+    steady_indices_.resize(m);
+    steady_z_.resize(kMeasDim * m);
+    full_indices_.resize(m);
+    full_z_.resize(kMeasDim * m);
+    size_t n_steady = 0, n_full = 0;
+    for (size_t j = 0; j < m; ++j) {
+        const uint32_t i = indices[j];
+        const int32_t node = cov_node_[i];
+        if (node == steady_node && cov_age_[i] == 1 && steady != nullptr) {
+            steady_indices_[n_steady] = i;
+            std::copy(z + kMeasDim * j, z + kMeasDim * (j + 1), steady_z_.data() + kMeasDim * n_steady);
+            n_steady++;
+            cov_age_[i] = 0;
+            continue;
+        }
+        if (node != GainCache::kUncached) {
+            if (const typename GainCache::Transition* t = gain_cache_->hit(node, cov_age_[i])) {
+                // x += K (z - H x)：增益来自缓存，协方差不参与计算
+                Measurement y;
+                for (int k = 0; k < kMeasDim; ++k) y[k] = z[kMeasDim * j + k] - means_[k * capacity_ + i];
+                const Mean dx = t->Kt.transpose() * y;
+                for (int k = 0; k < kStateDim; ++k) means_[k * capacity_ + i] += dx[k];
+                cov_node_[i] = t->next;
+                cov_age_[i] = 0;
+                continue;
+            }
+            _uncache_covariance(i);
+        }
+        const uint32_t lane = static_cast<uint32_t>(cov_lane_[i]);
+        for (int k = 0; k < kStateDim; ++k) pool_means_[k * capacity_ + lane] = means_[k * capacity_ + i];
+        full_indices_[n_full] = lane;
+        std::copy(z + kMeasDim * j, z + kMeasDim * (j + 1), full_z_.data() + kMeasDim * n_full);
+        n_full++;
+    }
+    steady_indices_.resize(n_steady);
+    full_indices_.resize(n_full);
+    if (n_steady > 0) {
+        kalman_.updateMean(means_.data(), capacity_, steady_indices_.data(), steady_z_.data(), n_steady,
+                           steady->Kt.data());
+    }
+    if (full_indices_.empty()) return;
+
+    kalman_.update(pool_means_.data(), covariances_.data(), capacity_, full_indices_.data(), full_z_.data(), n_full);
+    // 均值写回轨迹；full_indices_ 改记轨迹下标（归还通道会搬动其他轨迹的通道）
+    for (uint32_t& j : full_indices_) {
+        const uint32_t i = lane_track_[j];
+        for (int k = 0; k < kStateDim; ++k) means_[k * capacity_ + i] = pool_means_[k * capacity_ + j];
+        j = i;
+    }
+    // 已收敛的轨迹进入缓存
+    for (uint32_t i : full_indices_) {
+        if (gain_cache_->isSteady(covariances_.data(), capacity_, cov_lane_[i])) {
+            _release_lane(i);
+            cov_node_[i] = gain_cache_->steadyNode();
+            cov_age_[i] = 0;
+        }
+    }
+}
+
+template <class Model>
+void TrackStore<Model>::_uncache_covariance(size_t i) {
+    const Covariance P = gain_cache_->covariance(cov_node_[i], cov_age_[i]);
+    const uint32_t lane = _acquire_lane(i);
+    for (int r = 0; r < kStateDim; ++r) {
+        for (int c = 0; c < kStateDim; ++c) {
+            covariances_[(r * kStateDim + c) * capacity_ + lane] = P(r, c);
+        }
+    }
+    cov_node_[i] = GainCache::kUncached;
+    cov_age_[i] = 0;
+}
+
+template <class Model>
+uint32_t TrackStore<Model>::_acquire_lane(size_t i) {
+    const uint32_t lane = static_cast<uint32_t>(lane_track_.size());
+    lane_track_.push_back(static_cast<uint32_t>(i));
+    cov_lane_[i] = static_cast<int32_t>(lane);
+    return lane;
+}
+
+template <class Model>
+void TrackStore<Model>::_release_lane(size_t i) {
+    const uint32_t lane = static_cast<uint32_t>(cov_lane_[i]);
+    const uint32_t last = static_cast<uint32_t>(lane_track_.size() - 1);
+    if (lane != last) {
+        for (int e = 0; e < kStateDim * kStateDim; ++e) {
+            covariances_[e * capacity_ + lane] = covariances_[e * capacity_ + last];
+        }
+        const uint32_t moved = lane_track_[last];
+        lane_track_[lane] = moved;
+        cov_lane_[moved] = static_cast<int32_t>(lane);
+    }
+    lane_track_.pop_back();
+    cov_lane_[i] = -1;
+}
+
+template <class Model>
+void TrackStore<Model>::setGainCache(const GainCacheConfig& config) {
+    if (config == gain_cache_config_ && (gain_cache_ != nullptr) == config.enabled) return;
+    if (!config.enabled) {
+        setGainCache(nullptr);
+        gain_cache_config_ = config;
+        return;
+    }
+    setGainCache(std::make_shared<const GainCache>(config));
+}
+
+template <class Model>
+void TrackStore<Model>::setGainCache(std::shared_ptr<const GainCache> cache) {
+    if (cache == gain_cache_) return;
+    const size_t n = ids_.size();
+    if (gain_cache_) {
+        // 换表前先把缓存表示的协方差全部放回池中
+        for (size_t i = 0; i < n; ++i) {
+            if (cov_node_[i] != GainCache::kUncached) _uncache_covariance(i);
+        }
+        if (!cache) {
+            // 关闭：池中此时恰好是全部轨迹，按轨迹顺序重排
+            std::vector<float> covs(kStateDim * kStateDim * capacity_, 0.0f);
+            for (int e = 0; e < kStateDim * kStateDim; ++e) {
+                for (size_t i = 0; i < n; ++i) {
+                    covs[e * capacity_ + i] = covariances_[e * capacity_ + cov_lane_[i]];
+                }
+            }
+            covariances_.swap(covs);
+            cov_lane_.clear();
+            lane_track_.clear();
+        }
+    } else if (cache) {
+        // 开启：每条轨迹先占用与下标相同的通道，收敛后陆续进入缓存
+        cov_lane_.resize(n);
+        lane_track_.resize(n);
+        std::iota(cov_lane_.begin(), cov_lane_.end(), 0);
+        std::iota(lane_track_.begin(), lane_track_.end(), 0u);
+        pool_means_.resize(kStateDim * capacity_);
+    }
+    gain_cache_ = std::move(cache);
+    if (gain_cache_) gain_cache_config_ = gain_cache_->config();
+    gain_cache_config_.enabled = gain_cache_ != nullptr;
+}
+
+template <class Model>
+size_t TrackStore<Model>::cachedCount() const {
+    return static_cast<size_t>(std::count_if(cov_node_.begin(), cov_node_.end(),
+                                             [](int32_t node) { return node != GainCache::kUncached; }));
+}
+
+template <class Model>
+void TrackStore<Model>::compact(const std::vector<bool>& keep) {
+    // 协方差池：先归还删除轨迹的通道，保留轨迹的通道不动，只改写下标
+    if (gain_cache_) {
+        for (size_t i = 0; i < ids_.size(); ++i) {
+            if (!keep[i] && cov_lane_[i] >= 0) _release_lane(i);
+        }
+    }
+    size_t out = 0;
+    for (size_t i = 0; i < ids_.size(); ++i) {
+        if (!keep[i]) {
+            const uint32_t slot = slots_[i];
+            slot_index_[slot] = -1;
+            slot_generation_[slot]++;
+            free_slots_.push_back(slot);
+            continue;
+        }
+        if (out != i) {
+            ids_[out] = ids_[i];
+            slots_[out] = slots_[i];
+            slot_index_[slots_[out]] = static_cast<int>(out);
+            boxes_[out] = boxes_[i];
+            for (int k = 0; k < kStateDim; ++k) {
+                means_[k * capacity_ + out] = means_[k * capacity_ + i];
+            }
+            if (gain_cache_) {
+                cov_lane_[out] = cov_lane_[i];
+                if (cov_lane_[out] >= 0) lane_track_[cov_lane_[out]] = static_cast<uint32_t>(out);
+            } else {
+                for (int e = 0; e < kStateDim * kStateDim; ++e) {
+                    covariances_[e * capacity_ + out] = covariances_[e * capacity_ + i];
+                }
+            }
+            cov_node_[out] = cov_node_[i];
+            cov_age_[out] = cov_age_[i];
+            time_since_update_[out] = time_since_update_[i];
+            hits_[out] = hits_[i];
+            ages_[out] = ages_[i];
+            states_[out] = states_[i];
+            gallery_count_[out] = gallery_count_[i];
+            gallery_head_[out] = gallery_head_[i];
+            const size_t block = budget_ * feature_dim_;
+            std::copy_n(gallery_.begin() + i * block, block, gallery_.begin() + out * block);
+            if (!ema_.empty()) {
+                std::copy_n(ema_.begin() + i * feature_dim_, feature_dim_, ema_.begin() + out * feature_dim_);
+            }
+        }
+        ++out;
+    }
+
+    // resize 只缩小，不会释放容量，下一帧复用
+    ids_.resize(out);
+    boxes_.resize(out);
+    time_since_update_.resize(out);
+    hits_.resize(out);
+    ages_.resize(out);
+    states_.resize(out);
+    slots_.resize(out);
+    cov_node_.resize(out);
+    cov_age_.resize(out);
+    if (gain_cache_) cov_lane_.resize(out);
+    gallery_count_.resize(out);
+    gallery_head_.resize(out);
+    gallery_.resize(out * budget_ * feature_dim_);
+    if (!ema_.empty()) ema_.resize(out * feature_dim_);
+}
+
+template <class Model>
+size_t TrackStore<Model>::memoryBytes() const {
+    return capacity_bytes(ids_) + capacity_bytes(boxes_) + capacity_bytes(means_) +
+           capacity_bytes(covariances_) + capacity_bytes(time_since_update_) + capacity_bytes(hits_) +
+           capacity_bytes(ages_) + capacity_bytes(states_) + capacity_bytes(slots_) +
+           capacity_bytes(slot_index_) + capacity_bytes(slot_generation_) + capacity_bytes(free_slots_) +
+           capacity_bytes(gallery_) + capacity_bytes(gallery_count_) + capacity_bytes(gallery_head_) +
+           capacity_bytes(ema_) + capacity_bytes(gallery_scratch_) +
+           capacity_bytes(update_indices_) + capacity_bytes(update_z_) + kalman_.memoryBytes() +
+           capacity_bytes(cov_node_) + capacity_bytes(cov_age_) + capacity_bytes(full_indices_) +
+           capacity_bytes(full_z_) + capacity_bytes(steady_indices_) + capacity_bytes(steady_z_) +
+           capacity_bytes(cov_lane_) + capacity_bytes(lane_track_) + capacity_bytes(pool_means_);
+}
+
+template <class Model>
+void TrackStore<Model>::saveState(SnapshotWriter& writer, bool full_gallery) {
+    const size_t n = ids_.size();
+    // 整体清零：结构体尾部的填充字节也会原样写入快照
+    std::memset(&saved_state_, 0, sizeof(saved_state_));
+    saved_state_.n_init = n_init_;
+    saved_state_.budget = budget_;
+    saved_state_.feature_dim = feature_dim_;
+    saved_state_.capacity = capacity_;
+    saved_state_.size = n;
+    saved_state_.nn_budget = gallery_config_.nn_budget;
+    saved_state_.metric = static_cast<int32_t>(gallery_config_.metric);
+    saved_state_.ema_alpha = gallery_config_.ema_alpha;
+    saved_state_.full_gallery = full_gallery ? 1 : 0;
+    saved_state_.memory_cap_bytes = gallery_config_.memory_cap_bytes;
+    saved_state_.gain_cache = gain_cache_ ? 1 : 0;
+    saved_state_.gain_cache_max_misses = gain_cache_config_.max_misses;
+    saved_state_.gain_cache_max_transient_misses = gain_cache_config_.max_transient_misses;
+    saved_state_.gain_cache_max_nodes = gain_cache_config_.max_nodes;
+    saved_state_.gain_cache_tolerance = gain_cache_config_.tolerance;
+    std::strncpy(saved_state_.model, Model::kName, sizeof(saved_state_.model) - 1);
+    saved_state_.state_dim = kStateDim;
+
+    writer.addValue(SnapshotTag("TSST"), saved_state_);
+    writer.add(SnapshotTag("TIDS"), ids_);
+    writer.add(SnapshotTag("TBOX"), boxes_);
+    writer.add(SnapshotTag("TMEA"), means_);          // lane-major，stride = capacity_
+    writer.add(SnapshotTag("TCOV"), covariances_);    // 开启缓存时为协方差池，通道见 TKLN
+    writer.add(SnapshotTag("TTSU"), time_since_update_);
+    writer.add(SnapshotTag("THIT"), hits_);
+    writer.add(SnapshotTag("TAGE"), ages_);
+    writer.add(SnapshotTag("TSTA"), states_);
+    writer.add(SnapshotTag("TSLT"), slots_);
+    writer.add(SnapshotTag("TKND"), cov_node_);
+    writer.add(SnapshotTag("TKAG"), cov_age_);
+    writer.add(SnapshotTag("TKLN"), cov_lane_);
+    writer.add(SnapshotTag("TSIX"), slot_index_);
+    writer.add(SnapshotTag("TSGN"), slot_generation_);
+    writer.add(SnapshotTag("TSFR"), free_slots_);
+    writer.add(SnapshotTag("TGCN"), gallery_count_);
+    writer.add(SnapshotTag("TGHD"), gallery_head_);
+    writer.add(SnapshotTag("TEMA"), ema_);
+
+    if (full_gallery) {
+        writer.add(SnapshotTag("TGAL"), gallery_);
+        return;
+    }
+    // 只保存每条轨迹最新的特征（特征库为空的轨迹写零）
+    saved_features_.assign(n * feature_dim_, 0.0f);
+    for (size_t i = 0; i < n; ++i) {
+        const float* f = feature(i);
+        if (f) std::copy_n(f, feature_dim_, saved_features_.begin() + i * feature_dim_);
+    }
+    writer.add(SnapshotTag("TLAT"), saved_features_);
+}
+
+template <class Model>
+void TrackStore<Model>::loadState(const SnapshotReader& reader) {
+    const SavedState st = reader.readValue<SavedState>(SnapshotTag("TSST"));
+    const size_t n = st.size;
+    // 运动模型决定 Kalman 通道的行数与含义，只能恢复到同一模型的 TrackStore
+    if (st.state_dim != kStateDim ||
+        std::strncmp(st.model, Model::kName, sizeof(st.model)) != 0) {
+        throw std::runtime_error("snapshot: motion model mismatch (expected " + std::string(Model::kName) + ")");
+    }
+    if (st.capacity < n || st.capacity % KalmanBatch<Model>::kLaneAlign != 0 || st.budget < 1 ||
+        st.metric < static_cast<int32_t>(GalleryMetric::Min) || st.metric > static_cast<int32_t>(GalleryMetric::EMA)) {
+        throw std::runtime_error("snapshot: inconsistent track store");
+    }
+
+    n_init_ = st.n_init;
+    gallery_config_.nn_budget = st.nn_budget;
+    gallery_config_.metric = static_cast<GalleryMetric>(st.metric);
+    gallery_config_.ema_alpha = st.ema_alpha;
+    gallery_config_.memory_cap_bytes = st.memory_cap_bytes;
+    budget_ = st.budget;
+    feature_dim_ = st.feature_dim;
+    capacity_ = st.capacity;
+    // 增益缓存配置随快照恢复：表由配置确定性地构建，节点编号与保存时一致，
+    // 配置与已接入的表相同时 setGainCache 直接沿用该表。
+    // 旧轨迹即将整体替换，先清空，换表时无需写回其缓存中的协方差
+    GainCacheConfig cache_config;
+    cache_config.enabled = st.gain_cache != 0;
+    cache_config.max_misses = st.gain_cache_max_misses;
+    cache_config.max_transient_misses = st.gain_cache_max_transient_misses;
+    cache_config.max_nodes = st.gain_cache_max_nodes;
+    cache_config.tolerance = st.gain_cache_tolerance;
+    ids_.clear();
+    cov_node_.clear();
+    cov_lane_.clear();
+    lane_track_.clear();
+    setGainCache(cache_config);
+
+    reader.read(SnapshotTag("TIDS"), ids_, n);
+    reader.read(SnapshotTag("TBOX"), boxes_, n);
+    reader.read(SnapshotTag("TMEA"), means_, kStateDim * capacity_);
+    reader.read(SnapshotTag("TCOV"), covariances_, kStateDim * kStateDim * capacity_);
+    reader.read(SnapshotTag("TTSU"), time_since_update_, n);
+    reader.read(SnapshotTag("THIT"), hits_, n);
+    reader.read(SnapshotTag("TAGE"), ages_, n);
+    reader.read(SnapshotTag("TSTA"), states_, n);
+    reader.read(SnapshotTag("TSLT"), slots_, n);
+    reader.read(SnapshotTag("TKND"), cov_node_, n);
+    reader.read(SnapshotTag("TKAG"), cov_age_, n);
+    reader.read(SnapshotTag("TKLN"), cov_lane_, gain_cache_ ? n : 0);
+    reader.read(SnapshotTag("TSIX"), slot_index_);
+    reader.read(SnapshotTag("TSGN"), slot_generation_, slot_index_.size());
+    reader.read(SnapshotTag("TSFR"), free_slots_);
+    reader.read(SnapshotTag("TGCN"), gallery_count_, n);
+    reader.read(SnapshotTag("TGHD"), gallery_head_, n);
+    reader.read(SnapshotTag("TEMA"), ema_);
+    _validate_loaded_state();
+    const int32_t nodes = gain_cache_ ? static_cast<int32_t>(gain_cache_->nodeCount()) : 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (cov_node_[i] < GainCache::kUncached || cov_node_[i] >= nodes || cov_age_[i] < 0) {
+            throw std::runtime_error("snapshot: inconsistent track store");
+        }
+    }
+    if (gain_cache_) {
+        // 协方差池：恰好是不在缓存中的轨迹，通道互不重复、连续占满 [0, 池大小)
+        const size_t pooled = static_cast<size_t>(std::count(cov_node_.begin(), cov_node_.end(),
+                                                             GainCache::kUncached));
+        lane_track_.assign(pooled, 0);
+        std::vector<uint8_t> used(pooled, 0);
+        for (size_t i = 0; i < n; ++i) {
+            const int32_t lane = cov_lane_[i];
+            const bool pooled_track = cov_node_[i] == GainCache::kUncached;
+            if (pooled_track ? (lane < 0 || static_cast<size_t>(lane) >= pooled || used[lane]) : lane != -1) {
+                throw std::runtime_error("snapshot: inconsistent track store");
+            }
+            if (!pooled_track) continue;
+            used[lane] = 1;
+            lane_track_[lane] = static_cast<uint32_t>(i);
+        }
+        pool_means_.resize(kStateDim * capacity_);
+    }
+
+    const size_t block = budget_ * feature_dim_;
+    if (st.full_gallery) {
+        reader.read(SnapshotTag("TGAL"), gallery_, n * block);
+        return;
+    }
+    // 精简快照：最新特征放回槽位 0，特征库从 1 个特征重新积累
+    size_t count = 0;
+    const float* latest = reader.get<float>(SnapshotTag("TLAT"), count);
+    if (count != n * feature_dim_) throw std::runtime_error("snapshot: section length mismatch");
+    gallery_.assign(n * block, 0.0f);
+    for (size_t i = 0; i < n; ++i) {
+        if (gallery_count_[i] == 0) continue;
+        std::copy_n(latest + i * feature_dim_, feature_dim_, gallery_.begin() + i * block);
+        gallery_count_[i] = 1;
+        gallery_head_[i] = 1 % budget_;
+    }
+}
+
+template <class Model>
+void TrackStore<Model>::_validate_loaded_state() const {
+    auto fail = [] { throw std::runtime_error("snapshot: inconsistent track store"); };
+    const size_t n = ids_.size();
+    const size_t num_slots = slot_index_.size();
+
+    // 槽位表：活跃轨迹与其槽位互相指向，其余槽位恰好都在空闲表中（各出现一次）
+    if (n + free_slots_.size() != num_slots) fail();
+    for (size_t i = 0; i < n; ++i) {
+        if (slots_[i] >= num_slots || slot_index_[slots_[i]] != static_cast<int>(i)) fail();
+    }
+    std::vector<uint8_t> seen(num_slots, 0);
+    for (uint32_t slot : free_slots_) {
+        if (slot >= num_slots || slot_index_[slot] != -1 || seen[slot]) fail();
+        seen[slot] = 1;
+    }
+
+    // 特征库环形缓冲
+    for (size_t i = 0; i < n; ++i) {
+        if (gallery_count_[i] < 0 || gallery_count_[i] > budget_ || gallery_head_[i] < 0 ||
+            gallery_head_[i] >= budget_) {
+            fail();
+        }
+    }
+    // EMA 特征每条轨迹一行；非 EMA 模式下可为空
+    const bool need_ema = gallery_config_.metric == GalleryMetric::EMA && feature_dim_ > 0;
+    if ((need_ema || !ema_.empty()) && ema_.size() != n * feature_dim_) fail();
+}
+
+template <class Model>
+typename TrackStore<Model>::Mean TrackStore<Model>::mean(size_t i) const {
+    Mean x;
+    for (int k = 0; k < kStateDim; ++k) x[k] = means_[k * capacity_ + i];
+    return x;
+}
+
+template <class Model>
+typename TrackStore<Model>::Covariance TrackStore<Model>::covariance(size_t i) const {
+    if (cov_node_[i] != GainCache::kUncached) return gain_cache_->covariance(cov_node_[i], cov_age_[i]);
+    const size_t lane = _cov_lane(i);
+    Covariance P;
+    for (int r = 0; r < kStateDim; ++r) {
+        for (int c = 0; c < kStateDim; ++c) {
+            P(r, c) = covariances_[(r * kStateDim + c) * capacity_ + lane];
+        }
+    }
+    return P;
+}
+
+template <class Model>
+void TrackStore<Model>::project(size_t i, Measurement& mean, MeasurementCovariance& S) const {
+    if (cov_node_[i] != GainCache::kUncached) {
+        gain_cache_->project(this->mean(i), cov_node_[i], cov_age_[i], mean, S);
+        return;
+    }
+    Eigen::Matrix<float, kMeasDim, kMeasDim, Eigen::RowMajor> s;
+    kalman_.project(means_.data(), covariances_.data(), capacity_, i, _cov_lane(i), mean.data(), s.data());
+    S = s;
+}
+
+template <class Model>
+void TrackStore<Model>::_refresh_box(size_t i) {
+    Measurement z;
+    for (int k = 0; k < kMeasDim; ++k) z[k] = means_[k * capacity_ + i];
+    const Eigen::Vector4f tlwh = Model::toTlwh(z);
+    boxes_[i] = cv::Rect_<float>(tlwh[0], tlwh[1], tlwh[2], tlwh[3]);
+}
+
+template <class Model>
+void TrackStore<Model>::_write_feature(size_t i, const float* feature, size_t feature_dim) {
+    if (feature_dim_ == 0 || feature == nullptr) return;
+    size_t n = std::min(feature_dim, feature_dim_);
+    if (Eigen::Map<const Eigen::VectorXf>(feature, n).squaredNorm() == 0.0f) return;
+
+    float* dst = gallery_.data() + (i * budget_ + gallery_head_[i]) * feature_dim_;
+    std::copy_n(feature, n, dst);
+    std::fill(dst + n, dst + feature_dim_, 0.0f);
+    bool first = gallery_count_[i] == 0;
+    gallery_head_[i] = (gallery_head_[i] + 1) % budget_;
+    gallery_count_[i] = std::min(gallery_count_[i] + 1, budget_);
+
+    if (gallery_config_.metric == GalleryMetric::EMA) {
+        Eigen::Map<Eigen::VectorXf> ema(ema_.data() + i * feature_dim_, feature_dim_);
+        Eigen::Map<const Eigen::VectorXf> f(dst, feature_dim_);
+        const float alpha = gallery_config_.ema_alpha;
+        if (first) ema = f;
+        else ema = alpha * ema + (1.0f - alpha) * f;
+        L2Normalize(ema.data(), feature_dim_);
+    }
+}
+
+template <class Model>
+void TrackStore<Model>::_reserve_gallery(size_t n) {
+    if (feature_dim_ == 0) return;
+    const size_t row_bytes = feature_dim_ * sizeof(float);
+    const size_t cap = gallery_config_.memory_cap_bytes;
+    // 上限内能容纳 2n 条轨迹的容量（不超过 nn_budget）：超出上限时一次缩到该值，
+    // 避免轨迹数缓慢增长时反复重排；轨迹减少使该值超过当前容量时再放大回去
+    size_t fit = gallery_config_.metric == GalleryMetric::EMA ? 1 : std::max(1, gallery_config_.nn_budget);
+    if (cap > 0 && n > 0) fit = std::min(fit, std::max<size_t>(1, cap / (2 * n * row_bytes)));
+    const bool over_cap = cap > 0 && budget_ > 1 && n * budget_ * row_bytes > cap;
+    if (over_cap || static_cast<int>(fit) > budget_) _rebudget_gallery(static_cast<int>(fit));
+    gallery_.resize(n * budget_ * feature_dim_);
+    if (gallery_config_.metric == GalleryMetric::EMA) ema_.resize(n * feature_dim_);
+}
+
+template <class Model>
+void TrackStore<Model>::_rebudget_gallery(int budget) {
+    std::vector<float> gallery(ids_.size() * budget * feature_dim_);
+    for (size_t i = 0; i < ids_.size(); ++i) {
+        const int count = gallery_count_[i];
+        const int keep = std::min(count, budget);
+        // 环形缓冲未满时最旧的在槽位 0，已满时最旧的在 head
+        const int oldest = (count < budget_) ? 0 : gallery_head_[i];
+        for (int t = 0; t < keep; ++t) {
+            int slot = (oldest + count - keep + t) % budget_;
+            std::copy_n(gallery_.begin() + (i * budget_ + slot) * feature_dim_, feature_dim_,
+                        gallery.begin() + (i * budget + t) * feature_dim_);
+        }
+        gallery_count_[i] = keep;
+        gallery_head_[i] = keep % budget;
+    }
+    gallery_.swap(gallery);
+    budget_ = budget;
+}
+
+template <class Model>
+const float* TrackStore<Model>::feature(size_t i) const {
+    if (feature_dim_ == 0 || gallery_count_[i] == 0) return nullptr;
+    int slot = (gallery_head_[i] + budget_ - 1) % budget_;
+    return gallery_.data() + (i * budget_ + slot) * feature_dim_;
+}
+
+template <class Model>
+bool TrackStore<Model>::representativeFeature(size_t i, float* out) const {
+    const int count = gallery_count_[i];
+    if (feature_dim_ == 0 || count == 0) return false;
+    Eigen::Map<Eigen::VectorXf> o(out, feature_dim_);
+    if (gallery_config_.metric == GalleryMetric::EMA) {
+        o = Eigen::Map<const Eigen::VectorXf>(ema_.data() + i * feature_dim_, feature_dim_);
+        return true;
+    }
+    Eigen::Map<const RowMajorMatrixXf> G(gallery_.data() + i * budget_ * feature_dim_, count, feature_dim_);
+    o = G.colwise().sum().transpose();
+    L2Normalize(out, feature_dim_);
+    return true;
+}
+
+template <class Model>
+float TrackStore<Model>::appearanceDistance(size_t i, const float* det) const {
+    const int count = gallery_count_[i];
+    if (feature_dim_ == 0 || count == 0) return 1.0f;
+    if (gallery_config_.metric == GalleryMetric::EMA) {
+        return NormalizedCosineDistance(ema_.data() + i * feature_dim_, det, feature_dim_);
+    }
+
+    Eigen::Map<const Eigen::VectorXf> d(det, feature_dim_);
+    const float* g = gallery_.data() + i * budget_ * feature_dim_;
+    float best = -1.0f, sum = 0.0f;
+    for (int r = 0; r < count; ++r) {
+        float dot = Eigen::Map<const Eigen::VectorXf>(g + r * feature_dim_, feature_dim_).dot(d);
+        best = std::max(best, dot);
+        sum += dot;
+    }
+    float sim = (gallery_config_.metric == GalleryMetric::Min) ? best : sum / count;
+    return std::max(0.0f, std::min(2.0f, 1.0f - sim));
+}
+
+template <class Model>
+void TrackStore<Model>::appearanceDistanceMatrix(const float* dets, size_t m, RowMajorMatrixXf& out) {
+    const size_t n = ids_.size();
+    out.resize(n, m);
+    if (feature_dim_ == 0 || m == 0) {
+        out.setConstant(1.0f);
+        return;
+    }
+    if (gallery_config_.metric == GalleryMetric::EMA) {
+        CosineDistanceMatrix(ema_.data(), n, dets, m, feature_dim_, out);
+        for (size_t i = 0; i < n; ++i) {
+            if (gallery_count_[i] == 0) out.row(i).setConstant(1.0f);
+        }
+        return;
+    }
+
+    Eigen::Map<const RowMajorMatrixXf> D(dets, m, feature_dim_);
+    gallery_scratch_.resize(budget_ * m);
+    for (size_t i = 0; i < n; ++i) {
+        const int count = gallery_count_[i];
+        if (count == 0) {
+            out.row(i).setConstant(1.0f);
+            continue;
+        }
+        // 该轨迹的特征库（count x dim）与全部检测做一次 GEMM，再按列取最大相似度或平均
+        Eigen::Map<const RowMajorMatrixXf> G(gallery_.data() + i * budget_ * feature_dim_, count, feature_dim_);
+        Eigen::Map<RowMajorMatrixXf> S(gallery_scratch_.data(), count, m);
+        S.noalias() = G * D.transpose();
+        if (gallery_config_.metric == GalleryMetric::Min) {
+            out.row(i) = (1.0f - S.colwise().maxCoeff().array()).max(0.0f).min(2.0f);
+        } else {
+            out.row(i) = (1.0f - S.colwise().mean().array()).max(0.0f).min(2.0f);
+        }
+    }
+}
+
+template class TrackStore<ConstantVelocityXYAH>;
+template class TrackStore<ConstantVelocityXYWH>;
+template class TrackStore<ConstantAccelerationXYAH>;
@@ -0,0 +1,299 @@
+#ifndef TRACKSTORE_H
+#define TRACKSTORE_H
+
+#include <vector>
+#include <cstdint>
+#include <memory>
+#include <opencv2/opencv.hpp>
+
+#include "kalmanfilter/kalman.h"
+#include "kalmanfilter/kalman_batch.h"
+#include "kalmanfilter/kalman_gain_cache.h"
+#include "utils/utils.h"
+#include "utils/snapshot.h"
+
+// ==================== 轨迹状态枚举 ====================
+// 定义轨迹的三种生命周期状态，用于控制轨迹是否输出
+enum class TrackState {
+    Tentative,   // 试探态：刚创建，尚未确认（避免误检输出）
+    Confirmed,   // 已确认：连续命中多次，可信度高，参与输出和匹配
+    Deleted      // 已删除：长时间未匹配，从跟踪列表中移除
+};
+
+// ==================== 稳定轨迹句柄 ====================
+// 轨迹在 TrackStore 中的下标会随 compact() 变化；句柄的 slot 在轨迹整个生命周期内不变，
+// 轨迹删除后 slot 回收到空闲链表，generation 加一，旧句柄随即失效。
+// 下游可以直接用 slot 作为数组下标挂接逐轨迹的附加数据（数组大小取 TrackStore::slotCapacity()），
+// 不必按 id 做哈希查找；用 generation 判断该 slot 是否已换成另一条轨迹。
+struct TrackHandle {
+    static constexpr uint32_t kInvalidSlot = 0xFFFFFFFFu;
+
+    uint32_t slot = kInvalidSlot;
+    uint32_t generation = 0;
+
+    bool valid() const { return slot != kInvalidSlot; }
+    bool operator==(const TrackHandle& o) const { return slot == o.slot && generation == o.generation; }
+    bool operator!=(const TrackHandle& o) const { return !(*this == o); }
+};
+
+// ==================== 外观特征库配置 ====================
+// 每条轨迹保留最近 nn_budget 个（已 L2 归一化的）特征，轨迹到检测的外观距离取特征库上的最小值或平均值，
+// 单帧遮挡、模糊产生的坏特征不会覆盖掉之前的外观（DeepSORT 的 nn_budget）
+enum class GalleryMetric {
+    Min,    // 特征库中与检测最近的距离（DeepSORT 默认）
+    Mean,   // 特征库的平均距离
+    EMA     // 只用特征的指数滑动平均（StrongSORT 风格），特征库只保留最新一帧
+};
+
+struct GalleryConfig {
+    int nn_budget = 100;                              // 每条轨迹的特征库容量（环形缓冲）
+    GalleryMetric metric = GalleryMetric::Min;        // 外观距离的聚合方式
+    float ema_alpha = 0.9f;                           // EMA 模式：ema = alpha * ema + (1 - alpha) * f
+    // 特征库总内存上限，0 表示不限。超出时所有轨迹的容量一起缩小（保留最新的特征），
+    // 轨迹数回落后新建轨迹时再放大，最多回到 nn_budget
+    size_t memory_cap_bytes = 256u * 1024u * 1024u;
+};
+
+// ==================== 轨迹存储（Structure of Arrays） ====================
+// 所有轨迹按字段分别存放在连续数组中（框、Kalman 均值、协方差、计数器、特征），
+// 预测、代价矩阵构建和更新时按字段顺序遍历，避免逐个 Track 追指针。
+// 第 i 条轨迹即各数组的第 i 个元素；compact() 原地压缩，不重新分配。
+// 每条轨迹另有一个稳定的 slot（TrackHandle），删除的 slot 进入空闲链表供新轨迹复用。
+// Kalman 均值与协方差按 KalmanBatch 的 lane-major 布局存放（stride = capacity()），
+// 预测和更新对所有轨迹一次性批量执行。
+// 开启稳态增益缓存（setGainCache）后，协方差已收敛的轨迹改由缓存节点表示，不占协方差通道；
+// 协方差通道成为只存放其余轨迹的稠密池（cov_lane_），预测和完整更新只处理池中的通道。
+// 运动模型在编译期选定（见 motion_models.h）：均值 / 协方差通道的行数为 N / N²（N = Model::kStateDim）。
+template <class Model = ConstantVelocityXYAH>
+class TrackStore {
+    public:
+        static constexpr int kStateDim = Model::kStateDim;
+        static constexpr int kMeasDim = Model::kMeasDim;
+        static_assert(kMeasDim == 4, "观测须为由检测框换算的 4 维向量（Model::fromTlwh）");
+
+        using GainCache = KalmanGainCache<Model>;
+        using Mean = typename KalmanFilter<Model>::Mean;
+        using Covariance = typename KalmanFilter<Model>::Covariance;
+        using Measurement = typename KalmanFilter<Model>::Measurement;
+        using MeasurementCovariance = typename KalmanFilter<Model>::MeasurementCovariance;
+
+        // - n_init: 轨迹确认所需最小命中次数
+        // - gallery: 外观特征库配置
+        explicit TrackStore(int n_init = 3, const GalleryConfig& gallery = GalleryConfig());
+
+        size_t size() const { return ids_.size(); }
+        bool empty() const { return ids_.empty(); }
+        void reserve(size_t n);
+        void clear();
+
+        // 新建轨迹：用首次检测框初始化 Kalman 状态，特征拷入连续特征区
+        // - 返回新轨迹的下标
+        size_t add(int id, const cv::Rect_<float>& box, const float* feature, size_t feature_dim);
+
+        // 对所有轨迹执行 Kalman 预测，并同步更新预测框、age 和 time_since_update
+        // - dt: 距上一帧经过的标称帧数（Kalman 外推用；age 与 time_since_update 仍按调用次数各加一）
+        void predictAll(float dt = 1.0f);
+
+        // 用匹配到的检测更新第 i 条轨迹（Kalman 状态、特征、命中计数、状态）
+        void update(size_t i, const cv::Rect_<float>& box, const float* feature, size_t feature_dim);
+
+        // 批量更新：matches 为 (轨迹下标, 检测下标)，所有匹配轨迹的 Kalman 更新一次完成
+        void update(const std::vector<std::pair<size_t, size_t>>& matches,
+                    const std::vector<cv::Rect_<float>>& detections,
+                    const std::vector<std::vector<float>>& features);
+
+        // 插帧观测（光流等无检测的框）：只做 Kalman 更新并由均值刷新框，不计命中、不写特征；
+        // 本帧视为仍在跟踪，撤销 predictAll() 对 time_since_update 的累加
+        // - indices: 轨迹下标（互不重复），boxes[j] 为 indices[j] 的观测框
+        void refine(const std::vector<uint32_t>& indices, const std::vector<cv::Rect_<float>>& boxes);
+
+        // =============== 稳态增益缓存 ===============
+        // 开启后，协方差收敛到稳态的轨迹预测时只推进均值，命中时用缓存的增益更新均值（见 KalmanGainCache），
+        // dt ≠ 1 的帧退回完整传播；关闭时把缓存表示的协方差写回 Kalman 通道。输出与完整传播相差在 tolerance 量级
+        void setGainCache(const GainCacheConfig& config);
+        // 使用已构建的表（可在多个 TrackStore 之间共享）；nullptr 关闭
+        void setGainCache(std::shared_ptr<const GainCache> cache);
+        const GainCacheConfig& gainCacheConfig() const { return gain_cache_config_; }
+        const std::shared_ptr<const GainCache>& gainCache() const { return gain_cache_; }
+        // 当前协方差由缓存表示的轨迹数
+        size_t cachedCount() const;
+
+        // 未匹配：仅累加 time_since_update
+        void markMissed(size_t i) { time_since_update_[i]++; }
+
+        // 原地压缩：保留 keep[i] == true 的轨迹，保持原有顺序；删除轨迹的 slot 回收到空闲链表
+        void compact(const std::vector<bool>& keep);
+
+        // =============== 稳定句柄 ===============
+        // 第 i 条轨迹的句柄
+        TrackHandle handle(size_t i) const {
+            return TrackHandle{slots_[i], slot_generation_[slots_[i]]};
+        }
+        // 句柄对应的当前下标；轨迹已删除（句柄过期）时返回 -1
+        int indexOf(const TrackHandle& h) const {
+            if (h.slot >= slot_index_.size() || slot_generation_[h.slot] != h.generation) return -1;
+            return slot_index_[h.slot];
+        }
+        // 已分配过的 slot 数（slot 取值范围 [0, slotCapacity())），用于确定附加数据数组的大小
+        size_t slotCapacity() const { return slot_index_.size(); }
+
+        // =============== 字段访问 ===============
+        int id(size_t i) const { return ids_[i]; }
+        const cv::Rect_<float>& box(size_t i) const { return boxes_[i]; }
+        const std::vector<cv::Rect_<float>>& boxes() const { return boxes_; }
+        Mean mean(size_t i) const;                    // 从 lane-major 布局中取出第 i 条轨迹
+        Covariance covariance(size_t i) const;
+
+        // Kalman 估计的中心点速度 (vx, vy)，单位：像素/帧（各模型的观测都以中心点开头，速度紧随观测之后）
+        cv::Point2f velocity(size_t i) const {
+            return cv::Point2f(means_[kMeasDim * capacity_ + i], means_[(kMeasDim + 1) * capacity_ + i]);
+        }
+
+        // 第 i 条轨迹在观测空间的投影（门控用）：mean = H x，S = 投影协方差
+        void project(size_t i, Measurement& mean, MeasurementCovariance& S) const;
+        int timeSinceUpdate(size_t i) const { return time_since_update_[i]; }
+        int hits(size_t i) const { return hits_[i]; }
+        int age(size_t i) const { return ages_[i]; }
+        TrackState state(size_t i) const { return states_[i]; }
+        void setState(size_t i, TrackState s) { states_[i] = s; }
+
+        // 特征：第 i 条轨迹最新的特征（featureDim() 个 float），维度为 0 或特征库为空时返回 nullptr
+        const float* feature(size_t i) const;
+        size_t featureDim() const { return feature_dim_; }
+        // 第 i 条轨迹特征库中的有效特征数；当前每条轨迹的特征库容量（内存上限可能使其小于 nn_budget）
+        int galleryCount(size_t i) const { return gallery_count_[i]; }
+        int galleryBudget() const { return budget_; }
+
+        // 第 i 条轨迹的代表特征（特征库均值，EMA 模式为 EMA 特征），L2 归一化后写入 out（featureDim() 个 float）
+        // 特征库为空时返回 false
+        bool representativeFeature(size_t i, float* out) const;
+
+        // 外观距离（det 为已 L2 归一化的 featureDim() 维检测特征），按 GalleryConfig::metric 聚合
+        // 特征库为空时返回 1
+        float appearanceDistance(size_t i, const float* det) const;
+
+        // 全部轨迹对 m 个检测（m x featureDim() 行优先）的外观距离矩阵，size() x m
+        // 每条轨迹的特征库在内存中连续，逐轨迹一次 GEMM 后按列聚合
+        void appearanceDistanceMatrix(const float* dets, size_t m, RowMajorMatrixXf& out);
+
+        // 轨迹数据（含 Kalman 通道、特征库和临时缓冲）实际占用的堆内存字节数（按容量计），不含可共享的增益缓存表
+        size_t memoryBytes() const;
+
+        // Kalman 通道容量（即 lane-major 布局的 stride）
+        size_t capacity() const { return capacity_; }
+
+        // 快照：把全部轨迹状态（计数器、Kalman 通道、slot 池、特征库）登记到 writer，
+        // 只登记指针，writer.finish() 之前不能修改本对象
+        // - full_gallery = false：每条轨迹只保存最新一个特征（EMA 模式另存 EMA 特征），快照更小
+        void saveState(SnapshotWriter& writer, bool full_gallery = true);
+        // 从快照恢复，替换当前全部轨迹（含 n_init、特征库与增益缓存配置）；
+        // 格式不符或快照来自其他运动模型时抛出 std::runtime_error
+        // 已接入的增益缓存表与快照的配置相同时沿用（保持多路共享），否则按快照配置新建
+        void loadState(const SnapshotReader& reader);
+
+    private:
+        // 把 feature 追加到第 i 条轨迹的特征库（环形覆盖最旧的一条）；维度不一致时截断或补零
+        // 全零特征（推理失败）不入库
+        void _write_feature(size_t i, const float* feature, size_t feature_dim);
+
+        // 特征库扩容到 n 条轨迹；超过内存上限时缩小每条轨迹的容量（保留最新的特征），
+        // 轨迹数回落到一半以下时放大回去（不超过 nn_budget）
+        void _reserve_gallery(size_t n);
+        // 按新容量重排所有轨迹的特征库
+        void _rebudget_gallery(int budget);
+
+        // 确保 Kalman 通道容量 >= n（按 SIMD 宽度取整，重排为新的 stride）
+        void _reserve_lanes(size_t n);
+
+        // 预测/更新后由均值刷新框
+        void _refresh_box(size_t i);
+        // 检测框（tlwh）换算到观测空间
+        static Measurement _measurement(const cv::Rect_<float>& box) {
+            return Model::fromTlwh(box.x, box.y, box.width, box.height);
+        }
+
+        // Kalman 更新 indices[0..m)（z 每条 kMeasDim 个分量）：缓存中有转移的轨迹只更新均值，其余走批量完整更新，
+        // 完整更新后已收敛的轨迹进入缓存
+        void _kalman_update(const uint32_t* indices, const float* z, size_t m);
+        // 第 i 条轨迹退出缓存：在协方差池末尾分配通道，写入缓存表示的协方差
+        void _uncache_covariance(size_t i);
+        // 为第 i 条轨迹在协方差池末尾分配通道 / 释放其通道（池末通道搬入空位，池保持稠密）
+        uint32_t _acquire_lane(size_t i);
+        void _release_lane(size_t i);
+        // 第 i 条轨迹（不在缓存中）的协方差所在通道
+        size_t _cov_lane(size_t i) const { return gain_cache_ ? static_cast<size_t>(cov_lane_[i]) : i; }
+        // loadState 读入后的一致性检查（槽位表与空闲表、特征库下标、EMA 长度），不一致时抛出异常
+        void _validate_loaded_state() const;
+
+        int n_init_;
+        KalmanBatch<Model> kalman_;            // 所有轨迹共享的运动模型（F/H/Q/R），批量执行
+        GainCacheConfig gain_cache_config_;
+        std::shared_ptr<const GainCache> gain_cache_;   // 未开启时为空
+        size_t feature_dim_ = 0;               // 特征维度（由第一条非空特征确定）
+        size_t capacity_ = 0;                  // Kalman 通道容量
+
+        // =============== 按字段连续存放 ===============
+        std::vector<int> ids_;
+        std::vector<cv::Rect_<float>> boxes_;  // 当前框（tlwh）
+        std::vector<float> means_;             // Kalman 均值，N × capacity_
+        std::vector<float> covariances_;       // Kalman 协方差，N² × capacity_（开启缓存时为协方差池）
+        std::vector<int> time_since_update_;
+        std::vector<int> hits_;
+        std::vector<int> ages_;
+        std::vector<TrackState> states_;
+        std::vector<uint32_t> slots_;          // 第 i 条轨迹的 slot
+        std::vector<int32_t> cov_node_;        // 协方差所在的缓存节点（kUncached：协方差在 Kalman 通道中）
+        std::vector<int32_t> cov_age_;         // 距该节点那次更新的预测次数
+        // 协方差池（仅开启缓存时）：轨迹 -> 通道（在缓存中为 -1）、通道 -> 轨迹（大小即池中通道数）
+        std::vector<int32_t> cov_lane_;
+        std::vector<uint32_t> lane_track_;
+        std::vector<float> pool_means_;        // 池内完整更新时按通道收集的均值，N × capacity_
+
+        // slot 池：slot -> 当前下标（空闲为 -1）、代数、空闲链表
+        std::vector<int> slot_index_;
+        std::vector<uint32_t> slot_generation_;
+        std::vector<uint32_t> free_slots_;
+
+        // 外观特征库：第 i 条轨迹的环形缓冲位于 gallery_[i * budget_ * feature_dim_ ...]，
+        // 有效特征总是槽位 [0, gallery_count_[i])，行优先连续，可直接作为 GEMM 的左矩阵
+        GalleryConfig gallery_config_;
+        int budget_;                            // 每条轨迹的特征库容量
+        std::vector<float> gallery_;            // size() x budget_ x feature_dim_
+        std::vector<int> gallery_count_;        // 有效特征数
+        std::vector<int> gallery_head_;         // 下一次写入的槽位
+        std::vector<float> ema_;                // EMA 模式：size() x feature_dim_，已归一化
+        std::vector<float> gallery_scratch_;    // appearanceDistanceMatrix 的逐轨迹 GEMM 结果（budget_ x m）
+
+        // 批量更新的临时缓冲（复用容量）
+        std::vector<uint32_t> update_indices_;
+        std::vector<float> update_z_;
+        std::vector<uint32_t> full_indices_;   // 增益缓存开启时：走完整传播的轨迹
+        std::vector<float> full_z_;
+        std::vector<uint32_t> steady_indices_; // 增益缓存开启时：以稳态增益批量更新均值的轨迹
+        std::vector<float> steady_z_;
+
+        // 快照的标量字段与精简特征缓冲（saveState 登记的数据须存活到 finish()）
+        struct SavedState {
+            int32_t n_init;
+            int32_t budget;
+            uint64_t feature_dim;
+            uint64_t capacity;
+            uint64_t size;
+            int32_t nn_budget;
+            int32_t metric;
+            float ema_alpha;
+            int32_t full_gallery;
+            uint64_t memory_cap_bytes;
+            int32_t gain_cache;
+            int32_t gain_cache_max_misses;
+            int32_t gain_cache_max_transient_misses;
+            int32_t gain_cache_max_nodes;
+            float gain_cache_tolerance;
+            char model[16];                    // Model::kName（以 0 结尾）
+            int32_t state_dim;
+        };
+        SavedState saved_state_;
+        std::vector<float> saved_features_;
+};
+
+#endif // TRACKSTORE_H
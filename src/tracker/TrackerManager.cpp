@@ -0,0 +1,203 @@
+#include "TrackerManager.h"
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+
+namespace {
+
+size_t file_bytes(const std::string& path) {
+    if (path.empty()) return 0;
+    std::ifstream f(path, std::ios::binary | std::ios::ate);
+    return f ? static_cast<size_t>(f.tellg()) : 0;
+}
+
+double elapsed_ms(std::chrono::high_resolution_clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - t0).count();
+}
+
+} // namespace
+
+template <class Model>
+TrackerManager<Model>::TrackerManager(
+    std::shared_ptr<ONNXYoloDetector> detector,
+    std::shared_ptr<MNNInfer> reid_model,
+    const TrackerParams<Model>& params
+)
+    : detector_(std::move(detector)),
+      reid_model_(std::move(reid_model)),
+      params_(params) {
+    if (params_.gain_cache.enabled) gain_cache_ = std::make_shared<const KalmanGainCache<Model>>(params_.gain_cache);
+}
+
+template <class Model>
+TrackerManager<Model>::TrackerManager(
+    const std::string& detector_model_path,
+    const std::vector<std::string>& class_names,
+    const std::string& reid_model_path,
+    const TrackerParams<Model>& params,
+    int reid_sessions,
+    const DetectorConfig& detector_config
+)
+    : TrackerManager<Model>(
+          detector_model_path.empty() ? nullptr
+                                      : std::make_shared<ONNXYoloDetector>(detector_model_path, class_names, 640, 640,
+                                                                           0.5f, 0.4f, detector_config),
+          DeepSortTracker<Model>::loadReidModel(reid_model_path, reid_sessions),
+          params) {
+    detector_model_bytes_ = file_bytes(detector_model_path);
+    reid_model_bytes_ = file_bytes(reid_model_path);
+}
+
+template <class Model>
+int TrackerManager<Model>::addStream() {
+    size_t s = 0;
+    while (s < streams_.size() && streams_[s]) ++s;
+    if (s == streams_.size()) streams_.emplace_back();
+    streams_[s] = std::make_unique<Stream>(reid_model_, params_, gain_cache_);
+    if (reid_gallery_) streams_[s]->tracker.setReidGallery(reid_gallery_, static_cast<int>(s));
+    return static_cast<int>(s);
+}
+
+template <class Model>
+void TrackerManager<Model>::setReidGallery(std::shared_ptr<ReidGallery> gallery) {
+    reid_gallery_ = std::move(gallery);
+    for (size_t s = 0; s < streams_.size(); ++s) {
+        if (streams_[s]) streams_[s]->tracker.setReidGallery(reid_gallery_, static_cast<int>(s));
+    }
+}
+
+template <class Model>
+void TrackerManager<Model>::removeStream(int stream) {
+    _stream(stream);   // 检查编号
+    streams_[stream].reset();
+}
+
+template <class Model>
+size_t TrackerManager<Model>::numStreams() const {
+    size_t n = 0;
+    for (const auto& s : streams_) n += (s != nullptr);
+    return n;
+}
+
+template <class Model>
+void TrackerManager<Model>::process(int stream, cv::Mat& frame, std::vector<TrackOutput>& outputs, double timestamp) {
+    if (!detector_) {
+        throw std::runtime_error("TrackerManager: no detector loaded, use track()");
+    }
+    Stream& s = _stream(stream);
+
+    if (!s.tracker.needsDetection()) {
+        auto t0 = std::chrono::high_resolution_clock::now();
+        s.tracker.propagate(frame, outputs, timestamp);
+        s.stats.track_ms += elapsed_ms(t0);
+        s.stats.frames++;
+        s.stats.interframes++;
+        return;
+    }
+
+    auto t0 = std::chrono::high_resolution_clock::now();
+    s.detections.clear();
+    detector_->detect(frame, s.detections);
+    s.stats.detect_ms += elapsed_ms(t0);
+
+    track(stream, frame, s.detections, outputs, timestamp);
+}
+
+template <class Model>
+void TrackerManager<Model>::track(int stream, const cv::Mat& frame, const std::vector<detect_result>& detections,
+                           std::vector<TrackOutput>& outputs, double timestamp) {
+    Stream& s = _stream(stream);
+
+    auto t0 = std::chrono::high_resolution_clock::now();
+    s.tracker.update(frame, detections, outputs, timestamp);
+    s.stats.track_ms += elapsed_ms(t0);
+    s.stats.frames++;
+    s.stats.detections += detections.size();
+}
+
+template <class Model>
+DeepSortTracker<Model>& TrackerManager<Model>::tracker(int stream) {
+    return _stream(stream).tracker;
+}
+
+template <class Model>
+StreamStats TrackerManager<Model>::stats(int stream) const {
+    const Stream& s = _stream(stream);
+    StreamStats st = s.stats;
+    st.memory_bytes = s.tracker.memoryBytes() + s.detections.capacity() * sizeof(detect_result);
+    return st;
+}
+
+template <class Model>
+StreamStats TrackerManager<Model>::aggregate() const {
+    StreamStats total;
+    for (size_t i = 0; i < streams_.size(); ++i) {
+        if (!streams_[i]) continue;
+        StreamStats st = stats(static_cast<int>(i));
+        total.frames += st.frames;
+        total.interframes += st.interframes;
+        total.detections += st.detections;
+        total.detect_ms += st.detect_ms;
+        total.track_ms += st.track_ms;
+        total.memory_bytes += st.memory_bytes;
+    }
+    return total;
+}
+
+template <class Model>
+void TrackerManager<Model>::printReport(std::ostream& os) const {
+    os << "=== TrackerManager: " << numStreams() << " 路，"
+       << (reid_model_ ? "DeepSORT" : "SORT") << " ===\n";
+    if (sharedModelBytes() > 0) {
+        os << "共享模型: 检测 " << detector_model_bytes_ / 1024 << " KB，ReID "
+           << reid_model_bytes_ / 1024 << " KB（所有路只加载一份）\n";
+    }
+    os << std::setw(6) << "路"
+       << std::setw(10) << "帧数"
+       << std::setw(10) << "插帧"
+       << std::setw(12) << "检测数"
+       << std::setw(14) << "检测 ms/帧"
+       << std::setw(14) << "跟踪 ms/帧"
+       << std::setw(12) << "FPS"
+       << std::setw(14) << "内存 KB" << "\n";
+
+    auto row = [&os](const std::string& name, const StreamStats& st) {
+        double frames = std::max<size_t>(st.frames, 1);
+        os << std::setw(6) << name
+           << std::setw(10) << st.frames
+           << std::setw(10) << st.interframes
+           << std::setw(12) << st.detections
+           << std::fixed << std::setprecision(3)
+           << std::setw(14) << st.detect_ms / frames
+           << std::setw(14) << st.track_ms / frames
+           << std::setprecision(1)
+           << std::setw(12) << st.fps()
+           << std::setw(14) << st.memory_bytes / 1024.0 << "\n"
+           << std::defaultfloat;
+    };
+    for (size_t i = 0; i < streams_.size(); ++i) {
+        if (streams_[i]) row(std::to_string(i), stats(static_cast<int>(i)));
+    }
+    row("合计", aggregate());
+}
+
+template <class Model>
+typename TrackerManager<Model>::Stream& TrackerManager<Model>::_stream(int stream) {
+    if (stream < 0 || static_cast<size_t>(stream) >= streams_.size() || !streams_[stream]) {
+        throw std::out_of_range("TrackerManager: invalid stream " + std::to_string(stream));
+    }
+    return *streams_[stream];
+}
+
+template <class Model>
+const typename TrackerManager<Model>::Stream& TrackerManager<Model>::_stream(int stream) const {
+    if (stream < 0 || static_cast<size_t>(stream) >= streams_.size() || !streams_[stream]) {
+        throw std::out_of_range("TrackerManager: invalid stream " + std::to_string(stream));
+    }
+    return *streams_[stream];
+}
+
+template class TrackerManager<ConstantVelocityXYAH>;
+template class TrackerManager<ConstantVelocityXYWH>;
+template class TrackerManager<ConstantAccelerationXYAH>;
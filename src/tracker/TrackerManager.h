@@ -0,0 +1,145 @@
+#ifndef TRACKERMANAGER_H
+#define TRACKERMANAGER_H
+
+#include <vector>
+#include <memory>
+#include <string>
+#include <ostream>
+
+#include "tracker/DeepSortTracker.h"
+#include "yolo/onnx_yolo_detecter.h"
+#include "InferMNN/mnnInfer.h"
+
+// ==================== 每路跟踪器参数 ====================
+// 与 DeepSortTracker 构造函数的参数及默认值一一对应
+// - Model: 各路跟踪器的 Kalman 运动模型（见 motion_models.h），按部署场景在编译期选定
+template <class Model = ConstantVelocityXYAH>
+struct TrackerParams {
+    using MotionModel = Model;
+
+    float max_iou_distance = 0.7f;
+    int max_age = 30;
+    int n_init = 3;
+    float max_cosine_distance = 0.2f;
+    AssignmentMode assignment_mode = AssignmentMode::LAPJV;
+    GalleryConfig gallery;
+    bool lazy_reid = true;
+    float high_score_threshold = 0.5f;
+    double frame_interval = 1.0 / 30.0;   // 标称帧间隔（秒），见 DeepSortTracker::setFrameInterval
+    KeyframeConfig keyframe;              // 检测间隔与插帧光流，见 DeepSortTracker::setKeyframeConfig
+    GainCacheConfig gain_cache;           // 稳态增益缓存，见 DeepSortTracker::setGainCache（各路共享一张表）
+};
+
+// ==================== 每路统计 ====================
+struct StreamStats {
+    size_t frames = 0;          // 已处理帧数
+    size_t interframes = 0;     // 其中跳过检测的插帧数（process() 按 needsDetection() 决定）
+    size_t detections = 0;      // 累计检测数
+    double detect_ms = 0.0;     // 累计检测耗时（track() 接口不计）
+    double track_ms = 0.0;      // 累计跟踪耗时（含 ReID）
+    size_t memory_bytes = 0;    // 跟踪状态当前占用的堆内存（不含共享模型）
+
+    // 吞吐：每秒处理帧数（检测 + 跟踪）
+    double fps() const {
+        double ms = detect_ms + track_ms;
+        return ms > 0.0 ? frames * 1000.0 / ms : 0.0;
+    }
+};
+
+// ==================== 多路跟踪管理器 ====================
+// 每路视频（stream）拥有独立的 DeepSortTracker（轨迹、ID、特征库互不影响），
+// 所有路共享同一个检测器和同一个 ReID 模型：权重只加载一份，
+// 每增加一路只增加该路的跟踪状态。
+// 线程：不同路的 track() 可在不同线程同时调用（ReID 模型按会话池并发推理）；
+// process() 共享检测器，需依次调用；addStream()/removeStream() 不可与其他调用并发。
+// 运动模型由模板参数选定（与 TrackerParams<Model> 一致），所有路相同。
+template <class Model = ConstantVelocityXYAH>
+class TrackerManager {
+    public:
+        // 注入已加载的模型
+        // - detector: 共享检测器；为空时只能使用 track()（检测结果由调用方提供）
+        // - reid_model: 共享 ReID 模型；为空时各路为 SORT 模式
+        // - params: 每路跟踪器的参数
+        TrackerManager(
+            std::shared_ptr<ONNXYoloDetector> detector,
+            std::shared_ptr<MNNInfer> reid_model,
+            const TrackerParams<Model>& params = TrackerParams<Model>()
+        );
+
+        // 按路径加载模型（路径为空则不加载对应模型），并记录模型文件大小用于报告
+        // - reid_sessions: ReID 会话池大小，即同时调用 track() 的线程数
+        // - detector_config: 检测器会话选项（线程、优化模型缓存），见 DetectorConfig
+        TrackerManager(
+            const std::string& detector_model_path,
+            const std::vector<std::string>& class_names,
+            const std::string& reid_model_path,
+            const TrackerParams<Model>& params = TrackerParams<Model>(),
+            int reid_sessions = 1,
+            const DetectorConfig& detector_config = DetectorConfig()
+        );
+
+        // 新增一路，返回 stream 编号（优先复用已移除的编号）
+        int addStream();
+        // 移除一路，释放其跟踪状态
+        void removeStream(int stream);
+        // 当前路数
+        size_t numStreams() const;
+
+        // 检测 + 跟踪：用共享检测器检测 frame，再交给该路跟踪器；
+        // 该路开启了插帧（keyframe.detect_interval > 1）且本帧不需要检测时，跳过检测，只做光流插帧
+        // - timestamp: 该路的帧时间戳（秒），各路帧率可以不同，见 DeepSortTracker::update
+        void process(int stream, cv::Mat& frame, std::vector<TrackOutput>& outputs,
+                     double timestamp = DeepSortTracker<Model>::kNoTimestamp);
+
+        // 只跟踪：检测结果由调用方提供（例如检测在别处批量完成）
+        void track(int stream, const cv::Mat& frame, const std::vector<detect_result>& detections,
+                   std::vector<TrackOutput>& outputs, double timestamp = DeepSortTracker<Model>::kNoTimestamp);
+
+        // 接入跨摄像头特征库：所有路（含之后新增的路）共用，camera_id 为 stream 编号
+        void setReidGallery(std::shared_ptr<ReidGallery> gallery);
+        const std::shared_ptr<ReidGallery>& reidGallery() const { return reid_gallery_; }
+
+        // 该路的跟踪器（查询 ReID 统计等）
+        DeepSortTracker<Model>& tracker(int stream);
+
+        // 该路统计 / 所有路合计（memory_bytes 为当前值）
+        StreamStats stats(int stream) const;
+        StreamStats aggregate() const;
+
+        // 共享模型文件大小（按路径构造时记录，否则为 0）
+        size_t sharedModelBytes() const { return detector_model_bytes_ + reid_model_bytes_; }
+
+        // 打印每路与合计的吞吐、内存
+        void printReport(std::ostream& os) const;
+
+    private:
+        struct Stream {
+            DeepSortTracker<Model> tracker;
+            StreamStats stats;
+            std::vector<detect_result> detections;   // process() 的检测缓冲（逐帧复用）
+
+            Stream(std::shared_ptr<MNNInfer> reid_model, const TrackerParams<Model>& p,
+                   std::shared_ptr<const KalmanGainCache<Model>> gain_cache)
+                : tracker(std::move(reid_model), p.max_iou_distance, p.max_age, p.n_init,
+                          p.max_cosine_distance, p.assignment_mode, p.gallery, p.lazy_reid,
+                          p.high_score_threshold) {
+                tracker.setFrameInterval(p.frame_interval);
+                tracker.setKeyframeConfig(p.keyframe);
+                tracker.setGainCache(std::move(gain_cache));
+            }
+        };
+
+        Stream& _stream(int stream);
+        const Stream& _stream(int stream) const;
+
+        std::shared_ptr<ONNXYoloDetector> detector_;
+        std::shared_ptr<MNNInfer> reid_model_;
+        std::shared_ptr<ReidGallery> reid_gallery_;
+        std::shared_ptr<const KalmanGainCache<Model>> gain_cache_;   // params_.gain_cache 未开启时为空
+        TrackerParams<Model> params_;
+        std::vector<std::unique_ptr<Stream>> streams_;   // 已移除的路为空指针
+        size_t detector_model_bytes_ = 0;
+        size_t reid_model_bytes_ = 0;
+};
+
+#endif // TRACKERMANAGER_H
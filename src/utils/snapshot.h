@@ -0,0 +1,159 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <type_traits>
+
+// ==================== 二进制快照 ====================
+// 布局：[SnapshotHeader][SnapshotSection × section_count][节数据 ...]
+// 每节是一段定长元素的连续数组（POD），起始偏移按 64 字节对齐，
+// 读取时直接返回指向缓冲区（或 mmap 的文件）内部的指针，不做逐字段解析。
+// 版本：格式不兼容时增加 kSnapshotVersion，读取端拒绝版本不同的快照。
+
+constexpr uint32_t kSnapshotVersion = 7;
+
+// 四字符节标签，例如 SnapshotTag("TIDS")
+constexpr uint32_t SnapshotTag(const char (&s)[5]) {
+    return static_cast<uint32_t>(s[0]) | (static_cast<uint32_t>(s[1]) << 8) |
+           (static_cast<uint32_t>(s[2]) << 16) | (static_cast<uint32_t>(s[3]) << 24);
+}
+
+struct SnapshotHeader {
+    char magic[8];               // "DSSNAP\0\0"
+    uint32_t version;
+    uint32_t section_count;
+    uint64_t total_bytes;
+};
+
+struct SnapshotSection {
+    uint32_t tag;
+    uint32_t elem_size;
+    uint64_t offset;             // 相对快照起始
+    uint64_t count;              // 元素个数
+};
+
+// 写入端：先登记各节（只记录指针，不拷贝），finish() 时一次性排布并拷贝到 out。
+// 登记的数据在 finish() 之前必须保持有效；out 的容量跨次复用，稳态下不重新分配。
+class SnapshotWriter {
+    public:
+        void clear() { pending_.clear(); }
+
+        template <typename T>
+        void add(uint32_t tag, const T* data, size_t count) {
+            static_assert(std::is_trivially_copyable<T>::value, "snapshot sections must be POD");
+            pending_.push_back({tag, static_cast<uint32_t>(sizeof(T)), data, count});
+        }
+
+        template <typename T>
+        void add(uint32_t tag, const std::vector<T>& v) { add(tag, v.data(), v.size()); }
+
+        template <typename T>
+        void addValue(uint32_t tag, const T& value) { add(tag, &value, 1); }
+
+        void finish(std::vector<char>& out) const {
+            size_t offset = _align(sizeof(SnapshotHeader) + pending_.size() * sizeof(SnapshotSection));
+            std::vector<SnapshotSection> sections(pending_.size());
+            for (size_t s = 0; s < pending_.size(); ++s) {
+                sections[s] = {pending_[s].tag, pending_[s].elem_size, offset, pending_[s].count};
+                offset = _align(offset + pending_[s].elem_size * pending_[s].count);
+            }
+
+            out.resize(offset);
+            SnapshotHeader header;
+            std::memset(&header, 0, sizeof(header));
+            std::memcpy(header.magic, "DSSNAP", 6);
+            header.version = kSnapshotVersion;
+            header.section_count = static_cast<uint32_t>(sections.size());
+            header.total_bytes = offset;
+            std::memcpy(out.data(), &header, sizeof(header));
+            if (!sections.empty()) {
+                std::memcpy(out.data() + sizeof(header), sections.data(), sections.size() * sizeof(SnapshotSection));
+            }
+            for (size_t s = 0; s < pending_.size(); ++s) {
+                const size_t bytes = pending_[s].elem_size * pending_[s].count;
+                if (bytes > 0) std::memcpy(out.data() + sections[s].offset, pending_[s].data, bytes);
+            }
+        }
+
+    private:
+        struct Pending {
+            uint32_t tag;
+            uint32_t elem_size;
+            const void* data;
+            size_t count;
+        };
+
+        static size_t _align(size_t n) { return (n + 63) / 64 * 64; }
+
+        std::vector<Pending> pending_;
+};
+
+// 读取端：校验文件头和节表边界，按标签取出指向快照内部的指针；格式错误时抛出 std::runtime_error
+class SnapshotReader {
+    public:
+        SnapshotReader(const void* data, size_t size) : data_(static_cast<const char*>(data)), size_(size) {
+            if (size_ < sizeof(SnapshotHeader)) throw std::runtime_error("snapshot: truncated header");
+            std::memcpy(&header_, data_, sizeof(header_));
+            if (std::memcmp(header_.magic, "DSSNAP", 6) != 0) throw std::runtime_error("snapshot: bad magic");
+            if (header_.version != kSnapshotVersion) {
+                throw std::runtime_error("snapshot: version " + std::to_string(header_.version) +
+                                         ", expected " + std::to_string(kSnapshotVersion));
+            }
+            if (header_.total_bytes > size_ ||
+                sizeof(SnapshotHeader) + header_.section_count * sizeof(SnapshotSection) > size_) {
+                throw std::runtime_error("snapshot: truncated");
+            }
+            sections_ = reinterpret_cast<const SnapshotSection*>(data_ + sizeof(SnapshotHeader));
+            for (uint32_t s = 0; s < header_.section_count; ++s) {
+                const SnapshotSection& sec = sections_[s];
+                if (sec.offset > size_ || sec.count > (size_ - sec.offset) / std::max<uint32_t>(sec.elem_size, 1)) {
+                    throw std::runtime_error("snapshot: section out of bounds");
+                }
+            }
+        }
+
+        // 取出标签为 tag 的节；元素大小不符或缺失时抛异常
+        template <typename T>
+        const T* get(uint32_t tag, size_t& count) const {
+            for (uint32_t s = 0; s < header_.section_count; ++s) {
+                const SnapshotSection& sec = sections_[s];
+                if (sec.tag != tag) continue;
+                if (sec.elem_size != sizeof(T)) throw std::runtime_error("snapshot: element size mismatch");
+                count = sec.count;
+                return reinterpret_cast<const T*>(data_ + sec.offset);
+            }
+            throw std::runtime_error("snapshot: missing section");
+        }
+
+        // 取出节并拷贝到 out（长度不为 expected 时抛异常；expected 为 SIZE_MAX 时不检查）
+        template <typename T>
+        void read(uint32_t tag, std::vector<T>& out, size_t expected = SIZE_MAX) const {
+            size_t count = 0;
+            const T* p = get<T>(tag, count);
+            if (expected != SIZE_MAX && count != expected) throw std::runtime_error("snapshot: section length mismatch");
+            out.assign(p, p + count);
+        }
+
+        template <typename T>
+        T readValue(uint32_t tag) const {
+            size_t count = 0;
+            const T* p = get<T>(tag, count);
+            if (count != 1) throw std::runtime_error("snapshot: section length mismatch");
+            T value;
+            std::memcpy(&value, p, sizeof(T));
+            return value;
+        }
+
+    private:
+        const char* data_;
+        size_t size_;
+        SnapshotHeader header_;
+        const SnapshotSection* sections_ = nullptr;
+};
+
+#endif // SNAPSHOT_H
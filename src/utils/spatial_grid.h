@@ -0,0 +1,134 @@
+#ifndef SPATIAL_GRID_H
+#define SPATIAL_GRID_H
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <opencv2/core.hpp>
+
+// ==================== 均匀网格空间索引 ====================
+// 每帧用轨迹的搜索区域（预测框 ∪ 门控椭圆的外接框）重建一次，
+// 再用检测框查询与之相交的轨迹，代替 轨迹数 × 检测数 的全量遍历。
+// 存储为 CSR 形式（cell_start_ + items_），重建时只 assign/resize，不会重复申请内存。
+class SpatialGrid {
+    public:
+        // 用若干矩形建立网格；cell_size <= 0 时取矩形平均边长的 2 倍
+        void build(const std::vector<cv::Rect_<float>>& rects, float cell_size = 0.0f) {
+            rects_.assign(rects.begin(), rects.end());
+            stamp_.assign(rects_.size(), 0);
+            query_id_ = 0;
+            if (rects_.empty()) {
+                nx_ = ny_ = 0;
+                cell_start_.assign(1, 0);
+                items_.clear();
+                return;
+            }
+
+            float x0 = rects_[0].x, y0 = rects_[0].y;
+            float x1 = rects_[0].x + rects_[0].width, y1 = rects_[0].y + rects_[0].height;
+            float mean_side = 0.0f;
+            for (const auto& r : rects_) {
+                x0 = std::min(x0, r.x);
+                y0 = std::min(y0, r.y);
+                x1 = std::max(x1, r.x + r.width);
+                y1 = std::max(y1, r.y + r.height);
+                mean_side += std::max(r.width, r.height);
+            }
+            mean_side /= static_cast<float>(rects_.size());
+            if (cell_size <= 0) cell_size = 2.0f * mean_side;
+            cell_size = std::max(cell_size, 1.0f);
+
+            // 格子数不超过矩形数的 4 倍，避免区域很大而矩形很少时网格过稀
+            const float area = std::max(x1 - x0, 1.0f) * std::max(y1 - y0, 1.0f);
+            const float max_cells = 4.0f * static_cast<float>(rects_.size()) + 16.0f;
+            if (area / (cell_size * cell_size) > max_cells) {
+                cell_size = std::sqrt(area / max_cells);
+            }
+
+            x0_ = x0;
+            y0_ = y0;
+            inv_cell_ = 1.0f / cell_size;
+            nx_ = std::max(1, static_cast<int>(std::ceil((x1 - x0) * inv_cell_)));
+            ny_ = std::max(1, static_cast<int>(std::ceil((y1 - y0) * inv_cell_)));
+
+            // 计数 -> 前缀和 -> 填充
+            cell_start_.assign(static_cast<size_t>(nx_) * ny_ + 1, 0);
+            for (const auto& r : rects_) {
+                int cx0, cy0, cx1, cy1;
+                _cell_range(r, cx0, cy0, cx1, cy1);
+                for (int cy = cy0; cy <= cy1; ++cy) {
+                    for (int cx = cx0; cx <= cx1; ++cx) cell_start_[cy * nx_ + cx + 1]++;
+                }
+            }
+            for (size_t c = 1; c < cell_start_.size(); ++c) cell_start_[c] += cell_start_[c - 1];
+
+            items_.resize(cell_start_.back());
+            fill_.assign(cell_start_.begin(), cell_start_.end() - 1);
+            for (size_t i = 0; i < rects_.size(); ++i) {
+                int cx0, cy0, cx1, cy1;
+                _cell_range(rects_[i], cx0, cy0, cx1, cy1);
+                for (int cy = cy0; cy <= cy1; ++cy) {
+                    for (int cx = cx0; cx <= cx1; ++cx) items_[fill_[cy * nx_ + cx]++] = static_cast<int>(i);
+                }
+            }
+        }
+
+        // 查询与 query 相交（含边界接触）的矩形下标，去重后追加到 out，按下标升序
+        void query(const cv::Rect_<float>& query, std::vector<int>& out) {
+            if (nx_ == 0) return;
+            const size_t first = out.size();
+            ++query_id_;
+            int cx0, cy0, cx1, cy1;
+            if (!_cell_range(query, cx0, cy0, cx1, cy1)) return;
+            for (int cy = cy0; cy <= cy1; ++cy) {
+                for (int cx = cx0; cx <= cx1; ++cx) {
+                    const int c = cy * nx_ + cx;
+                    for (int k = cell_start_[c]; k < cell_start_[c + 1]; ++k) {
+                        const int i = items_[k];
+                        if (stamp_[i] == query_id_) continue;
+                        stamp_[i] = query_id_;
+                        const auto& r = rects_[i];
+                        if (r.x <= query.x + query.width && query.x <= r.x + r.width &&
+                            r.y <= query.y + query.height && query.y <= r.y + r.height) {
+                            out.push_back(i);
+                        }
+                    }
+                }
+            }
+            std::sort(out.begin() + first, out.end());
+        }
+
+        size_t size() const { return rects_.size(); }
+
+        // 网格占用的堆内存字节数（按容量计）
+        size_t memoryBytes() const {
+            return rects_.capacity() * sizeof(cv::Rect_<float>) +
+                   (cell_start_.capacity() + items_.capacity() + fill_.capacity() + stamp_.capacity()) * sizeof(int);
+        }
+
+    private:
+        // 矩形覆盖的格子范围（闭区间，已裁剪到网格内）；完全落在网格外时返回 false
+        bool _cell_range(const cv::Rect_<float>& r, int& cx0, int& cy0, int& cx1, int& cy1) const {
+            cx0 = static_cast<int>(std::floor((r.x - x0_) * inv_cell_));
+            cy0 = static_cast<int>(std::floor((r.y - y0_) * inv_cell_));
+            cx1 = static_cast<int>(std::floor((r.x + r.width - x0_) * inv_cell_));
+            cy1 = static_cast<int>(std::floor((r.y + r.height - y0_) * inv_cell_));
+            if (cx1 < 0 || cy1 < 0 || cx0 >= nx_ || cy0 >= ny_) return false;
+            cx0 = std::max(cx0, 0);
+            cy0 = std::max(cy0, 0);
+            cx1 = std::min(cx1, nx_ - 1);
+            cy1 = std::min(cy1, ny_ - 1);
+            return true;
+        }
+
+        std::vector<cv::Rect_<float>> rects_;
+        std::vector<int> cell_start_;   // 第 c 个格子的元素位于 items_[cell_start_[c], cell_start_[c + 1])
+        std::vector<int> items_;
+        std::vector<int> fill_;         // 构建时的写指针
+        std::vector<int> stamp_;        // 查询去重
+        int query_id_ = 0;
+        float x0_ = 0.0f, y0_ = 0.0f, inv_cell_ = 1.0f;
+        int nx_ = 0, ny_ = 0;
+};
+
+#endif // SPATIAL_GRID_H
@@ -9,6 +9,7 @@
 #include <algorithm>
 #include <cmath>
 #include <limits>
+#include <tuple>
 
 
 // ==================== IoU 计算 ====================
@@ -37,13 +38,13 @@ inline float CalculateIoU(cv::Rect_<float> box1, cv::Rect_<float> box2) {
 // ==================== 余弦距离 ====================
 // 输入：两个特征向量 f1, f2（如 ReID 特征）
 // 输出：余弦距离 = 1 - 余弦相似度 ∈ [0, 2]
-inline float CosineLoss(const std::vector<float>& f1, const std::vector<float>& f2) {
-    if (f1.empty() || f2.empty() || f1.size() != f2.size()) {
+inline float CosineLoss(const float* f1, size_t dim1, const std::vector<float>& f2) {
+    if (f1 == nullptr || dim1 == 0 || f2.empty() || dim1 != f2.size()) {
         return 1.0f; // 无效输入，返回最大距离
     }
 
     double dot = 0.0, norm1 = 0.0, norm2 = 0.0;
-    for (size_t i = 0; i < f1.size(); ++i) {
+    for (size_t i = 0; i < dim1; ++i) {
         dot += static_cast<double>(f1[i]) * f2[i];
         norm1 += static_cast<double>(f1[i]) * f1[i];
         norm2 += static_cast<double>(f2[i]) * f2[i];
@@ -59,6 +60,44 @@ inline float CosineLoss(const std::vector<float>& f1, const std::vector<float>&
     return static_cast<float>(1.0 - cosine_sim);
 }
 
+inline float CosineLoss(const std::vector<float>& f1, const std::vector<float>& f2) {
+    return CosineLoss(f1.data(), f1.size(), f2);
+}
+
+// ==================== L2 归一化 ====================
+// 特征在产生时归一化一次，之后余弦距离只需 1 - 点积，不必每对重算范数
+// 零向量保持为零，对应的距离为 1（与 CosineLoss 对无效输入的返回值一致）
+inline void L2Normalize(float* f, size_t dim) {
+    Eigen::Map<Eigen::VectorXf> v(f, dim);
+    float norm = v.norm();
+    if (norm > 0.0f) v /= norm;
+}
+
+inline void L2Normalize(std::vector<float>& f) {
+    L2Normalize(f.data(), f.size());
+}
+
+// ==================== 余弦距离（已归一化特征） ====================
+// 输入：两个单位特征向量；输出：1 - 点积，限制在 [0, 2]
+inline float NormalizedCosineDistance(const float* f1, const float* f2, size_t dim) {
+    float dot = Eigen::Map<const Eigen::VectorXf>(f1, dim).dot(Eigen::Map<const Eigen::VectorXf>(f2, dim));
+    return std::max(0.0f, std::min(2.0f, 1.0f - dot));
+}
+
+// ==================== 余弦距离矩阵（GEMM） ====================
+// 输入：a 为 na x dim、b 为 nb x dim 的行优先连续矩阵，每行已 L2 归一化
+// 输出：out(i, j) = 1 - a_i · b_j，限制在 [0, 2]；一次 fp32 GEMM 完成全部配对
+using RowMajorMatrixXf = Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
+inline void CosineDistanceMatrix(const float* a, size_t na, const float* b, size_t nb, size_t dim,
+                                 RowMajorMatrixXf& out) {
+    Eigen::Map<const RowMajorMatrixXf> A(a, na, dim);
+    Eigen::Map<const RowMajorMatrixXf> B(b, nb, dim);
+    out.resize(na, nb);
+    out.noalias() = A * B.transpose();
+    out = (1.0f - out.array()).max(0.0f).min(2.0f);
+}
+
 // ==================== 坐标转换：xyah → tlwh ====================
 // xyah: [center_x, center_y, aspect_ratio, height]
 // tlwh: [top_left_x, top_left_y, width, height]
@@ -84,7 +123,21 @@ inline std::vector<float> tlwh_to_xyah(const std::vector<float>& tlwh) {
     return {cx, cy, a, h};
 }
 
-// ==================== 匈牙利算法：双向最优匹配（适配 cv::Mat） ====================
+// ==================== 坐标转换（定长版本，无堆分配） ====================
+// 与上面两个函数公式一致，供逐帧批量转换使用
+inline cv::Rect_<float> xyah_to_rect(float cx, float cy, float a, float h) {
+    float w = a * h;
+    return cv::Rect_<float>(cx - w / 2.0f, cy - h / 2.0f, w, h);
+}
+
+inline Eigen::Vector4f rect_to_xyah(const cv::Rect_<float>& box) {
+    float h = box.height;
+    if (h <= 0) h = 1e-6f; // 防止除零
+    return Eigen::Vector4f(box.x + box.width / 2.0f, box.y + h / 2.0f, box.width / h, h);
+}
+
+// ==================== 贪心匹配（历史命名为 HungarianAlgorithm，适配 cv::Mat） ====================
+// 注意：并非最优分配；需要最优解时使用下方的 LapjvAssignment
 // 输入：
 //   - cost_matrix: 代价矩阵，类型 CV_32F，尺寸 [num_tracks x num_dets]
 //   - gating_threshold: 门控阈值（<=0 表示不启用）
@@ -148,4 +201,399 @@ inline void HungarianAlgorithm(
     }
 }
 
+// ==================== 分配算法选择 ====================
+enum class AssignmentMode {
+    Greedy,   // 贪心：按代价升序逐个接受（HungarianAlgorithm，O(TD log TD)，非最优）
+    LAPJV     // 最优：Jonker-Volgenant 最短增广路（LapjvAssignment）
+};
+
+// ==================== 分配求解器工作区 ====================
+// 预分配的缓冲区，跨帧复用（只增长不释放），避免每次求解都分配内存
+struct AssignmentWorkspace {
+    std::vector<float> cost;   // 门控后的代价（行数 <= 列数，必要时转置）
+    std::vector<float> u, v;   // 行/列对偶变量（势）
+    std::vector<float> minv;   // 最短路中到每列的当前最短距离
+    std::vector<int> p;        // p[j]：第 j 列分配到的行（1-based，0 表示未分配）
+    std::vector<int> way;      // 最短路前驱列
+    std::vector<char> used;    // 列是否已进入最短路树
+
+    // 稀疏求解（LapjvAssignment 的 CSR 重载）使用
+    std::vector<float> dist;          // 最短路距离（未触及的列为 +inf）
+    std::vector<float> price;         // 列势（实列 + 每行一个虚拟“不匹配”列）
+    std::vector<int> pred;            // 最短路上到达该列的行
+    std::vector<int> col_row;         // 列分配到的行，-1 表示空闲
+    std::vector<int> row_col;         // 行分配到的列
+    std::vector<int> touched;         // 本次增广触及的列（用于局部重置）
+    std::vector<int> scanned;         // 本次增广已确定最短距离的列
+    std::vector<std::pair<float, int>> heap; // Dijkstra 小顶堆（懒删除）
+    std::vector<std::tuple<float, int, int>> candidates; // 稀疏贪心的候选对
+};
+
+// ==================== 稀疏代价矩阵（CSR） ====================
+// 行 = 轨迹，列 = 检测；只存放可能的配对，缺省项视为不可匹配。
+// 按行依次 push() 若干 (列, 代价) 后调用 endRow()。
+struct SparseCostMatrix {
+    int rows = 0;
+    int cols = 0;
+    std::vector<int> row_ptr{0};   // 第 i 行的元素位于 [row_ptr[i], row_ptr[i + 1])
+    std::vector<int> col_idx;
+    std::vector<float> values;
+
+    void reset(int num_cols) {
+        rows = 0;
+        cols = num_cols;
+        row_ptr.assign(1, 0);
+        col_idx.clear();
+        values.clear();
+    }
+    void push(int col, float value) {
+        col_idx.push_back(col);
+        values.push_back(value);
+    }
+    void endRow() {
+        row_ptr.push_back(static_cast<int>(col_idx.size()));
+        ++rows;
+    }
+    size_t nnz() const { return col_idx.size(); }
+};
+
+// ==================== LAPJV：矩形代价矩阵的最优分配 ====================
+// Jonker-Volgenant 最短增广路算法（带对偶势的 Dijkstra），复杂度 O(n² m)，n = min(行, 列)。
+// 门控方式与 DeepSORT 的 min_cost_matching 一致：超过阈值的代价截断为 阈值 + 1e-5 参与求解，
+// 求解后再剔除这些匹配，因此结果中所有匹配的代价都 <= gating_threshold。
+// 输入输出含义与 HungarianAlgorithm 相同。
+inline void LapjvAssignment(
+    const cv::Mat& cost_matrix,
+    float gating_threshold,
+    AssignmentWorkspace& ws,
+    std::vector<std::pair<size_t, size_t>>& matches,
+    std::vector<size_t>& unmatched_tracks,
+    std::vector<size_t>& unmatched_dets) {
+
+    matches.clear();
+    unmatched_tracks.clear();
+    unmatched_dets.clear();
+
+    if (cost_matrix.empty()) {
+        return;
+    }
+
+    const int num_tracks = cost_matrix.rows;
+    const int num_dets = cost_matrix.cols;
+
+    // 行数必须 <= 列数：轨迹多于检测时转置求解
+    const bool transposed = num_tracks > num_dets;
+    const int n = transposed ? num_dets : num_tracks;
+    const int m = transposed ? num_tracks : num_dets;
+    const bool gated = gating_threshold > 0;
+    const float gate_cost = gating_threshold + 1e-5f;
+
+    ws.cost.resize(static_cast<size_t>(n) * m);
+    for (int i = 0; i < num_tracks; ++i) {
+        const float* row = cost_matrix.ptr<float>(i);
+        for (int j = 0; j < num_dets; ++j) {
+            float c = (gated && row[j] > gating_threshold) ? gate_cost : row[j];
+            if (transposed) ws.cost[static_cast<size_t>(j) * m + i] = c;
+            else            ws.cost[static_cast<size_t>(i) * m + j] = c;
+        }
+    }
+
+    // 1-based，下标 0 作为虚拟起点列
+    const float INF = std::numeric_limits<float>::infinity();
+    ws.u.assign(n + 1, 0.0f);
+    ws.v.assign(m + 1, 0.0f);
+    ws.p.assign(m + 1, 0);
+    ws.way.assign(m + 1, 0);
+    ws.minv.resize(m + 1);
+    ws.used.resize(m + 1);
+
+    for (int i = 1; i <= n; ++i) {
+        // 为第 i 行寻找一条最短增广路
+        ws.p[0] = i;
+        int j0 = 0;
+        std::fill(ws.minv.begin(), ws.minv.end(), INF);
+        std::fill(ws.used.begin(), ws.used.end(), 0);
+        do {
+            ws.used[j0] = 1;
+            const int i0 = ws.p[j0];
+            const float* row = ws.cost.data() + static_cast<size_t>(i0 - 1) * m;
+            const float ui0 = ws.u[i0];
+            float delta = INF;
+            int j1 = 0;
+            for (int j = 1; j <= m; ++j) {
+                if (ws.used[j]) continue;
+                float cur = row[j - 1] - ui0 - ws.v[j];
+                if (cur < ws.minv[j]) {
+                    ws.minv[j] = cur;
+                    ws.way[j] = j0;
+                }
+                if (ws.minv[j] < delta) {
+                    delta = ws.minv[j];
+                    j1 = j;
+                }
+            }
+            // 更新对偶势，保持已访问列的约化代价为 0
+            for (int j = 0; j <= m; ++j) {
+                if (ws.used[j]) {
+                    ws.u[ws.p[j]] += delta;
+                    ws.v[j] -= delta;
+                } else {
+                    ws.minv[j] -= delta;
+                }
+            }
+            j0 = j1;
+        } while (ws.p[j0] != 0);
+
+        // 沿前驱翻转增广路
+        do {
+            const int j1 = ws.way[j0];
+            ws.p[j0] = ws.p[j1];
+            j0 = j1;
+        } while (j0 != 0);
+    }
+
+    // 收集结果（剔除被门控的匹配）
+    std::vector<bool> track_used(num_tracks, false);
+    std::vector<bool> det_used(num_dets, false);
+    for (int j = 1; j <= m; ++j) {
+        if (ws.p[j] == 0) continue;
+        const int r = ws.p[j] - 1;
+        const int c = j - 1;
+        const int t = transposed ? c : r;
+        const int d = transposed ? r : c;
+        if (gated && cost_matrix.at<float>(t, d) > gating_threshold) continue;
+        matches.emplace_back(t, d);
+        track_used[t] = true;
+        det_used[d] = true;
+    }
+    std::sort(matches.begin(), matches.end());
+
+    for (int i = 0; i < num_tracks; ++i) {
+        if (!track_used[i]) unmatched_tracks.push_back(i);
+    }
+    for (int j = 0; j < num_dets; ++j) {
+        if (!det_used[j]) unmatched_dets.push_back(j);
+    }
+}
+
+// ==================== 贪心匹配：稀疏版本 ====================
+// 只对 CSR 中存在且通过门控的元素排序，复杂度 O(nnz log nnz)
+inline void HungarianAlgorithm(
+    const SparseCostMatrix& cost,
+    float gating_threshold,
+    AssignmentWorkspace& ws,
+    std::vector<std::pair<size_t, size_t>>& matches,
+    std::vector<size_t>& unmatched_tracks,
+    std::vector<size_t>& unmatched_dets) {
+
+    matches.clear();
+    unmatched_tracks.clear();
+    unmatched_dets.clear();
+
+    ws.candidates.clear();
+    for (int i = 0; i < cost.rows; ++i) {
+        for (int k = cost.row_ptr[i]; k < cost.row_ptr[i + 1]; ++k) {
+            if (gating_threshold <= 0 || cost.values[k] <= gating_threshold) {
+                ws.candidates.emplace_back(cost.values[k], i, cost.col_idx[k]);
+            }
+        }
+    }
+    std::sort(ws.candidates.begin(), ws.candidates.end());
+
+    std::vector<bool> track_used(cost.rows, false);
+    std::vector<bool> det_used(cost.cols, false);
+    for (const auto& [cost_val, i, j] : ws.candidates) {
+        if (!track_used[i] && !det_used[j]) {
+            matches.emplace_back(i, j);
+            track_used[i] = true;
+            det_used[j] = true;
+        }
+    }
+
+    for (int i = 0; i < cost.rows; ++i) {
+        if (!track_used[i]) unmatched_tracks.push_back(i);
+    }
+    for (int j = 0; j < cost.cols; ++j) {
+        if (!det_used[j]) unmatched_dets.push_back(j);
+    }
+}
+
+// ==================== LAPJV：稀疏版本 ====================
+// 与稠密版本的目标函数相同（等价于最小化 Σ(c_ij - g)，g = 阈值 + 1e-5），
+// 做法是给每一行增加一个只与该行相连、代价为 g 的虚拟“不匹配”列，
+// 然后对每一行在稀疏图上做一次带列势的 Dijkstra 最短增广（Jonker-Volgenant 增广步骤）。
+// 每次增广只触及从该行可达的列，耗时随局部密度而不是 行数 x 列数 增长。
+// 超过阈值的元素与虚拟列等价，直接忽略。未启用门控时 g 取足够大的值，优先保证匹配数最多。
+inline void LapjvAssignment(
+    const SparseCostMatrix& cost,
+    float gating_threshold,
+    AssignmentWorkspace& ws,
+    std::vector<std::pair<size_t, size_t>>& matches,
+    std::vector<size_t>& unmatched_tracks,
+    std::vector<size_t>& unmatched_dets) {
+
+    matches.clear();
+    unmatched_tracks.clear();
+    unmatched_dets.clear();
+
+    const int n = cost.rows;
+    const int m = cost.cols;
+    const bool gated = gating_threshold > 0;
+    float g = gating_threshold + 1e-5f;
+    if (!gated) {
+        float max_value = 0.0f;
+        for (float v : cost.values) max_value = std::max(max_value, v);
+        g = max_value * static_cast<float>(std::min(n, m) + 1) + 1.0f;
+    }
+
+    // 列编号：[0, m) 为检测，m + i 为第 i 行的虚拟列
+    const int total_cols = m + n;
+    const float INF = std::numeric_limits<float>::infinity();
+    ws.dist.assign(total_cols, INF);
+    ws.price.assign(total_cols, 0.0f);
+    ws.pred.assign(total_cols, -1);
+    ws.col_row.assign(total_cols, -1);
+    ws.row_col.assign(n, -1);
+    ws.used.assign(total_cols, 0);
+
+    auto edge_cost = [&](int k) {
+        // 第 k 个 CSR 元素的代价；超阈值返回 -1 表示忽略
+        float c = cost.values[k];
+        return (gated && c > gating_threshold) ? -1.0f : c;
+    };
+    auto heap_cmp = [](const std::pair<float, int>& a, const std::pair<float, int>& b) {
+        return a.first > b.first;
+    };
+
+    for (int s = 0; s < n; ++s) {
+        ws.touched.clear();
+        ws.scanned.clear();
+        ws.heap.clear();
+
+        auto relax = [&](int j, float d, int row) {
+            if (ws.used[j] || d >= ws.dist[j]) return;
+            if (ws.dist[j] == INF) ws.touched.push_back(j);
+            ws.dist[j] = d;
+            ws.pred[j] = row;
+            ws.heap.emplace_back(d, j);
+            std::push_heap(ws.heap.begin(), ws.heap.end(), heap_cmp);
+        };
+
+        // 从空闲行 s 出发
+        for (int k = cost.row_ptr[s]; k < cost.row_ptr[s + 1]; ++k) {
+            float c = edge_cost(k);
+            if (c >= 0) relax(cost.col_idx[k], c - ws.price[cost.col_idx[k]], s);
+        }
+        relax(m + s, g - ws.price[m + s], s);
+
+        int sink = -1;
+        float sink_dist = 0.0f;
+        while (!ws.heap.empty()) {
+            std::pop_heap(ws.heap.begin(), ws.heap.end(), heap_cmp);
+            auto [d, j] = ws.heap.back();
+            ws.heap.pop_back();
+            if (ws.used[j] || d > ws.dist[j]) continue;   // 过期的堆元素
+            ws.used[j] = 1;
+            ws.scanned.push_back(j);
+
+            const int i = ws.col_row[j];
+            if (i < 0) {   // 找到空闲列，增广路终点
+                sink = j;
+                sink_dist = d;
+                break;
+            }
+
+            // 经由行 i（当前分配在列 j 上）继续扩展，约化代价相对 (i, j) 计算
+            const int dummy = m + i;
+            float base = 0.0f;
+            if (j == dummy) {
+                base = g - ws.price[j];
+            } else {
+                for (int k = cost.row_ptr[i]; k < cost.row_ptr[i + 1]; ++k) {
+                    if (cost.col_idx[k] == j) { base = cost.values[k] - ws.price[j]; break; }
+                }
+            }
+            for (int k = cost.row_ptr[i]; k < cost.row_ptr[i + 1]; ++k) {
+                float c = edge_cost(k);
+                if (c < 0) continue;
+                int col = cost.col_idx[k];
+                relax(col, d + (c - ws.price[col]) - base, i);
+            }
+            relax(dummy, d + (g - ws.price[dummy]) - base, i);
+        }
+
+        // 每行都连着自己的虚拟列，因此一定能找到终点
+        // 更新列势：已确定的列 price += d_j - d_sink（<= 0）
+        for (int j : ws.scanned) {
+            ws.price[j] += ws.dist[j] - sink_dist;
+        }
+
+        // 沿前驱翻转增广路
+        int j = sink;
+        while (j >= 0) {
+            int i = ws.pred[j];
+            int prev = ws.row_col[i];
+            ws.col_row[j] = i;
+            ws.row_col[i] = j;
+            if (i == s) break;
+            j = prev;
+        }
+
+        // 局部重置
+        for (int t : ws.touched) {
+            ws.dist[t] = INF;
+            ws.used[t] = 0;
+        }
+    }
+
+    std::vector<bool> det_used(m, false);
+    for (int i = 0; i < n; ++i) {
+        int j = ws.row_col[i];
+        if (j >= 0 && j < m) {
+            matches.emplace_back(i, j);
+            det_used[j] = true;
+        } else {
+            unmatched_tracks.push_back(i);
+        }
+    }
+    for (int j = 0; j < m; ++j) {
+        if (!det_used[j]) unmatched_dets.push_back(j);
+    }
+}
+
+// ==================== 统一分配接口 ====================
+// 按 mode 选择贪心或 LAPJV，参数含义与 HungarianAlgorithm 相同
+inline void LinearAssignment(
+    const cv::Mat& cost_matrix,
+    float gating_threshold,
+    AssignmentMode mode,
+    AssignmentWorkspace& ws,
+    std::vector<std::pair<size_t, size_t>>& matches,
+    std::vector<size_t>& unmatched_tracks,
+    std::vector<size_t>& unmatched_dets) {
+
+    if (mode == AssignmentMode::Greedy) {
+        HungarianAlgorithm(cost_matrix, gating_threshold, matches, unmatched_tracks, unmatched_dets);
+    } else {
+        LapjvAssignment(cost_matrix, gating_threshold, ws, matches, unmatched_tracks, unmatched_dets);
+    }
+}
+
+// 稀疏版本：CSR 代价矩阵
+inline void LinearAssignment(
+    const SparseCostMatrix& cost,
+    float gating_threshold,
+    AssignmentMode mode,
+    AssignmentWorkspace& ws,
+    std::vector<std::pair<size_t, size_t>>& matches,
+    std::vector<size_t>& unmatched_tracks,
+    std::vector<size_t>& unmatched_dets) {
+
+    if (mode == AssignmentMode::Greedy) {
+        HungarianAlgorithm(cost, gating_threshold, ws, matches, unmatched_tracks, unmatched_dets);
+    } else {
+        LapjvAssignment(cost, gating_threshold, ws, matches, unmatched_tracks, unmatched_dets);
+    }
+}
+
 #endif // UTILS_H
\ No newline at end of file
@@ -1,39 +1,90 @@
 #include "onnx_yolo_detecter.h"
 #include <onnxruntime_cxx_api.h>
+#include <onnxruntime_session_options_config_keys.h>
+#include <chrono>
+#include <filesystem>
 #include <iostream>
+#include <stdexcept>
+
+namespace {
+
+// 进程内所有检测器共享同一个 Ort::Env（线程池、日志等全局状态只建一份）
+Ort::Env& sharedOrtEnv() {
+    static Ort::Env env(ORT_LOGGING_LEVEL_WARNING, "YOLOv8");
+    return env;
+}
+
+// 缓存存在且不比原模型旧时可用（原模型更新后自动重新优化）
+bool optimized_cache_usable(const std::string& cache_path, const std::string& model_path) {
+    std::error_code ec;
+    auto cache_time = std::filesystem::last_write_time(cache_path, ec);
+    if (ec) return false;
+    auto model_time = std::filesystem::last_write_time(model_path, ec);
+    return !ec && cache_time >= model_time;
+}
+
+} // namespace
 
 ONNXYoloDetector::ONNXYoloDetector(const std::string& modelPath,
                                    const std::vector<std::string>& classNames,
                                    int inputWidth,
                                    int inputHeight,
                                    float confThreshold,
-                                   float nmsThreshold)
+                                   float nmsThreshold,
+                                   const DetectorConfig& config)
     : inputWidth_(inputWidth),
       inputHeight_(inputHeight),
       confThreshold_(confThreshold),
       nmsThreshold_(nmsThreshold),
-      classNames_(classNames) {
+      classNames_(classNames),
+      config_(config) {
+    if (config_.intra_op_threads < 0 || config_.inter_op_threads < 0) {
+        throw std::runtime_error("ONNXYoloDetector: thread counts must be >= 0");
+    }
+    auto t0 = std::chrono::steady_clock::now();
 
-    // 初始化 ONNX Runtime
-    Ort::Env env(ORT_LOGGING_LEVEL_WARNING, "YOLOv8");
+    // 初始化 ONNX Runtime（Env 为进程内共享）
+    Ort::Env& env = sharedOrtEnv();
     Ort::SessionOptions sessionOptions;
-    sessionOptions.SetIntraOpNumThreads(1);
-    sessionOptions.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
-
-    Ort::Session session(env, modelPath.c_str(), sessionOptions);
-
-    // 保存到类成员（需用智能指针或手动管理，此处简化）
-    ortEnv = new Ort::Env(std::move(env));
-    ortSession = new Ort::Session(std::move(session));
+    sessionOptions.SetIntraOpNumThreads(config_.intra_op_threads);
+    sessionOptions.SetInterOpNumThreads(config_.inter_op_threads);
+    sessionOptions.SetExecutionMode(config_.parallel_execution ? ExecutionMode::ORT_PARALLEL
+                                                               : ExecutionMode::ORT_SEQUENTIAL);
+    const char* spinning = config_.allow_spinning ? "1" : "0";
+    sessionOptions.AddConfigEntry(kOrtSessionOptionsConfigAllowIntraOpSpinning, spinning);
+    sessionOptions.AddConfigEntry(kOrtSessionOptionsConfigAllowInterOpSpinning, spinning);
+
+    const std::string& cachePath = config_.optimized_model_path;
+    Ort::Session* session = nullptr;
+    if (!cachePath.empty() && optimized_cache_usable(cachePath, modelPath)) {
+        // 缓存中已是优化后的图，不再重复优化
+        Ort::SessionOptions cachedOptions = sessionOptions.Clone();
+        cachedOptions.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_DISABLE_ALL);
+        try {
+            session = new Ort::Session(env, cachePath.c_str(), cachedOptions);
+            load_stats_.from_optimized_cache = true;
+        } catch (const Ort::Exception& e) {
+            // 缓存损坏或由其他版本的 ORT 写出：退回原模型并重写缓存
+            std::cerr << "⚠️ 优化模型缓存不可用，重新优化: " << e.what() << std::endl;
+        }
+    }
+    if (!session) {
+        sessionOptions.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
+        if (!cachePath.empty()) sessionOptions.SetOptimizedModelFilePath(cachePath.c_str());
+        session = new Ort::Session(env, modelPath.c_str(), sessionOptions);
+        load_stats_.wrote_optimized_cache = !cachePath.empty();
+    }
+    ortSession = session;
 
     // 创建内存信息
     ortMemoryInfo = new Ort::MemoryInfo(Ort::MemoryInfo::CreateCpu(OrtAllocatorType::OrtArenaAllocator, OrtMemType::OrtMemTypeDefault));
+
+    load_stats_.session_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
 }
 
 ONNXYoloDetector::~ONNXYoloDetector() {
     delete static_cast<Ort::MemoryInfo*>(ortMemoryInfo);
     delete static_cast<Ort::Session*>(ortSession);
-    delete static_cast<Ort::Env*>(ortEnv);
 }
 
 void ONNXYoloDetector::preprocess(const cv::Mat& frame, float* inputTensorValues) {
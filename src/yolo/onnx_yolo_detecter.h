@@ -9,6 +9,26 @@ struct detect_result {
     float confidence;
 };
 
+// ==================== 检测器会话配置 ====================
+// ONNX Runtime 会话选项。线程数与自旋按主机调：线程自旋降低单帧延迟但空闲时占满 CPU，
+// 与跟踪 / ReID 线程争核时应关闭。
+struct DetectorConfig {
+    int intra_op_threads = 1;           // 单个算子内并行的线程数（0 为 ORT 默认：物理核数）
+    int inter_op_threads = 1;           // parallel_execution 时算子间并行的线程数
+    bool parallel_execution = false;    // false：ORT_SEQUENTIAL；true：ORT_PARALLEL（图中有可并行分支时才有收益）
+    bool allow_spinning = true;         // 线程池空闲时先自旋再阻塞（intra / inter 同时设置）
+    // 优化后模型的缓存路径，为空则不缓存。首次启动在此写出图优化后的模型，
+    // 之后启动若该文件比原模型新则直接加载它并跳过图优化（缓存与主机相关，不要跨机器复制）
+    std::string optimized_model_path;
+};
+
+// ==================== 启动耗时 ====================
+struct DetectorLoadStats {
+    double session_ms = 0.0;            // 创建会话（读模型 + 图优化 / 加载缓存）耗时
+    bool from_optimized_cache = false;  // 是否加载了 optimized_model_path 中的缓存
+    bool wrote_optimized_cache = false; // 本次是否写出了缓存
+};
+
 class ONNXYoloDetector {
 public:
     ONNXYoloDetector(const std::string& modelPath,
@@ -16,20 +36,23 @@ public:
                      int inputWidth = 640,
                      int inputHeight = 640,
                      float confThreshold = 0.5f,
-                     float nmsThreshold = 0.4f);
+                     float nmsThreshold = 0.4f,
+                     const DetectorConfig& config = DetectorConfig());
 
     ~ONNXYoloDetector();
 
     void detect(cv::Mat& frame, std::vector<detect_result>& results);
 
+    const DetectorConfig& config() const { return config_; }
+    const DetectorLoadStats& loadStats() const { return load_stats_; }
+
 private:
     void preprocess(const cv::Mat& frame, float* inputTensorValues);
     void postprocess(const std::vector<float>& outputTensorValues,
                      const cv::Size& frameSize,
                      std::vector<detect_result>& results);
 
-    // ONNX Runtime 对象
-    void* ortEnv = nullptr;
+    // ONNX Runtime 对象（Ort::Env 为进程内共享，不在此持有）
     void* ortSession = nullptr;
     void* ortMemoryInfo = nullptr;
 
@@ -38,6 +61,8 @@ private:
     const float confThreshold_;
     const float nmsThreshold_;
     const std::vector<std::string> classNames_;
+    const DetectorConfig config_;
+    DetectorLoadStats load_stats_;
 
     float scale_ = 1.0f;      // 缩放因子
     float pad_x_ = 0.0f;      // x 方向 padding
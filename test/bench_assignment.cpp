@@ -0,0 +1,220 @@
+#include "utils/utils.h"
+#include "utils/spatial_grid.h"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <numeric>
+#include <cassert>
+
+// ==================== 贪心 vs LAPJV 分配基准 ====================
+// 1. 正确性：小规模随机矩形问题上与穷举最优解对比
+// 2. 性能与质量：稠密 500x500 问题上对比耗时、匹配数和总代价
+// 3. 稀疏（CSR）求解与稠密求解的最优值一致性
+// 4. 场景规模扩展：网格候选 + 稀疏 LAPJV vs 稠密代价矩阵 + 稠密 LAPJV
+
+using Matches = std::vector<std::pair<size_t, size_t>>;
+
+static cv::Mat random_cost(int rows, int cols, std::mt19937& rng) {
+    std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+    cv::Mat cost(rows, cols, CV_32F);
+    for (int i = 0; i < rows; ++i) {
+        for (int j = 0; j < cols; ++j) {
+            cost.at<float>(i, j) = dist(rng);
+        }
+    }
+    return cost;
+}
+
+// 门控后的目标函数：每行（较短一侧）都参与分配，超阈值代价按 阈值 + 1e-5 计
+static float capped(float c, float gate) {
+    return (gate > 0 && c > gate) ? gate + 1e-5f : c;
+}
+
+// 穷举所有分配，返回最小的门控后总代价（仅用于小规模）
+static float brute_force(const cv::Mat& cost, float gate) {
+    bool transposed = cost.rows > cost.cols;
+    cv::Mat c = transposed ? cost.t() : cost;
+    std::vector<int> cols(c.cols);
+    std::iota(cols.begin(), cols.end(), 0);
+    float best = std::numeric_limits<float>::infinity();
+    do {
+        float total = 0.0f;
+        for (int i = 0; i < c.rows; ++i) total += capped(c.at<float>(i, cols[i]), gate);
+        best = std::min(best, total);
+    } while (std::next_permutation(cols.begin(), cols.end()));
+    return best;
+}
+
+// 求解结果对应的门控后总代价：未匹配的行按 阈值 + 1e-5 计
+static float solution_cost(const cv::Mat& cost, const Matches& matches, float gate) {
+    float total = 0.0f;
+    for (const auto& [i, j] : matches) total += cost.at<float>((int)i, (int)j);
+    int rows = std::min(cost.rows, cost.cols);
+    total += (rows - static_cast<int>(matches.size())) * (gate + 1e-5f);
+    return total;
+}
+
+static float matched_cost(const cv::Mat& cost, const Matches& matches) {
+    float total = 0.0f;
+    for (const auto& [i, j] : matches) total += cost.at<float>((int)i, (int)j);
+    return total;
+}
+
+int main() {
+    std::mt19937 rng(2025);
+    AssignmentWorkspace ws;
+    Matches matches;
+    std::vector<size_t> ut, ud;
+
+    // ---------- 1. 正确性 ----------
+    std::cout << "=== LAPJV 正确性（与穷举最优解对比）===\n";
+    int checked = 0;
+    for (int trial = 0; trial < 300; ++trial) {
+        int rows = 1 + static_cast<int>(rng() % 6);
+        int cols = 1 + static_cast<int>(rng() % 6);
+        float gate = (trial % 2 == 0) ? 0.5f : -1.0f;
+        cv::Mat cost = random_cost(rows, cols, rng);
+
+        LapjvAssignment(cost, gate, ws, matches, ut, ud);
+        float got = solution_cost(cost, matches, gate > 0 ? gate : 0.0f);
+        float best = brute_force(cost, gate);
+        if (gate <= 0) got = matched_cost(cost, matches);
+        assert(std::abs(got - best) < 1e-4f);
+        assert(matches.size() + ut.size() == static_cast<size_t>(rows));
+        assert(matches.size() + ud.size() == static_cast<size_t>(cols));
+        for (const auto& [i, j] : matches) {
+            assert(gate <= 0 || cost.at<float>((int)i, (int)j) <= gate);
+            (void)i; (void)j;
+        }
+        if (std::abs(got - best) < 1e-4f) ++checked;
+    }
+    std::cout << "最优解一致: " << checked << " / 300\n\n";
+
+    // ---------- 2. 稠密 500x500 ----------
+    std::cout << "=== 稠密 500x500：贪心 vs LAPJV ===\n";
+    std::cout << std::setw(10) << "门控"
+              << std::setw(10) << "算法"
+              << std::setw(14) << "耗时 ms"
+              << std::setw(10) << "匹配数"
+              << std::setw(14) << "匹配总代价" << "\n";
+
+    const int size = 500;
+    const int repeats = 5;
+    const float gates[] = {0.7f, 0.2f, -1.0f};
+    cv::Mat cost = random_cost(size, size, rng);
+
+    for (float gate : gates) {
+        for (AssignmentMode mode : {AssignmentMode::Greedy, AssignmentMode::LAPJV}) {
+            double total_ms = 0.0;
+            for (int r = 0; r < repeats; ++r) {
+                auto t0 = std::chrono::high_resolution_clock::now();
+                LinearAssignment(cost, gate, mode, ws, matches, ut, ud);
+                auto t1 = std::chrono::high_resolution_clock::now();
+                total_ms += std::chrono::duration<double, std::milli>(t1 - t0).count();
+            }
+            std::cout << std::setw(10) << (gate > 0 ? std::to_string(gate).substr(0, 3) : std::string("无"))
+                      << std::setw(10) << (mode == AssignmentMode::Greedy ? "Greedy" : "LAPJV")
+                      << std::fixed << std::setprecision(2)
+                      << std::setw(14) << total_ms / repeats
+                      << std::setw(10) << matches.size()
+                      << std::setw(14) << matched_cost(cost, matches) << "\n";
+        }
+    }
+
+    // ---------- 3. 稀疏 vs 稠密 ----------
+    std::cout << "\n=== 稀疏 LAPJV 正确性（与稠密 LAPJV 对比）===\n";
+    SparseCostMatrix sparse;
+    int sparse_checked = 0;
+    for (int trial = 0; trial < 300; ++trial) {
+        int rows = 1 + static_cast<int>(rng() % 12);
+        int cols = 1 + static_cast<int>(rng() % 12);
+        float gate = (trial % 2 == 0) ? 0.6f : -1.0f;
+        // 稠密矩阵中缺省项取极大值，对应稀疏矩阵中不存在的元素
+        cv::Mat c = random_cost(rows, cols, rng);
+        sparse.reset(cols);
+        for (int i = 0; i < rows; ++i) {
+            for (int j = 0; j < cols; ++j) {
+                if (rng() % 3 == 0) c.at<float>(i, j) = 1e5f;
+                else sparse.push(j, c.at<float>(i, j));
+            }
+            sparse.endRow();
+        }
+        // 未门控时稠密求解用 1e4 剔除缺省项；此时两者都应先保证匹配数最多，再最小化总代价
+        float g = gate > 0 ? gate : 1e4f;
+
+        LapjvAssignment(c, g, ws, matches, ut, ud);
+        size_t dense_count = matches.size();
+        float dense_cost = matched_cost(c, matches);
+        LapjvAssignment(sparse, gate, ws, matches, ut, ud);
+        float sparse_cost = matched_cost(c, matches);
+        if (gate > 0) {
+            // 门控时两者的目标都等价于最小化 Σ(c_ij - g)
+            dense_cost -= dense_count * (g + 1e-5f);
+            sparse_cost -= matches.size() * (g + 1e-5f);
+        } else if (dense_count != matches.size()) {
+            continue;
+        }
+        assert(matches.size() + ut.size() == static_cast<size_t>(rows));
+        assert(matches.size() + ud.size() == static_cast<size_t>(cols));
+        if (std::abs(dense_cost - sparse_cost) < 1e-4f) ++sparse_checked;
+    }
+    std::cout << "最优值一致: " << sparse_checked << " / 300\n";
+
+    // ---------- 4. 规模扩展 ----------
+    // N 个 60x120 的框随机分布在随 N 增大的画面上（平均密度固定），检测为轨迹加扰动
+    std::cout << "\n=== 场景规模扩展：稠密 vs 网格 + 稀疏 ===\n";
+    std::cout << std::setw(8) << "目标数"
+              << std::setw(14) << "稠密 ms"
+              << std::setw(14) << "稀疏 ms"
+              << std::setw(12) << "非零元"
+              << std::setw(10) << "匹配一致" << "\n";
+    SpatialGrid grid;
+    std::vector<int> cand;
+    for (int n : {10, 100, 1000, 5000}) {
+        float side = 400.0f * std::sqrt(static_cast<float>(n));
+        std::uniform_real_distribution<float> pos(0.0f, side), jitter(-8.0f, 8.0f);
+        std::vector<cv::Rect_<float>> tracks(n), dets(n);
+        for (int i = 0; i < n; ++i) {
+            tracks[i] = cv::Rect_<float>(pos(rng), pos(rng), 60.0f, 120.0f);
+            dets[i] = tracks[i] + cv::Point_<float>(jitter(rng), jitter(rng));
+        }
+        const float gate = 0.7f;
+
+        auto t0 = std::chrono::high_resolution_clock::now();
+        cv::Mat dense(n, n, CV_32F);
+        for (int i = 0; i < n; ++i) {
+            for (int j = 0; j < n; ++j) dense.at<float>(i, j) = 1.0f - CalculateIoU(tracks[i], dets[j]);
+        }
+        LapjvAssignment(dense, gate, ws, matches, ut, ud);
+        auto t1 = std::chrono::high_resolution_clock::now();
+        Matches dense_matches = matches;
+
+        // 网格建在检测上，按轨迹查询候选
+        grid.build(dets);
+        sparse.reset(n);
+        for (int i = 0; i < n; ++i) {
+            cand.clear();
+            grid.query(tracks[i], cand);
+            for (int j : cand) {
+                float c = 1.0f - CalculateIoU(tracks[i], dets[j]);
+                if (c <= gate) sparse.push(j, c);
+            }
+            sparse.endRow();
+        }
+        LapjvAssignment(sparse, gate, ws, matches, ut, ud);
+        auto t2 = std::chrono::high_resolution_clock::now();
+
+        std::sort(dense_matches.begin(), dense_matches.end());
+        std::sort(matches.begin(), matches.end());
+        std::cout << std::setw(8) << n
+                  << std::fixed << std::setprecision(3)
+                  << std::setw(14) << std::chrono::duration<double, std::milli>(t1 - t0).count()
+                  << std::setw(14) << std::chrono::duration<double, std::milli>(t2 - t1).count()
+                  << std::setw(12) << sparse.nnz()
+                  << std::setw(10) << (dense_matches == matches ? "是" : "否") << "\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,137 @@
+#include "kalmanfilter/kalman.h"
+#include "kalmanfilter/kalman_batch.h"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <cmath>
+
+// ==================== 批量 Kalman vs 逐轨迹 Kalman 基准 ====================
+// 每帧：预测全部 N 条轨迹，再更新其中约 80% 的匹配子集（模拟漏检）。
+// 逐轨迹路径即 TrackStore 改造前的写法：每条轨迹各自调用 KalmanFilter::predict/update。
+
+struct Scene {
+    std::vector<Eigen::Vector4f> start;     // 每条轨迹的初始观测
+    std::vector<Eigen::Vector4f> velocity;  // 每帧位移
+};
+
+static Scene make_scene(size_t n, std::mt19937& rng) {
+    std::uniform_real_distribution<float> pos(0.0f, 1920.0f);
+    std::uniform_real_distribution<float> vel(-3.0f, 3.0f);
+    Scene s;
+    for (size_t i = 0; i < n; ++i) {
+        s.start.emplace_back(pos(rng), pos(rng) * 0.5f, 0.5f, 80.0f);
+        s.velocity.emplace_back(vel(rng), vel(rng), 0.0f, 0.0f);
+    }
+    return s;
+}
+
+static Eigen::Vector4f observe(const Scene& s, size_t i, int frame) {
+    return s.start[i] + s.velocity[i] * static_cast<float>(frame);
+}
+
+static bool matched(size_t i, int frame) {
+    return (i + frame) % 5 != 0;
+}
+
+int main() {
+    std::cout << "=== 批量 Kalman 基准（指令集: " << KalmanBatch<>::isaName() << "）===\n\n";
+    std::cout << std::setw(8) << "轨迹数"
+              << std::setw(18) << "逐轨迹 ns/轨迹"
+              << std::setw(18) << "批量 ns/轨迹"
+              << std::setw(10) << "加速比"
+              << std::setw(16) << "最大均值偏差" << "\n";
+
+    const size_t sizes[] = {10, 100, 1000, 10000};
+    const int frames = 50;
+    std::mt19937 rng(7);
+
+    for (size_t n : sizes) {
+        Scene scene = make_scene(n, rng);
+        // 小规模时重复多轮，保证计时稳定
+        int rounds = static_cast<int>(std::max<size_t>(1, 200000 / (n * frames)));
+
+        // ---------- 逐轨迹路径 ----------
+        KalmanFilter<> kf;
+        std::vector<KalmanMean> means(n);
+        std::vector<KalmanCovariance> covs(n);
+        double per_track_ms = 0.0;
+        for (int r = 0; r < rounds; ++r) {
+            for (size_t i = 0; i < n; ++i) {
+                kf.initiate(means[i], covs[i]);
+                kf.update(means[i], covs[i], observe(scene, i, 0));
+            }
+            auto t0 = std::chrono::high_resolution_clock::now();
+            for (int f = 1; f <= frames; ++f) {
+                for (size_t i = 0; i < n; ++i) {
+                    kf.predict(means[i], covs[i]);
+                }
+                for (size_t i = 0; i < n; ++i) {
+                    if (matched(i, f)) kf.update(means[i], covs[i], observe(scene, i, f));
+                }
+            }
+            auto t1 = std::chrono::high_resolution_clock::now();
+            per_track_ms += std::chrono::duration<double, std::milli>(t1 - t0).count();
+        }
+
+        // ---------- 批量路径 ----------
+        KalmanBatch<> batch;
+        size_t stride = (n + KalmanBatch<>::kLaneAlign - 1) / KalmanBatch<>::kLaneAlign * KalmanBatch<>::kLaneAlign;
+        std::vector<float> bmean(8 * stride), bcov(64 * stride);
+        std::vector<uint32_t> indices;
+        std::vector<float> z;
+        indices.reserve(n);
+        z.reserve(4 * n);
+        double batch_ms = 0.0;
+        for (int r = 0; r < rounds; ++r) {
+            indices.clear();
+            z.clear();
+            for (size_t i = 0; i < n; ++i) {
+                batch.initiate(bmean.data(), bcov.data(), stride, i);
+                Eigen::Vector4f zi = observe(scene, i, 0);
+                indices.push_back(static_cast<uint32_t>(i));
+                z.insert(z.end(), zi.data(), zi.data() + 4);
+            }
+            batch.update(bmean.data(), bcov.data(), stride, indices.data(), z.data(), indices.size());
+
+            auto t0 = std::chrono::high_resolution_clock::now();
+            for (int f = 1; f <= frames; ++f) {
+                batch.predict(bmean.data(), bcov.data(), stride, n);
+                indices.clear();
+                z.clear();
+                for (size_t i = 0; i < n; ++i) {
+                    if (!matched(i, f)) continue;
+                    Eigen::Vector4f zi = observe(scene, i, f);
+                    indices.push_back(static_cast<uint32_t>(i));
+                    z.insert(z.end(), zi.data(), zi.data() + 4);
+                }
+                batch.update(bmean.data(), bcov.data(), stride, indices.data(), z.data(), indices.size());
+            }
+            auto t1 = std::chrono::high_resolution_clock::now();
+            batch_ms += std::chrono::duration<double, std::milli>(t1 - t0).count();
+        }
+
+        // ---------- 一致性：两条路径的最终均值 ----------
+        float max_diff = 0.0f;
+        for (size_t i = 0; i < n; ++i) {
+            for (int k = 0; k < 8; ++k) {
+                max_diff = std::max(max_diff, std::abs(means[i][k] - bmean[k * stride + i]));
+            }
+        }
+
+        double denom = static_cast<double>(n) * frames * rounds;
+        double per_track_ns = per_track_ms * 1e6 / denom;
+        double batch_ns = batch_ms * 1e6 / denom;
+        std::cout << std::setw(8) << n
+                  << std::fixed << std::setprecision(1)
+                  << std::setw(18) << per_track_ns
+                  << std::setw(18) << batch_ns
+                  << std::setprecision(2)
+                  << std::setw(9) << per_track_ns / batch_ns << "x"
+                  << std::scientific << std::setw(16) << max_diff
+                  << std::defaultfloat << "\n";
+    }
+
+    return 0;
+}
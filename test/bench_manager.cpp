@@ -0,0 +1,106 @@
+#include "tracker/TrackerManager.h"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <random>
+#include <string>
+
+// ==================== 多路跟踪管理器基准 ====================
+// N 路合成视频（每路 30 个匀速目标 + 位置噪声 + 约 6% 漏检）共用一个 TrackerManager，
+// 检测结果直接交给 track()，按帧轮流处理各路，打印每路与合计的吞吐、内存。
+// 默认 SORT 模式；命令行给出 ReID 模型路径时为 DeepSORT（所有路共享这一个模型）。
+// 用法：bench_manager [reid_model.mnn]
+
+struct Stream {
+    std::vector<cv::Point2f> pos, vel;
+};
+
+static Stream make_stream(int n, std::mt19937& rng) {
+    std::uniform_real_distribution<float> px(0.0f, 1860.0f), py(0.0f, 960.0f);
+    std::uniform_real_distribution<float> v(-4.0f, 4.0f);
+    Stream s;
+    for (int i = 0; i < n; ++i) {
+        s.pos.emplace_back(px(rng), py(rng));
+        s.vel.emplace_back(v(rng), v(rng) * 0.5f);
+    }
+    return s;
+}
+
+// 推进一帧并生成检测；with_frame 时把检测框画到 frame 上（DeepSORT 的 ReID 输入）
+static void step(Stream& s, int f, std::mt19937& rng, std::vector<detect_result>& dets,
+                 cv::Mat& frame, bool with_frame) {
+    std::normal_distribution<float> noise(0.0f, 1.0f);
+    dets.clear();
+    if (with_frame) {
+        frame.create(1080, 1920, CV_8UC3);
+        frame.setTo(cv::Scalar(0, 0, 0));
+    }
+    for (size_t i = 0; i < s.pos.size(); ++i) {
+        s.pos[i] += s.vel[i];
+        if (s.pos[i].x < 0 || s.pos[i].x > 1860) s.vel[i].x = -s.vel[i].x;
+        if (s.pos[i].y < 0 || s.pos[i].y > 960) s.vel[i].y = -s.vel[i].y;
+        if ((f + i) % 17 == 0) continue;
+        detect_result d;
+        d.box = cv::Rect(static_cast<int>(s.pos[i].x + noise(rng)), static_cast<int>(s.pos[i].y + noise(rng)), 60, 120);
+        d.confidence = 0.9f;
+        d.classId = 0;
+        dets.push_back(d);
+        if (with_frame) {
+            cv::rectangle(frame, d.box, cv::Scalar((i * 53) % 256, (i * 97) % 256, (i * 193) % 256), -1);
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    std::string reid_model_path = argc > 1 ? argv[1] : "";
+    const int num_frames = 200;
+    const int objects_per_stream = 30;
+    std::mt19937 rng(9);
+
+    for (int num_streams : {1, 8, 32}) {
+        TrackerManager<> manager("", {}, reid_model_path);
+        std::vector<Stream> scenes;
+        std::vector<int> ids;
+        for (int s = 0; s < num_streams; ++s) {
+            ids.push_back(manager.addStream());
+            scenes.push_back(make_stream(objects_per_stream, rng));
+        }
+
+        std::vector<detect_result> dets;
+        std::vector<TrackOutput> outputs;
+        cv::Mat frame;
+        for (int f = 0; f < num_frames; ++f) {
+            for (int s = 0; s < num_streams; ++s) {
+                step(scenes[s], f, rng, dets, frame, !reid_model_path.empty());
+                manager.track(ids[s], frame, dets, outputs);
+            }
+        }
+
+        // 多路时只打印合计，避免刷屏
+        if (num_streams <= 8) {
+            manager.printReport(std::cout);
+        } else {
+            StreamStats total = manager.aggregate();
+            std::cout << "=== TrackerManager: " << num_streams << " 路（只列合计）===\n"
+                      << "  帧数 " << total.frames
+                      << "，跟踪 " << std::fixed << std::setprecision(3) << total.track_ms / total.frames << " ms/帧"
+                      << "，FPS " << std::setprecision(1) << total.fps()
+                      << "，内存 " << total.memory_bytes / 1024.0 << " KB"
+                      << "（每路 " << total.memory_bytes / 1024.0 / num_streams << " KB）\n"
+                      << std::defaultfloat;
+        }
+        if (manager.sharedModelBytes() > 0) {
+            std::cout << "  共享模型避免的重复加载: "
+                      << (num_streams - 1) * manager.sharedModelBytes() / 1024 << " KB\n";
+        }
+
+        // 移除一路后新增的路复用其编号，状态从头开始
+        manager.removeStream(ids[0]);
+        int reused = manager.addStream();
+        if (reused != ids[0] || manager.stats(reused).frames != 0 || manager.numStreams() != static_cast<size_t>(num_streams)) {
+            std::cerr << "stream reuse failed\n";
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,296 @@
+#include "tracker/DeepSortTracker.h"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+
+// ==================== 跟踪器规模基准（合成场景）====================
+// 不依赖检测模型和 ReID 模型，只测关联 + Kalman 流程随目标数的增长：
+//   - 目标：匀速 / 转向（速度方向缓慢旋转）/ 随机游走三种运动模型，带位置噪声
+//   - 遮挡：场景中若干静止遮挡物，被遮挡超过 70% 的目标漏检，30%~70% 的输出低分检测；另有随机漏检和虚警
+//   - 出生与死亡：每帧按概率死亡，离开画面也死亡，死亡后在随机位置（或从边缘）补一个新目标，总数保持 N
+//   - 外观：每个目标一个基准特征，逐帧加噪声后归一化；clustered 时基准特征围绕少数中心聚集（同款制服），外观更难区分
+// DeepSORT 模式通过 DeepSortTracker::replay() 把合成特征直接交给跟踪器（不做裁剪和推理）；--sort 时走 SORT 流程。
+// 每个规模输出每帧耗时的分位数、各阶段均值和跟踪器内存，看哪一段在目标数增大时超线性增长。
+//
+// 用法：bench_scaling [--motion cv|turn|walk] [--embed random|clustered] [--sort] [--fixed-area]
+//                     [--frames 100] [--dim 512] [--max 10000]
+//   --fixed-area: 画面固定为 1080p（默认画面随目标数增大，保持密度与 1080p 上 30 个目标相当）
+
+enum class Motion { ConstantVelocity, Turning, RandomWalk };
+
+struct SceneConfig {
+    int num_objects = 100;
+    Motion motion = Motion::ConstantVelocity;
+    bool clustered = false;          // 外观聚集
+    bool fixed_area = false;
+    size_t dim = 512;                // 0 表示不生成特征（SORT）
+    float death_prob = 0.005f;       // 每帧每个目标的死亡概率
+    float miss_prob = 0.03f;         // 随机漏检
+    float false_positive_rate = 0.01f;  // 每帧虚警数 = rate * N
+    float feature_noise = 0.25f;     // 逐帧外观噪声（相对单位向量）
+};
+
+// 合成场景：逐帧推进，输出一帧的检测与特征（FlightFrame，直接交给 replay）
+class SyntheticScene {
+    public:
+        SyntheticScene(const SceneConfig& cfg, uint32_t seed) : cfg_(cfg), rng_(seed), noise_state_(seed * 2654435761u + 1) {
+            float scale = cfg.fixed_area ? 1.0f : std::sqrt(std::max(1.0f, cfg.num_objects / 30.0f));
+            width_ = 1920.0f * scale;
+            height_ = 1080.0f * scale;
+
+            // 遮挡物：约每 30 个目标一个，宽高 80~240
+            std::uniform_real_distribution<float> ux(0.0f, width_), uy(0.0f, height_), us(80.0f, 240.0f);
+            int num_occluders = std::max(1, cfg.num_objects / 30);
+            for (int k = 0; k < num_occluders; ++k) {
+                occluders_.emplace_back(ux(rng_), uy(rng_), us(rng_), us(rng_));
+            }
+
+            if (cfg.clustered) {
+                int num_clusters = std::max(2, cfg.num_objects / 20);
+                for (int c = 0; c < num_clusters; ++c) centers_.push_back(_random_unit());
+            }
+            objects_.resize(cfg.num_objects);
+            for (auto& o : objects_) _spawn(o, false);
+        }
+
+        // 推进一帧，写入 out（复用其容量）
+        void step(FlightFrame& out) {
+            std::uniform_real_distribution<float> u01(0.0f, 1.0f);
+            std::normal_distribution<float> g(0.0f, 1.0f);
+            out.clear();
+            out.feature_dim = cfg_.dim;
+
+            for (auto& o : objects_) {
+                switch (cfg_.motion) {
+                    case Motion::ConstantVelocity:
+                        break;
+                    case Motion::Turning: {
+                        // 速度方向每帧旋转 turn 弧度，速率不变
+                        float c = std::cos(o.turn), s = std::sin(o.turn);
+                        o.vel = cv::Point2f(c * o.vel.x - s * o.vel.y, s * o.vel.x + c * o.vel.y);
+                        break;
+                    }
+                    case Motion::RandomWalk:
+                        o.vel += cv::Point2f(0.5f * g(rng_), 0.25f * g(rng_));
+                        o.vel *= 0.95f;
+                        break;
+                }
+                o.pos += o.vel;
+                bool outside = o.pos.x < -o.size.width || o.pos.y < -o.size.height ||
+                               o.pos.x > width_ || o.pos.y > height_;
+                if (outside || u01(rng_) < cfg_.death_prob) {
+                    _spawn(o, true);
+                    continue;
+                }
+
+                cv::Rect_<float> box(o.pos.x + g(rng_), o.pos.y + g(rng_), o.size.width, o.size.height);
+                float covered = 0.0f;
+                for (const auto& occ : occluders_) covered = std::max(covered, (box & occ).area() / box.area());
+                if (covered > 0.7f || u01(rng_) < cfg_.miss_prob) continue;
+                if (covered > 0.3f) {
+                    out.low_detections.push_back(box);
+                    continue;
+                }
+                _emit(out, box, o.embedding.data());
+            }
+
+            // 虚警：随机位置、随机外观
+            std::uniform_real_distribution<float> ux(0.0f, width_), uy(0.0f, height_);
+            int num_fp = static_cast<int>(cfg_.false_positive_rate * cfg_.num_objects + u01(rng_));
+            for (int k = 0; k < num_fp; ++k) {
+                fp_embedding_ = _random_unit();
+                _emit(out, cv::Rect_<float>(ux(rng_), uy(rng_), 60.0f, 120.0f), fp_embedding_.data());
+            }
+        }
+
+    private:
+        struct Object {
+            cv::Point2f pos, vel;
+            cv::Size2f size;
+            float turn = 0.0f;
+            std::vector<float> embedding;
+        };
+
+        void _spawn(Object& o, bool from_edge) {
+            std::uniform_real_distribution<float> ux(0.0f, width_), uy(0.0f, height_);
+            std::uniform_real_distribution<float> v(-4.0f, 4.0f), sz(0.8f, 1.2f), turn(-0.03f, 0.03f);
+            o.size = cv::Size2f(60.0f * sz(rng_), 120.0f * sz(rng_));
+            o.pos = cv::Point2f(ux(rng_), uy(rng_));
+            o.vel = cv::Point2f(v(rng_), v(rng_) * 0.5f);
+            o.turn = turn(rng_);
+            if (from_edge) {
+                // 从左右边缘进入画面
+                bool left = o.vel.x > 0;
+                o.pos.x = left ? -o.size.width * 0.5f : width_ - o.size.width * 0.5f;
+            }
+            if (centers_.empty()) {
+                o.embedding = _random_unit();
+            } else {
+                const std::vector<float>& c = centers_[rng_() % centers_.size()];
+                o.embedding = _random_unit();
+                for (size_t d = 0; d < cfg_.dim; ++d) o.embedding[d] = c[d] + 0.35f * o.embedding[d];
+                L2Normalize(o.embedding);
+            }
+        }
+
+        std::vector<float> _random_unit() {
+            std::normal_distribution<float> g(0.0f, 1.0f);
+            std::vector<float> v(cfg_.dim);
+            for (auto& x : v) x = g(rng_);
+            L2Normalize(v);
+            return v;
+        }
+
+        // 逐帧外观噪声用 xorshift 生成（10k 目标 x 512 维时正态采样本身就比跟踪慢）
+        float _noise() {
+            noise_state_ ^= noise_state_ << 13;
+            noise_state_ ^= noise_state_ >> 17;
+            noise_state_ ^= noise_state_ << 5;
+            return static_cast<float>(noise_state_) * (2.0f / 4294967296.0f) - 1.0f;
+        }
+
+        void _emit(FlightFrame& out, const cv::Rect_<float>& box, const float* embedding) {
+            out.detections.push_back(box);
+            if (cfg_.dim == 0) return;
+            out.feature_dets.push_back(static_cast<int32_t>(out.detections.size() - 1));
+            // 均匀噪声的标准差为 1/sqrt(3)，按维度缩放使噪声向量的模约为 feature_noise
+            const float scale = cfg_.feature_noise * std::sqrt(3.0f / cfg_.dim);
+            const size_t base = out.features.size();
+            out.features.resize(base + cfg_.dim);
+            float* f = out.features.data() + base;
+            float norm = 0.0f;
+            for (size_t d = 0; d < cfg_.dim; ++d) {
+                f[d] = embedding[d] + scale * _noise();
+                norm += f[d] * f[d];
+            }
+            norm = 1.0f / std::sqrt(norm);
+            for (size_t d = 0; d < cfg_.dim; ++d) f[d] *= norm;
+        }
+
+        SceneConfig cfg_;
+        std::mt19937 rng_;
+        uint32_t noise_state_;
+        float width_, height_;
+        std::vector<Object> objects_;
+        std::vector<cv::Rect_<float>> occluders_;
+        std::vector<std::vector<float>> centers_;
+        std::vector<float> fp_embedding_;
+};
+
+struct ScaleResult {
+    double dets_per_frame = 0.0;
+    double tracks = 0.0;             // 平均输出轨迹数
+    double p50 = 0.0, p90 = 0.0, p99 = 0.0, max = 0.0, mean = 0.0;
+    StageTimings stage_mean;
+    size_t memory_bytes = 0;
+};
+
+static double percentile(std::vector<double> v, double p) {
+    if (v.empty()) return 0.0;
+    size_t k = std::min(v.size() - 1, static_cast<size_t>(p * (v.size() - 1) + 0.5));
+    std::nth_element(v.begin(), v.begin() + k, v.end());
+    return v[k];
+}
+
+static ScaleResult run(const SceneConfig& cfg, int num_frames, bool sort_mode) {
+    // 前 kWarmup 帧轨迹尚在建立（大多为 Tentative），不计入统计
+    const int kWarmup = 5;
+    SceneConfig scene_cfg = cfg;
+    if (sort_mode) scene_cfg.dim = 0;
+    SyntheticScene scene(scene_cfg, 2024u + cfg.num_objects);
+    DeepSortTracker<> tracker("");
+    FlightFrame frame;
+    std::vector<TrackOutput> outputs;
+    std::vector<double> ms;
+    ScaleResult r;
+
+    for (int f = 0; f < kWarmup + num_frames; ++f) {
+        scene.step(frame);
+        auto t0 = std::chrono::high_resolution_clock::now();
+        tracker.replay(frame, !sort_mode, outputs);
+        auto t1 = std::chrono::high_resolution_clock::now();
+        if (f < kWarmup) continue;
+
+        ms.push_back(std::chrono::duration<double, std::milli>(t1 - t0).count());
+        r.dets_per_frame += frame.detections.size() + frame.low_detections.size();
+        r.tracks += outputs.size();
+        const StageTimings& t = tracker.lastTimings();
+        for (int s = 0; s < static_cast<int>(TrackerStage::Count); ++s) r.stage_mean.ms[s] += t.ms[s];
+    }
+
+    r.dets_per_frame /= num_frames;
+    r.tracks /= num_frames;
+    for (int s = 0; s < static_cast<int>(TrackerStage::Count); ++s) r.stage_mean.ms[s] /= num_frames;
+    for (double x : ms) r.mean += x / num_frames;
+    r.p50 = percentile(ms, 0.50);
+    r.p90 = percentile(ms, 0.90);
+    r.p99 = percentile(ms, 0.99);
+    r.max = *std::max_element(ms.begin(), ms.end());
+    r.memory_bytes = tracker.memoryBytes();
+    return r;
+}
+
+int main(int argc, char** argv) {
+    SceneConfig base;
+    int num_frames = 100;
+    int max_objects = 10000;
+    bool sort_mode = false;
+    for (int a = 1; a < argc; ++a) {
+        std::string arg = argv[a];
+        const char* next = a + 1 < argc ? argv[a + 1] : "";
+        if (arg == "--sort") sort_mode = true;
+        else if (arg == "--fixed-area") base.fixed_area = true;
+        else if (arg == "--motion") {
+            std::string m = next; ++a;
+            base.motion = m == "turn" ? Motion::Turning : m == "walk" ? Motion::RandomWalk : Motion::ConstantVelocity;
+        }
+        else if (arg == "--embed") { base.clustered = std::strcmp(next, "clustered") == 0; ++a; }
+        else if (arg == "--frames") { num_frames = std::max(1, std::atoi(next)); ++a; }
+        else if (arg == "--dim") { base.dim = std::max(1, std::atoi(next)); ++a; }
+        else if (arg == "--max") { max_objects = std::atoi(next); ++a; }
+        else {
+            std::cerr << "usage: " << argv[0] << " [--motion cv|turn|walk] [--embed random|clustered] [--sort]"
+                      << " [--fixed-area] [--frames 100] [--dim 512] [--max 10000]\n";
+            return 1;
+        }
+    }
+
+    const char* motion_name[] = {"匀速", "转向", "随机游走"};
+    std::cout << "=== 跟踪器规模基准：" << (sort_mode ? "SORT" : "DeepSORT（合成 ReID 特征）")
+              << "，" << motion_name[static_cast<int>(base.motion)] << "运动，"
+              << (base.clustered ? "聚集" : "随机") << "外观，" << (base.fixed_area ? "固定 1080p 画面" : "密度恒定")
+              << "，" << num_frames << " 帧 ===\n";
+    std::cout << std::setw(8) << "目标" << std::setw(9) << "检测/帧" << std::setw(9) << "轨迹"
+              << std::setw(9) << "p50" << std::setw(9) << "p90" << std::setw(9) << "p99" << std::setw(9) << "max"
+              << std::setw(10) << "us/目标";
+    for (int s = 0; s < static_cast<int>(TrackerStage::Count); ++s) {
+        std::cout << std::setw(12) << StageTimings::name(static_cast<TrackerStage>(s));
+    }
+    std::cout << std::setw(12) << "内存 KB" << "\n";
+
+    for (int n : {10, 30, 100, 300, 1000, 3000, 10000}) {
+        if (n > max_objects) break;
+        SceneConfig cfg = base;
+        cfg.num_objects = n;
+        ScaleResult r = run(cfg, num_frames, sort_mode);
+
+        std::cout << std::fixed << std::setprecision(1)
+                  << std::setw(8) << n << std::setw(9) << r.dets_per_frame << std::setw(9) << r.tracks
+                  << std::setprecision(3)
+                  << std::setw(9) << r.p50 << std::setw(9) << r.p90 << std::setw(9) << r.p99 << std::setw(9) << r.max
+                  << std::setprecision(2) << std::setw(10) << r.mean * 1000.0 / n;
+        for (int s = 0; s < static_cast<int>(TrackerStage::Count); ++s) {
+            std::cout << std::setprecision(3) << std::setw(12) << r.stage_mean.ms[s];
+        }
+        std::cout << std::setprecision(0) << std::setw(12) << r.memory_bytes / 1024.0 << "\n" << std::defaultfloat;
+    }
+    std::cout << "（耗时单位 ms/帧；us/目标 = 平均每帧耗时 / 目标数，随规模上升即超线性；各阶段为均值）\n";
+    return 0;
+}
@@ -0,0 +1,122 @@
+#include "tracker/DeepSortTracker.h"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <string>
+
+// ==================== SORT 模式 vs DeepSORT 吞吐基准 ====================
+// 同一组合成检测（匀速运动的框 + 位置噪声 + 约 6% 漏检），分别用
+//   - SORT 模式（不加载 ReID，frame 传空 Mat）
+//   - DeepSORT（需要命令行给出 ReID 模型路径；每帧画出检测框作为输入图像，画图不计时）
+// 统计每帧耗时和 FPS。用法：bench_sort [reid_model.mnn]
+
+struct Scene {
+    std::vector<std::vector<cv::Rect_<float>>> frames;  // 每帧的检测
+    std::vector<cv::Scalar> colors;                      // 每个目标的颜色（DeepSORT 画图用）
+    std::vector<std::vector<int>> owners;                // 每帧每个检测对应的目标
+    cv::Size size;
+};
+
+static Scene make_scene(int n, int num_frames, std::mt19937& rng) {
+    // 画面随目标数增大，保持目标密度与 1080p 上 30 个目标相当
+    float scale = std::sqrt(std::max(1.0f, n / 30.0f));
+    Scene s;
+    s.size = cv::Size(static_cast<int>(1920 * scale), static_cast<int>(1080 * scale));
+    std::uniform_real_distribution<float> px(0.0f, s.size.width - 60.0f), py(0.0f, s.size.height - 120.0f);
+    std::uniform_real_distribution<float> v(-4.0f, 4.0f);
+    std::normal_distribution<float> noise(0.0f, 1.0f);
+
+    std::vector<cv::Point2f> pos(n), vel(n);
+    for (int i = 0; i < n; ++i) {
+        pos[i] = cv::Point2f(px(rng), py(rng));
+        vel[i] = cv::Point2f(v(rng), v(rng) * 0.5f);
+        s.colors.emplace_back(rng() % 256, rng() % 256, rng() % 256);
+    }
+    for (int f = 0; f < num_frames; ++f) {
+        std::vector<cv::Rect_<float>> dets;
+        std::vector<int> owners;
+        for (int i = 0; i < n; ++i) {
+            pos[i] += vel[i];
+            // 碰到边界反弹
+            if (pos[i].x < 0 || pos[i].x > s.size.width - 60) vel[i].x = -vel[i].x;
+            if (pos[i].y < 0 || pos[i].y > s.size.height - 120) vel[i].y = -vel[i].y;
+            if ((f + i) % 17 == 0) continue;
+            dets.emplace_back(pos[i].x + noise(rng), pos[i].y + noise(rng), 60.0f, 120.0f);
+            owners.push_back(i);
+        }
+        s.frames.push_back(std::move(dets));
+        s.owners.push_back(std::move(owners));
+    }
+    return s;
+}
+
+struct Result {
+    double ms_per_frame = 0.0;
+    int max_id = 0;
+};
+
+static Result run(DeepSortTracker<>& tracker, const Scene& scene, bool draw) {
+    std::vector<TrackOutput> outputs;
+    cv::Mat frame;
+    double total_ms = 0.0;
+    Result r;
+    for (size_t f = 0; f < scene.frames.size(); ++f) {
+        if (draw) {
+            frame.create(scene.size, CV_8UC3);
+            frame.setTo(cv::Scalar(0, 0, 0));
+            for (size_t k = 0; k < scene.frames[f].size(); ++k) {
+                cv::rectangle(frame, cv::Rect(scene.frames[f][k]), scene.colors[scene.owners[f][k]], -1);
+            }
+        }
+        auto t0 = std::chrono::high_resolution_clock::now();
+        tracker.update(frame, scene.frames[f], outputs);
+        auto t1 = std::chrono::high_resolution_clock::now();
+        total_ms += std::chrono::duration<double, std::milli>(t1 - t0).count();
+        for (const auto& t : outputs) r.max_id = std::max(r.max_id, t.id);
+    }
+    r.ms_per_frame = total_ms / scene.frames.size();
+    return r;
+}
+
+int main(int argc, char** argv) {
+    std::string reid_model_path = argc > 1 ? argv[1] : "";
+    const int num_frames = 200;
+    std::mt19937 rng(5);
+
+    std::cout << "=== SORT vs DeepSORT 吞吐（" << num_frames << " 帧）===\n";
+    if (reid_model_path.empty()) {
+        std::cout << "（未提供 ReID 模型路径，只测 SORT 模式）\n";
+    }
+    std::cout << std::setw(8) << "目标数"
+              << std::setw(16) << "SORT ms/帧"
+              << std::setw(12) << "SORT FPS"
+              << std::setw(10) << "最大ID"
+              << std::setw(18) << "DeepSORT ms/帧"
+              << std::setw(14) << "DeepSORT FPS"
+              << std::setw(10) << "最大ID" << "\n";
+
+    for (int n : {10, 100, 1000}) {
+        Scene scene = make_scene(n, num_frames, rng);
+
+        DeepSortTracker<> sort_tracker("");
+        Result sort = run(sort_tracker, scene, false);
+
+        std::cout << std::setw(8) << n << std::fixed
+                  << std::setprecision(3) << std::setw(16) << sort.ms_per_frame
+                  << std::setprecision(0) << std::setw(12) << 1000.0 / sort.ms_per_frame
+                  << std::setw(10) << sort.max_id;
+
+        if (!reid_model_path.empty()) {
+            DeepSortTracker<> deep_tracker(reid_model_path);
+            Result deep = run(deep_tracker, scene, true);
+            std::cout << std::setprecision(3) << std::setw(18) << deep.ms_per_frame
+                      << std::setprecision(0) << std::setw(14) << 1000.0 / deep.ms_per_frame
+                      << std::setw(10) << deep.max_id;
+        }
+        std::cout << "\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,316 @@
+#include "tracker/DeepSortTracker.h"
+#include "eval/MotMetrics.h"
+#include <opencv2/imgcodecs.hpp>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <limits>
+#include <algorithm>
+#include <filesystem>
+
+// ==================== MOTChallenge 离线评测 ====================
+// 对 MOT16/17/20 目录结构的序列运行 DeepSortTracker：
+//   <seq>/det/det.txt     公开检测（必需）
+//   <seq>/gt/gt.txt       本地真值（可选，有则计算 MOTA / IDF1 / HOTA）
+//   <seq>/img1/000001.jpg 图像（只在给出 --reid 时读取，送入 ReID）
+//   <seq>/seqinfo.ini     序列长度、图像目录和扩展名（可选）
+// 跟踪结果以 MOT 格式写入 <out>/<seq>.txt，同时统计跟踪 FPS（不含读图）和各阶段耗时，
+// 任何性能改动都可以在本地数据上同时看到精度是否回退。
+// 路径可以是单个序列目录，也可以是包含多个序列的目录（如 MOT17/train）。
+//
+// 用法：eval_mot <seq_or_root> [--reid osnet.mnn] [--out mot_results] [--high-score 0.5] [--min-score -inf]
+//                [--max-age 30] [--n-init 3] [--greedy] [--no-rules] [--frame-step 1] [--no-timestamps]
+//                [--detect-interval 1] [--flow-scale 0.5]
+//   --min-score: 丢弃置信度低于该值的检测；--high-score: ByteTrack 两阶段关联的高/低分分界
+//   --no-rules: 不做 MOTChallenge 的干扰项预处理，gt 全部参与评测
+//   --frame-step k: 抽帧，只处理每 k 帧中的第 1 帧，并只在这些帧上评测；
+//                   帧时间戳按 seqinfo.ini 的 frameRate 传给 update()，Kalman 一次外推 k 帧
+//   --no-timestamps: 不传时间戳（每次 update() 只外推一帧），用于对比抽帧时变帧间隔预测的效果
+//   --detect-interval k: 关键帧 / 插帧模式，检测只在 needsDetection() 的帧上使用，其余帧 propagate()
+//                        （需要图像）；所有帧都参与评测，与 k = 1 对比即为插帧的精度损失。
+//                        检测来自 det.txt，不计检测器耗时：吞吐提升按“检测帧占比”折算到检测器上
+
+namespace fs = std::filesystem;
+
+struct Options {
+    std::string reid_model_path;
+    std::string out_dir = "mot_results";
+    float high_score = 0.5f;
+    float min_score = -std::numeric_limits<float>::infinity();
+    int max_age = 30;
+    int n_init = 3;
+    AssignmentMode assignment = AssignmentMode::LAPJV;
+    bool mot_rules = true;
+    int frame_step = 1;
+    bool timestamps = true;
+    KeyframeConfig keyframe;
+};
+
+struct SeqInfo {
+    std::string name;
+    std::string im_dir = "img1";
+    std::string im_ext = ".jpg";
+    int length = 0;
+    double frame_rate = 30.0;
+};
+
+struct SeqResult {
+    std::string name;
+    size_t frames = 0;
+    size_t detections = 0;
+    double track_ms = 0.0;           // update() 总耗时
+    double read_ms = 0.0;            // 读图总耗时（不计入 FPS）
+    double keyframe_ms = 0.0;        // 关键帧 update() 总耗时
+    double interframe_ms = 0.0;      // 插帧 propagate() 总耗时
+    KeyframeStats keyframe_stats;
+    StageTimings stage_sum;
+    bool has_gt = false;
+    MotSummary metrics;
+};
+
+static SeqInfo read_seqinfo(const fs::path& seq_dir) {
+    SeqInfo info;
+    info.name = seq_dir.filename().string();
+    std::ifstream f(seq_dir / "seqinfo.ini");
+    std::string line;
+    while (std::getline(f, line)) {
+        auto eq = line.find('=');
+        if (eq == std::string::npos) continue;
+        std::string key = line.substr(0, eq), value = line.substr(eq + 1);
+        value.erase(std::remove_if(value.begin(), value.end(), ::isspace), value.end());
+        if (key == "imDir") info.im_dir = value;
+        else if (key == "imExt") info.im_ext = value;
+        else if (key == "seqLength") info.length = std::atoi(value.c_str());
+        else if (key == "frameRate" && std::atof(value.c_str()) > 0.0) info.frame_rate = std::atof(value.c_str());
+    }
+    return info;
+}
+
+static SeqResult run_sequence(const fs::path& seq_dir, const Options& opt) {
+    SeqInfo info = read_seqinfo(seq_dir);
+    MotSequence dets = LoadMotFile((seq_dir / "det" / "det.txt").string());
+    MotSequence gt;
+    const fs::path gt_path = seq_dir / "gt" / "gt.txt";
+    SeqResult r;
+    r.name = info.name;
+    r.has_gt = fs::exists(gt_path);
+    if (r.has_gt) gt = LoadMotFile(gt_path.string());
+
+    const int num_frames = info.length > 0 ? info.length
+                                           : static_cast<int>(std::max(dets.size(), gt.size())) - 1;
+    DeepSortTracker<> tracker(opt.reid_model_path, 0.7f, opt.max_age, opt.n_init, 0.2f, opt.assignment,
+                            GalleryConfig(), true, opt.high_score);
+    tracker.setFrameInterval(1.0 / info.frame_rate);
+    tracker.setKeyframeConfig(opt.keyframe);
+    const bool need_images = !tracker.sortMode() || opt.keyframe.detect_interval > 1;
+
+    MotSequence results(num_frames + 1);
+    std::vector<detect_result> frame_dets;
+    std::vector<TrackOutput> outputs;
+    cv::Mat image;
+    for (int f = 1; f <= num_frames; f += opt.frame_step) {
+        frame_dets.clear();
+        if (static_cast<size_t>(f) < dets.size()) {
+            for (const MotEntry& e : dets[f]) {
+                if (e.score < opt.min_score) continue;
+                detect_result d;
+                // detect_result 为整数像素框，四舍五入
+                d.box = cv::Rect(cvRound(e.box.x), cvRound(e.box.y), cvRound(e.box.width), cvRound(e.box.height));
+                d.classId = 0;
+                d.confidence = e.score;
+                frame_dets.push_back(d);
+            }
+        }
+
+        if (need_images) {
+            auto t0 = std::chrono::high_resolution_clock::now();
+            char name[32];
+            std::snprintf(name, sizeof(name), "%06d", f);
+            image = cv::imread((seq_dir / info.im_dir / (name + info.im_ext)).string());
+            if (image.empty()) {
+                throw std::runtime_error("Failed to read image for frame " + std::to_string(f) + " of " + info.name);
+            }
+            r.read_ms += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - t0).count();
+        }
+
+        auto t0 = std::chrono::high_resolution_clock::now();
+        const double timestamp = opt.timestamps ? (f - 1) / info.frame_rate : DeepSortTracker<>::kNoTimestamp;
+        const bool keyframe = tracker.needsDetection();
+        if (keyframe) tracker.update(image, frame_dets, outputs, timestamp);
+        else tracker.propagate(image, outputs, timestamp);
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - t0).count();
+        r.track_ms += ms;
+        (keyframe ? r.keyframe_ms : r.interframe_ms) += ms;
+
+        const StageTimings& t = tracker.lastTimings();
+        for (int s = 0; s < static_cast<int>(TrackerStage::Count); ++s) r.stage_sum.ms[s] += t.ms[s];
+        r.stage_sum.total_ms += t.total_ms;
+        r.frames++;
+        if (keyframe) r.detections += frame_dets.size();
+
+        for (const TrackOutput& o : outputs) {
+            MotEntry e;
+            e.id = o.id;
+            e.box = o.box;
+            results[f].push_back(e);
+        }
+    }
+
+    r.keyframe_stats = tracker.keyframeStats();
+
+    fs::create_directories(opt.out_dir);
+    SaveMotFile((fs::path(opt.out_dir) / (info.name + ".txt")).string(), results);
+
+    if (r.has_gt) {
+        // 抽帧时只在处理过的帧上评测
+        MotSequence gt_eval(num_frames + 1);
+        for (int f = 1; f <= num_frames && static_cast<size_t>(f) < gt.size(); f += opt.frame_step) gt_eval[f] = gt[f];
+        MotEvaluator evaluator(opt.mot_rules);
+        evaluator.addSequence(gt_eval, results);
+        r.metrics = evaluator.compute();
+    }
+    return r;
+}
+
+static void print_metrics_row(const std::string& name, size_t frames, double track_ms, bool has_gt,
+                              const MotSummary& m) {
+    std::cout << std::left << std::setw(18) << name << std::right << std::setw(7) << frames;
+    if (has_gt) {
+        std::cout << std::fixed << std::setprecision(1)
+                  << std::setw(8) << 100.0 * m.mota() << std::setw(8) << 100.0 * m.idf1()
+                  << std::setw(8) << 100.0 * m.hota() << std::setw(8) << 100.0 * m.detA()
+                  << std::setw(8) << 100.0 * m.assA() << std::setw(8) << 100.0 * m.motp()
+                  << std::setw(6) << m.mostly_tracked << std::setw(6) << m.mostly_lost
+                  << std::setw(7) << m.idsw << std::setw(8) << m.fp << std::setw(8) << m.fn;
+    } else {
+        std::cout << std::setw(8) << "-" << std::setw(8) << "-" << std::setw(8) << "-" << std::setw(8) << "-"
+                  << std::setw(8) << "-" << std::setw(8) << "-" << std::setw(6) << "-" << std::setw(6) << "-"
+                  << std::setw(7) << "-" << std::setw(8) << "-" << std::setw(8) << "-";
+    }
+    std::cout << std::fixed << std::setprecision(1) << std::setw(10) << frames * 1000.0 / std::max(track_ms, 1e-9)
+              << "\n" << std::defaultfloat;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " <seq_or_root> [--reid osnet.mnn] [--out mot_results]"
+                  << " [--high-score 0.5] [--min-score -inf] [--max-age 30] [--n-init 3] [--greedy] [--no-rules]"
+                  << " [--frame-step 1] [--no-timestamps] [--detect-interval 1] [--flow-scale 0.5]\n";
+        return 1;
+    }
+    Options opt;
+    for (int a = 2; a < argc; ++a) {
+        std::string arg = argv[a];
+        const char* next = a + 1 < argc ? argv[a + 1] : "";
+        if (arg == "--reid") { opt.reid_model_path = next; ++a; }
+        else if (arg == "--out") { opt.out_dir = next; ++a; }
+        else if (arg == "--high-score") { opt.high_score = std::stof(next); ++a; }
+        else if (arg == "--min-score") { opt.min_score = std::stof(next); ++a; }
+        else if (arg == "--max-age") { opt.max_age = std::atoi(next); ++a; }
+        else if (arg == "--n-init") { opt.n_init = std::atoi(next); ++a; }
+        else if (arg == "--greedy") opt.assignment = AssignmentMode::Greedy;
+        else if (arg == "--no-rules") opt.mot_rules = false;
+        else if (arg == "--frame-step") { opt.frame_step = std::max(1, std::atoi(next)); ++a; }
+        else if (arg == "--no-timestamps") opt.timestamps = false;
+        else if (arg == "--detect-interval") { opt.keyframe.detect_interval = std::max(1, std::atoi(next)); ++a; }
+        else if (arg == "--flow-scale") { opt.keyframe.flow_scale = std::stof(next); ++a; }
+        else {
+            std::cerr << "unknown option: " << arg << "\n";
+            return 1;
+        }
+    }
+
+    // 单个序列，或其下所有含 det/det.txt 的子目录
+    const fs::path root = argv[1];
+    std::vector<fs::path> seqs;
+    if (fs::exists(root / "det" / "det.txt")) {
+        seqs.push_back(root);
+    } else if (fs::is_directory(root)) {
+        for (const auto& entry : fs::directory_iterator(root)) {
+            if (entry.is_directory() && fs::exists(entry.path() / "det" / "det.txt")) seqs.push_back(entry.path());
+        }
+        std::sort(seqs.begin(), seqs.end());
+    }
+    if (seqs.empty()) {
+        std::cerr << "No MOT sequence (det/det.txt) found under " << root << "\n";
+        return 1;
+    }
+
+    std::vector<SeqResult> results;
+    for (const fs::path& seq : seqs) {
+        std::cout << "跟踪 " << seq.filename().string() << " ..." << std::endl;
+        results.push_back(run_sequence(seq, opt));
+    }
+
+    std::cout << "\n=== " << (opt.reid_model_path.empty() ? "SORT" : "DeepSORT");
+    if (opt.frame_step > 1) {
+        std::cout << "，每 " << opt.frame_step << " 帧处理 1 帧（" << (opt.timestamps ? "按时间戳外推" : "不传时间戳") << "）";
+    }
+    if (opt.keyframe.detect_interval > 1) {
+        std::cout << "，每 " << opt.keyframe.detect_interval << " 帧检测 1 次（光流插帧，缩放 "
+                  << opt.keyframe.flow_scale << "）";
+    }
+    std::cout << "，结果写入 " << opt.out_dir << "/ ===\n";
+    std::cout << std::left << std::setw(18) << "序列" << std::right << std::setw(7) << "帧数"
+              << std::setw(8) << "MOTA" << std::setw(8) << "IDF1" << std::setw(8) << "HOTA"
+              << std::setw(8) << "DetA" << std::setw(8) << "AssA" << std::setw(8) << "MOTP"
+              << std::setw(6) << "MT" << std::setw(6) << "ML" << std::setw(7) << "IDSW"
+              << std::setw(8) << "FP" << std::setw(8) << "FN" << std::setw(10) << "FPS" << "\n";
+    MotSummary combined;
+    size_t total_frames = 0;
+    double total_ms = 0.0;
+    bool any_gt = false;
+    for (const SeqResult& r : results) {
+        print_metrics_row(r.name, r.frames, r.track_ms, r.has_gt, r.metrics);
+        if (r.has_gt) {
+            combined += r.metrics;
+            any_gt = true;
+        }
+        total_frames += r.frames;
+        total_ms += r.track_ms;
+    }
+    if (results.size() > 1) {
+        print_metrics_row("合计", total_frames, total_ms, any_gt, combined);
+    }
+
+    // 各阶段耗时（ms/帧）
+    std::cout << "\n各阶段耗时 ms/帧（FPS 只计 update()，读图单列）\n";
+    std::cout << std::left << std::setw(18) << "序列" << std::right << std::setw(9) << "检测/帧";
+    for (int s = 0; s < static_cast<int>(TrackerStage::Count); ++s) {
+        std::cout << std::setw(12) << StageTimings::name(static_cast<TrackerStage>(s));
+    }
+    std::cout << std::setw(10) << "total" << std::setw(10) << "读图" << "\n";
+    for (const SeqResult& r : results) {
+        const double n = std::max<size_t>(r.frames, 1);
+        std::cout << std::left << std::setw(18) << r.name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(9) << r.detections / n << std::setprecision(3);
+        for (int s = 0; s < static_cast<int>(TrackerStage::Count); ++s) std::cout << std::setw(12) << r.stage_sum.ms[s] / n;
+        std::cout << std::setw(10) << r.stage_sum.total_ms / n << std::setw(10) << r.read_ms / n << "\n"
+                  << std::defaultfloat;
+    }
+
+    // 关键帧 / 插帧：检测帧占比即检测器（与 ReID）调用量的占比
+    if (opt.keyframe.detect_interval > 1) {
+        std::cout << "\n关键帧 / 插帧\n";
+        std::cout << std::left << std::setw(18) << "序列" << std::right << std::setw(9) << "关键帧"
+                  << std::setw(9) << "强制" << std::setw(9) << "插帧" << std::setw(11) << "检测占比"
+                  << std::setw(14) << "关键帧 ms" << std::setw(12) << "插帧 ms"
+                  << std::setw(10) << "光流采用" << std::setw(10) << "失败" << std::setw(10) << "漂移" << "\n";
+        for (const SeqResult& r : results) {
+            const KeyframeStats& k = r.keyframe_stats;
+            std::cout << std::left << std::setw(18) << r.name << std::right << std::setw(9) << k.keyframes
+                      << std::setw(9) << k.forced_keyframes << std::setw(9) << k.interframes
+                      << std::fixed << std::setprecision(1)
+                      << std::setw(10) << 100.0 * k.keyframes / std::max<size_t>(r.frames, 1) << "%"
+                      << std::setprecision(3)
+                      << std::setw(14) << r.keyframe_ms / std::max<size_t>(k.keyframes, 1)
+                      << std::setw(12) << r.interframe_ms / std::max<size_t>(k.interframes, 1)
+                      << std::setw(10) << k.flow_tracked << std::setw(10) << k.flow_failed
+                      << std::setw(10) << k.flow_drifted << "\n" << std::defaultfloat;
+        }
+    }
+    return 0;
+}
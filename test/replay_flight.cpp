@@ -0,0 +1,123 @@
+#include "tracker/DeepSortTracker.h"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <numeric>
+#include <sstream>
+#include <cstdlib>
+
+// ==================== 飞行记录回放工具 ====================
+// 读入 FlightRecorder 的转储（.fdr），从记录起点的快照恢复跟踪器，逐帧回放 repeat 遍：
+//   - 检查回放的匹配决策与记录一致（确定性）
+//   - 每帧取 repeat 遍中最短的耗时作为回放耗时，与记录时的耗时按阶段对比
+//   - 列出记录中最慢的几帧：回放也慢说明是数据（目标数、拥挤程度）导致的，
+//     回放不慢则多半是记录时的环境（ReID 推理、CPU 争用）导致的
+// 用法：replay_flight <dump.fdr> [repeat=5]
+
+static const int kStages = static_cast<int>(TrackerStage::Count);
+
+static bool same_matches(const std::vector<FlightMatch>& a, const std::vector<FlightMatch>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t k = 0; k < a.size(); ++k) {
+        if (a[k].track_id != b[k].track_id || a[k].det != b[k].det) return false;
+    }
+    return true;
+}
+
+static void print_header() {
+    std::cout << std::setw(10) << "帧" << std::setw(8) << "检测";
+    for (int s = 0; s < kStages; ++s) std::cout << std::setw(14) << StageTimings::name(static_cast<TrackerStage>(s));
+    std::cout << std::setw(16) << "total" << "\n";
+}
+
+// 每个阶段输出 “记录/回放” 两个值（ms）
+static void print_row(const std::string& label, size_t dets, const StageTimings& rec, const StageTimings& rep) {
+    std::cout << std::setw(10) << label << std::setw(8) << dets << std::fixed << std::setprecision(2);
+    for (int s = 0; s < kStages; ++s) {
+        std::ostringstream cell;
+        cell << std::fixed << std::setprecision(2) << rec.ms[s] << "/" << rep.ms[s];
+        std::cout << std::setw(14) << cell.str();
+    }
+    std::ostringstream cell;
+    cell << std::fixed << std::setprecision(2) << rec.total_ms << "/" << rep.total_ms;
+    std::cout << std::setw(16) << cell.str() << "\n" << std::defaultfloat;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " <dump.fdr> [repeat=5]\n";
+        return 1;
+    }
+    const int repeat = argc > 2 ? std::max(1, std::atoi(argv[2])) : 5;
+
+    FlightRecord record = FlightRecorder::load(argv[1]);
+    const size_t n = record.frames.size();
+    std::cout << "=== " << argv[1] << " ===\n"
+              << "帧 " << (n ? record.frames.front().frame_index : 0) << " ~ " << record.trigger_frame
+              << "（" << n << " 帧），" << (record.with_reid ? "DeepSORT" : "SORT")
+              << "，触发帧耗时 " << record.trigger_ms << " ms，快照 " << record.checkpoint.size() / 1024 << " KB\n";
+    if (n == 0) return 0;
+
+    // 回放 repeat 遍，每帧保留最短耗时；第一遍检查匹配决策
+    std::vector<StageTimings> best(n);
+    size_t mismatches = 0;
+    DeepSortTracker<> tracker("");
+    FlightRecorderConfig cfg;
+    cfg.capacity_frames = n;
+    auto recorder = std::make_shared<FlightRecorder>(cfg);
+    std::vector<TrackOutput> outputs;
+    for (int r = 0; r < repeat; ++r) {
+        tracker.restore(record.checkpoint.data(), record.checkpoint.size());
+        tracker.setFlightRecorder(r == 0 ? recorder : nullptr);
+        for (size_t k = 0; k < n; ++k) {
+            tracker.replay(record.frames[k], record.with_reid, outputs);
+            const StageTimings& t = tracker.lastTimings();
+            if (r == 0) {
+                best[k] = t;
+                const FlightFrame& got = recorder->frame(recorder->size() - 1);
+                if (!same_matches(got.matches, record.frames[k].matches) ||
+                    !same_matches(got.low_matches, record.frames[k].low_matches)) {
+                    mismatches++;
+                }
+            } else if (t.total_ms < best[k].total_ms) {
+                best[k] = t;
+            }
+        }
+    }
+    std::cout << "匹配决策：" << (mismatches == 0 ? "全部一致" : std::to_string(mismatches) + " 帧不一致") << "\n\n";
+
+    // 逐阶段均值
+    StageTimings rec_mean, rep_mean;
+    for (size_t k = 0; k < n; ++k) {
+        for (int s = 0; s < kStages; ++s) {
+            rec_mean.ms[s] += record.frames[k].timings.ms[s] / n;
+            rep_mean.ms[s] += best[k].ms[s] / n;
+        }
+        rec_mean.total_ms += record.frames[k].timings.total_ms / n;
+        rep_mean.total_ms += best[k].total_ms / n;
+    }
+    size_t dets = 0;
+    for (const auto& f : record.frames) dets += f.detections.size() + f.low_detections.size();
+
+    std::cout << "各阶段耗时 ms（记录/回放，回放取 " << repeat << " 遍最短）\n";
+    print_header();
+    print_row("均值", dets / n, rec_mean, rep_mean);
+
+    // 记录中最慢的帧
+    std::vector<size_t> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&record](size_t a, size_t b) {
+        return record.frames[a].timings.total_ms > record.frames[b].timings.total_ms;
+    });
+    const size_t top = std::min<size_t>(n, 5);
+    for (size_t t = 0; t < top; ++t) {
+        const FlightFrame& f = record.frames[order[t]];
+        std::string label = std::to_string(f.frame_index);
+        if (f.frame_index == record.trigger_frame) label += "*";
+        print_row(label, f.detections.size() + f.low_detections.size(), f.timings, best[order[t]]);
+    }
+    std::cout << "（* 为触发转储的帧）\n";
+    return mismatches == 0 ? 0 : 2;
+}
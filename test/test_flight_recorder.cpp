@@ -0,0 +1,301 @@
+#include "tracker/DeepSortTracker.h"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <cassert>
+#include <cstdio>
+
+// ==================== 飞行记录仪测试 ====================
+// 1. SORT：跑一段后按需转储，读回后从快照回放，每帧的匹配决策、最终输出与原跟踪器一致
+// 2. DeepSORT：带合成 ReID 特征的记录（回放模式驱动），转储后再回放，匹配决策一致
+// 3. 耗时尖峰：阈值极小时每帧都超限，自动转储后冷却半个窗口
+// 4. 开销：有无记录仪的每帧耗时与 Record 阶段最慢一帧（SORT 200 个目标；DeepSORT 100 个目标，特征库填满）
+
+static const size_t kDim = 64;
+static const size_t kReidDim = 512;   // 开销测试用真实 ReID 模型的特征维度（OSNet）
+
+struct Scene {
+    std::vector<std::vector<detect_result>> frames;
+    std::vector<std::vector<int>> owners;     // 每帧每个检测对应的目标
+};
+
+static Scene make_scene(int n, int num_frames, std::mt19937& rng) {
+    std::uniform_real_distribution<float> px(0.0f, 1800.0f), py(0.0f, 900.0f), v(-4.0f, 4.0f);
+    std::normal_distribution<float> noise(0.0f, 1.0f);
+    std::vector<cv::Point2f> pos(n), vel(n);
+    for (int i = 0; i < n; ++i) {
+        pos[i] = cv::Point2f(px(rng), py(rng));
+        vel[i] = cv::Point2f(v(rng), v(rng) * 0.5f);
+    }
+    Scene s;
+    s.frames.resize(num_frames);
+    s.owners.resize(num_frames);
+    for (int f = 0; f < num_frames; ++f) {
+        for (int i = 0; i < n; ++i) {
+            pos[i] += vel[i];
+            if ((f + i) % 13 == 0) continue;
+            detect_result det;
+            det.box = cv::Rect(static_cast<int>(pos[i].x + noise(rng)), static_cast<int>(pos[i].y + noise(rng)), 60, 120);
+            det.classId = 0;
+            det.confidence = (f + i) % 7 == 0 ? 0.3f : 0.9f;   // 部分低分检测走第二阶段
+            s.frames[f].push_back(det);
+            s.owners[f].push_back(i);
+        }
+    }
+    return s;
+}
+
+static bool same_matches(const std::vector<FlightMatch>& a, const std::vector<FlightMatch>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t k = 0; k < a.size(); ++k) {
+        if (a[k].track_id != b[k].track_id || a[k].det != b[k].det) return false;
+    }
+    return true;
+}
+
+static bool same_outputs(const std::vector<TrackOutput>& a, const std::vector<TrackOutput>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].id != b[i].id || a[i].box != b[i].box || a[i].state != b[i].state || a[i].age != b[i].age) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 从 record 的快照恢复新跟踪器并逐帧回放，检查匹配决策与记录一致；返回最后一帧的输出
+static std::vector<TrackOutput> replay_and_check(const FlightRecord& record) {
+    DeepSortTracker<> tracker("");
+    tracker.restore(record.checkpoint.data(), record.checkpoint.size());
+    FlightRecorderConfig cfg;
+    cfg.capacity_frames = record.frames.size();
+    auto recorder = std::make_shared<FlightRecorder>(cfg);
+    tracker.setFlightRecorder(recorder);
+
+    std::vector<TrackOutput> out;
+    for (size_t k = 0; k < record.frames.size(); ++k) {
+        tracker.replay(record.frames[k], record.with_reid, out);
+        const FlightFrame& got = recorder->frame(recorder->size() - 1);
+        assert(got.frame_index == record.frames[k].frame_index);
+        assert(same_matches(got.matches, record.frames[k].matches));
+        assert(same_matches(got.low_matches, record.frames[k].low_matches));
+        assert(got.feature_dets == record.frames[k].feature_dets);
+    }
+    return out;
+}
+
+int main() {
+    std::mt19937 rng(18);
+    auto scene = make_scene(60, 200, rng);
+    const std::string path = "test_flight.fdr";
+
+    // ---------- 1. SORT ----------
+    std::cout << "=== SORT：转储与回放 ===\n";
+    {
+        FlightRecorderConfig cfg;
+        cfg.capacity_frames = 60;
+        auto recorder = std::make_shared<FlightRecorder>(cfg);
+        DeepSortTracker<> a("");
+        a.setFlightRecorder(recorder);
+        std::vector<TrackOutput> out;
+        for (const auto& dets : scene.frames) a.update(cv::Mat(), dets, out);
+        assert(recorder->size() == 60);
+
+        size_t n = recorder->dump(path);
+        FlightRecord record = FlightRecorder::load(path);
+        std::remove(path.c_str());
+        assert(n >= 30 && n <= 60 && record.frames.size() == n);
+        assert(!record.with_reid && record.trigger_frame == 200);
+        assert(record.frames.back().frame_index == 200);
+
+        size_t low = 0;
+        for (const auto& f : record.frames) low += f.low_matches.size();
+        assert(low > 0);
+
+        std::vector<TrackOutput> replayed = replay_and_check(record);
+        assert(same_outputs(out, replayed));
+        std::cout << "  转储 " << n << " 帧（含 " << low << " 个低分匹配），回放的匹配决策与最终输出一致\n";
+    }
+
+    // ---------- 2. DeepSORT（合成 ReID 特征）----------
+    std::cout << "=== DeepSORT：带特征的记录 ===\n";
+    {
+        // 每个目标一个基准特征，逐帧加噪声
+        std::normal_distribution<float> g(0.0f, 1.0f);
+        std::vector<std::vector<float>> base(60, std::vector<float>(kDim));
+        for (auto& b : base) {
+            for (auto& x : b) x = g(rng);
+            L2Normalize(b);
+        }
+        std::vector<FlightFrame> input(scene.frames.size());
+        for (size_t f = 0; f < scene.frames.size(); ++f) {
+            FlightFrame& fr = input[f];
+            fr.feature_dim = kDim;
+            for (size_t j = 0; j < scene.frames[f].size(); ++j) {
+                const cv::Rect& b = scene.frames[f][j].box;
+                fr.detections.emplace_back(b.x, b.y, b.width, b.height);
+                fr.feature_dets.push_back(static_cast<int32_t>(j));
+                std::vector<float> feat = base[scene.owners[f][j]];
+                for (auto& x : feat) x += 0.1f * g(rng);
+                L2Normalize(feat);
+                fr.features.insert(fr.features.end(), feat.begin(), feat.end());
+            }
+        }
+
+        // Min 度量需要完整特征库的快照才能逐帧复现；EMA 度量用精简快照即可
+        for (GalleryMetric metric : {GalleryMetric::Min, GalleryMetric::EMA}) {
+            FlightRecorderConfig cfg;
+            cfg.capacity_frames = 80;
+            cfg.full_gallery_checkpoints = metric != GalleryMetric::EMA;
+            auto recorder = std::make_shared<FlightRecorder>(cfg);
+            GalleryConfig gallery;
+            gallery.metric = metric;
+            DeepSortTracker<> a("", 0.7f, 30, 3, 0.2f, AssignmentMode::LAPJV, gallery);
+            a.setFlightRecorder(recorder);
+            std::vector<TrackOutput> out;
+            for (const auto& fr : input) a.replay(fr, true, out);
+            assert(a.reidStats().crops_extracted > 0 && a.reidStats().crops_skipped > 0);
+
+            size_t n = recorder->dump(path);
+            FlightRecord record = FlightRecorder::load(path);
+            std::remove(path.c_str());
+            assert(record.with_reid && record.frames.size() == n);
+            size_t feats = 0;
+            for (const auto& f : record.frames) feats += f.feature_dets.size();
+            assert(feats > 0);
+
+            std::vector<TrackOutput> replayed = replay_and_check(record);
+            assert(same_outputs(out, replayed));
+            std::cout << "  " << (cfg.full_gallery_checkpoints ? "Min / 完整快照" : "EMA / 精简快照") << "：转储 "
+                      << n << " 帧（快照 " << record.checkpoint.size() / 1024 << " KB），" << feats
+                      << " 个特征（懒 ReID 跳过了 " << a.reidStats().crops_skipped << " / " << a.reidStats().crops_total
+                      << "），回放一致\n";
+        }
+    }
+
+    // ---------- 3. 耗时尖峰 ----------
+    std::cout << "=== 耗时尖峰自动转储 ===\n";
+    {
+        FlightRecorderConfig cfg;
+        cfg.capacity_frames = 20;
+        cfg.spike_threshold_ms = 1e-6f;     // 每帧都超限
+        cfg.dump_prefix = "test_flight_spike";
+        auto recorder = std::make_shared<FlightRecorder>(cfg);
+        DeepSortTracker<> a("");
+        a.setFlightRecorder(recorder);
+        std::vector<TrackOutput> out;
+        std::vector<std::string> files;
+        for (int f = 0; f < 50; ++f) {
+            a.update(cv::Mat(), scene.frames[f], out);
+            if (files.empty() || recorder->lastDumpPath() != files.back()) files.push_back(recorder->lastDumpPath());
+        }
+        // 第 1 帧触发，之后每 10 帧冷却 + 1 帧触发：1, 12, 23, 34, 45
+        assert(recorder->dumps() == 5 && files.size() == 5);
+        assert(files[1] == "test_flight_spike_12.fdr");
+
+        FlightRecord record = FlightRecorder::load(files.back());
+        assert(record.trigger_frame == 45 && record.trigger_ms > 0.0f);
+        assert(record.frames.back().timings.total_ms == record.trigger_ms);
+        replay_and_check(record);
+        for (const auto& file : files) std::remove(file.c_str());
+        std::cout << "  50 帧触发 " << recorder->dumps() << " 次转储，最后一次从第 "
+                  << record.frames.front().frame_index << " 帧回放一致\n";
+    }
+
+    // ---------- 4. 开销 ----------
+    // 记录仪的开销（含回放起点快照）计入 Record 阶段与 total_ms；报告每帧均值与最慢一帧的 Record 耗时
+    struct Overhead {
+        double ms_per_frame = 0.0;
+        float max_record_ms = 0.0f;
+    };
+    auto report = [](const char* label, const Overhead& off, const Overhead& on, const FlightRecorder& recorder) {
+        std::cout << std::fixed << std::setprecision(3) << "  " << label << "：无记录 " << off.ms_per_frame
+                  << " ms/帧，记录 " << on.ms_per_frame << " ms/帧（" << std::setprecision(1)
+                  << (on.ms_per_frame / off.ms_per_frame - 1.0) * 100.0 << "%），Record 阶段最慢 "
+                  << std::setprecision(3) << on.max_record_ms << " ms，缓冲 + 快照 " << recorder.memoryBytes() / 1024
+                  << " KB\n" << std::defaultfloat;
+    };
+
+    std::cout << "=== 记录开销：SORT（200 个目标，300 帧）===\n";
+    {
+        auto big = make_scene(200, 300, rng);
+        auto run = [&big](std::shared_ptr<FlightRecorder> recorder) {
+            DeepSortTracker<> tracker("");
+            tracker.setFlightRecorder(recorder);
+            std::vector<TrackOutput> out;
+            Overhead o;
+            auto t0 = std::chrono::high_resolution_clock::now();
+            for (const auto& dets : big.frames) {
+                tracker.update(cv::Mat(), dets, out);
+                o.max_record_ms = std::max(o.max_record_ms, tracker.lastTimings()[TrackerStage::Record]);
+            }
+            auto t1 = std::chrono::high_resolution_clock::now();
+            o.ms_per_frame = std::chrono::duration<double, std::milli>(t1 - t0).count() / big.frames.size();
+            return o;
+        };
+        run(nullptr);   // 预热
+        Overhead off = run(nullptr);
+        auto recorder = std::make_shared<FlightRecorder>();
+        Overhead on = run(recorder);
+        report("SORT", off, on, *recorder);
+    }
+
+    // DeepSORT：默认特征库（nn_budget 100）在 300 帧内填满，快照的特征库部分随之增大
+    std::cout << "=== 记录开销：DeepSORT（100 个目标，300 帧，" << kReidDim << " 维特征）===\n";
+    {
+        const int targets = 100;
+        auto big = make_scene(targets, 300, rng);
+        std::normal_distribution<float> g(0.0f, 1.0f);
+        std::vector<std::vector<float>> base(targets, std::vector<float>(kReidDim));
+        for (auto& b : base) {
+            for (auto& x : b) x = g(rng);
+            L2Normalize(b);
+        }
+        std::vector<FlightFrame> input(big.frames.size());
+        for (size_t f = 0; f < big.frames.size(); ++f) {
+            FlightFrame& fr = input[f];
+            fr.feature_dim = kReidDim;
+            for (size_t j = 0; j < big.frames[f].size(); ++j) {
+                const detect_result& det = big.frames[f][j];
+                if (det.confidence < 0.5f) {
+                    fr.low_detections.emplace_back(det.box.x, det.box.y, det.box.width, det.box.height);
+                    continue;
+                }
+                fr.feature_dets.push_back(static_cast<int32_t>(fr.detections.size()));
+                fr.detections.emplace_back(det.box.x, det.box.y, det.box.width, det.box.height);
+                std::vector<float> feat = base[big.owners[f][j]];
+                for (auto& x : feat) x += 0.1f * g(rng);
+                L2Normalize(feat);
+                fr.features.insert(fr.features.end(), feat.begin(), feat.end());
+            }
+        }
+        auto run = [&input](std::shared_ptr<FlightRecorder> recorder) {
+            DeepSortTracker<> tracker("", 0.7f, 30, 3, 0.2f, AssignmentMode::LAPJV, GalleryConfig(), false);
+            tracker.setFlightRecorder(recorder);
+            std::vector<TrackOutput> out;
+            Overhead o;
+            auto t0 = std::chrono::high_resolution_clock::now();
+            for (const auto& fr : input) {
+                tracker.replay(fr, true, out);
+                o.max_record_ms = std::max(o.max_record_ms, tracker.lastTimings()[TrackerStage::Record]);
+            }
+            auto t1 = std::chrono::high_resolution_clock::now();
+            o.ms_per_frame = std::chrono::duration<double, std::milli>(t1 - t0).count() / input.size();
+            return o;
+        };
+        run(nullptr);   // 预热
+        Overhead off = run(nullptr);
+        for (bool full : {false, true}) {
+            FlightRecorderConfig cfg;
+            cfg.full_gallery_checkpoints = full;
+            auto recorder = std::make_shared<FlightRecorder>(cfg);
+            Overhead on = run(recorder);
+            report(full ? "完整特征库快照" : "精简快照（默认）", off, on, *recorder);
+            assert(on.max_record_ms > 0.0f);
+        }
+    }
+
+    return 0;
+}
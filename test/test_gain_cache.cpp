@@ -0,0 +1,424 @@
+#include "tracker/TrackStore.h"
+#include "tracker/TrackerManager.h"
+#include "kalmanfilter/kalman_gain_cache.h"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <cassert>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+// ==================== 稳态增益缓存测试 ====================
+// 1. 表：任意节点预测 m 次的协方差、缓存增益与逐步迭代的 KalmanFilter 一致（匀速与匀加速模型）
+// 2. TrackStore：随机命中 / 丢检（含长遮挡、dt ≠ 1 的帧、删除轨迹）下，开缓存与不开缓存的框、门控投影相差在容差量级，
+//    长期轨迹绝大多数处于缓存中
+// 3. 快照：缓存状态随快照恢复，恢复后继续运行的结果与原对象完全一致；协方差池通道表损坏时拒绝恢复；
+//    恢复到 TrackerManager 的一路时沿用各路共享的表，配置不同时才新建，运动模型不同时拒绝恢复
+// 4. 耗时：稳态下每帧预测 + 更新，完整传播 vs 缓存（无丢检 / 6% 丢检）
+
+static float relative_error(const Eigen::MatrixXf& a, const Eigen::MatrixXf& b) {
+    return (a - b).cwiseAbs().maxCoeff() / std::max(b.cwiseAbs().maxCoeff(), 1e-6f);
+}
+
+// - cov_bound: 协方差相对误差上限（tolerance 的倍数）；gain_bound: 缓存增益更新的均值偏差上限
+template <class Model>
+static void test_table(float cov_bound, float gain_bound) {
+    using Mean = typename KalmanFilter<Model>::Mean;
+    using Covariance = typename KalmanFilter<Model>::Covariance;
+    using Transition = typename KalmanGainCache<Model>::Transition;
+    std::cout << "=== 缓存表（" << Model::kName << "）===\n";
+    GainCacheConfig cfg;
+    cfg.enabled = true;
+    KalmanGainCache<Model> cache(cfg);
+    KalmanFilter<Model> kf;
+    std::cout << "节点数 " << cache.nodeCount() << "，转移数 " << cache.transitionCount() << "，表大小 "
+              << cache.memoryBytes() / 1024 << " KB\n";
+
+    // 出生链：initiate + 首次更新后的协方差即出生节点
+    Mean x;
+    Covariance P;
+    kf.initiate(x, P);
+    kf.update(x, P, Eigen::Vector4f(100.0f, 200.0f, 0.5f, 120.0f));
+    float max_cov_err = 0.0f, max_gain_err = 0.0f;
+    int32_t node = cache.birthNode();
+    int hits = 1;
+    std::mt19937 rng(3);
+    std::normal_distribution<float> noise(0.0f, 1.0f);
+    while (node != cache.steadyNode()) {
+        // 预测 m 次的协方差（表一步算出）
+        Covariance Pm = P;
+        Mean xm = x;
+        for (int m = 1; m <= 5; ++m) {
+            kf.predict(xm, Pm);
+            max_cov_err = std::max(max_cov_err, relative_error(cache.covariance(node, m), Pm));
+        }
+        // 一次预测后命中：缓存增益更新的均值与完整更新一致
+        kf.predict(x, P);
+        const Eigen::Vector4f z = x.template head<4>() + Eigen::Vector4f(noise(rng), noise(rng), 0.01f * noise(rng), noise(rng));
+        const Transition* t = cache.hit(node, 1);
+        assert(t != nullptr);
+        const Mean cached = x + t->Kt.transpose() * (z - x.template head<4>());
+        kf.update(x, P, z);
+        max_gain_err = std::max(max_gain_err, (cached - x).cwiseAbs().maxCoeff());
+        node = t->next;
+        hits++;
+    }
+    // 沿途的节点合并误差不累积：到达稳态节点时真实协方差与稳态相差仍在容差量级
+    const float steady_err = relative_error(cache.covariance(cache.steadyNode(), 0), P);
+    std::cout << "出生链 " << hits << " 次命中后到达稳态节点（与真实协方差相对误差 " << std::scientific
+              << std::setprecision(2) << steady_err << "）\n" << std::defaultfloat;
+    assert(steady_err < 5.0f * cfg.tolerance);
+
+    // 稳态下丢检 k 次后命中（恢复链入口），以及长时间丢检的协方差
+    for (int k : {1, 5, 30}) {
+        Covariance Pk = P;
+        Mean xk = x;
+        for (int m = 0; m <= k; ++m) kf.predict(xk, Pk);
+        max_cov_err = std::max(max_cov_err, relative_error(cache.covariance(cache.steadyNode(), k + 1), Pk));
+        const Eigen::Vector4f z = xk.template head<4>() + Eigen::Vector4f(2.0f, -1.0f, 0.0f, 1.0f);
+        const Transition* t = cache.hit(cache.steadyNode(), k + 1);
+        assert(t != nullptr);
+        const Mean cached = xk + t->Kt.transpose() * (z - xk.template head<4>());
+        kf.update(xk, Pk, z);
+        max_gain_err = std::max(max_gain_err, (cached - xk).cwiseAbs().maxCoeff());
+    }
+    assert(cache.hit(cache.steadyNode(), cfg.max_misses + 2) == nullptr);
+
+    // 随机事件序列：未收敛的节点上也有丢检，沿图走 2000 步，节点合并的误差不随步数累积
+    kf.initiate(x, P);
+    kf.update(x, P, Eigen::Vector4f(100.0f, 200.0f, 0.5f, 120.0f));
+    node = cache.birthNode();
+    std::uniform_real_distribution<float> u(0.0f, 1.0f);
+    int transient_misses = 0;
+    for (int step = 0; step < 2000; ++step) {
+        int m = 1;
+        const int limit = (node == cache.steadyNode()) ? cfg.max_misses : cfg.max_transient_misses;
+        while (m <= limit && u(rng) < 0.3f) ++m;
+        if (node != cache.steadyNode() && m > 1) transient_misses++;
+        for (int k = 0; k < m; ++k) kf.predict(x, P);
+        max_cov_err = std::max(max_cov_err, relative_error(cache.covariance(node, m), P));
+        const Eigen::Vector4f z = x.template head<4>() + Eigen::Vector4f(noise(rng), noise(rng), 0.01f * noise(rng), noise(rng));
+        const Transition* t = cache.hit(node, m);
+        assert(t != nullptr);
+        const Mean cached = x + t->Kt.transpose() * (z - x.template head<4>());
+        kf.update(x, P, z);
+        max_gain_err = std::max(max_gain_err, (cached - x).cwiseAbs().maxCoeff());
+        node = t->next;
+    }
+    assert(transient_misses > 0);
+    if (node != cache.steadyNode()) assert(cache.hit(node, cfg.max_transient_misses + 2) == nullptr);
+    std::cout << std::scientific << std::setprecision(2) << "协方差最大相对误差 " << max_cov_err
+              << "，缓存增益更新的均值最大偏差 " << max_gain_err << "\n" << std::defaultfloat;
+    // 相差 tolerance 以内的协方差并入同一节点，并入误差经多次预测放大，界随 tolerance 放宽
+    assert(max_cov_err < cov_bound * cfg.tolerance && max_gain_err < gain_bound);
+}
+
+// 随机场景：n 条匀速目标，每帧以 p_hit 概率命中，部分目标周期性长时间遮挡
+struct Scene {
+    std::vector<cv::Point2f> pos, vel;
+    std::vector<int> occlusion;   // 剩余遮挡帧数
+};
+
+static Scene make_scene(size_t n, std::mt19937& rng) {
+    std::uniform_real_distribution<float> px(0.0f, 1800.0f), py(0.0f, 900.0f), v(-3.0f, 3.0f);
+    Scene s;
+    for (size_t i = 0; i < n; ++i) {
+        s.pos.emplace_back(px(rng), py(rng));
+        s.vel.emplace_back(v(rng), v(rng) * 0.5f);
+    }
+    s.occlusion.assign(n, 0);
+    return s;
+}
+
+// 推进一帧，返回本帧的匹配（轨迹下标即目标下标）与检测
+// - miss_rate: 单帧丢检概率；其中约 1/12 开始一段长遮挡
+static void step(Scene& s, std::mt19937& rng, std::vector<std::pair<size_t, size_t>>& matches,
+                 std::vector<cv::Rect_<float>>& dets, float miss_rate = 0.06f) {
+    std::uniform_real_distribution<float> u(0.0f, 1.0f);
+    std::normal_distribution<float> noise(0.0f, 1.0f);
+    matches.clear();
+    dets.clear();
+    for (size_t i = 0; i < s.pos.size(); ++i) {
+        s.pos[i] += s.vel[i];
+        if (s.occlusion[i] > 0) {
+            s.occlusion[i]--;
+            continue;
+        }
+        const float r = u(rng);
+        if (r < miss_rate / 12.0f) s.occlusion[i] = 5 + static_cast<int>(u(rng) * 40.0f);   // 长遮挡（可超过 max_misses）
+        if (r < miss_rate) continue;                                                      // 单帧丢检
+        matches.emplace_back(i, dets.size());
+        dets.emplace_back(s.pos[i].x + noise(rng), s.pos[i].y + noise(rng), 60.0f, 120.0f);
+    }
+}
+
+// - horizon: 只比较连续丢检不超过此帧数的轨迹；box_bound: 前 100 帧之后的框偏差上限（像素）
+template <class Model>
+static void test_store(int horizon, float box_bound) {
+    std::cout << "\n=== TrackStore：缓存 vs 完整传播（" << Model::kName << "）===\n";
+    std::mt19937 rng(11);
+    size_t n = 300;
+    Scene scene = make_scene(n, rng);
+
+    GainCacheConfig cfg;
+    cfg.enabled = true;
+    TrackStore<Model> full, cached;
+    cached.setGainCache(cfg);
+    for (size_t i = 0; i < n; ++i) {
+        const cv::Rect_<float> box(scene.pos[i].x, scene.pos[i].y, 60.0f, 120.0f);
+        full.add(static_cast<int>(i), box, nullptr, 0);
+        cached.add(static_cast<int>(i), box, nullptr, 0);
+    }
+
+    std::vector<std::pair<size_t, size_t>> matches;
+    std::vector<cv::Rect_<float>> dets;
+    // 出生后最初几次更新中 P 的速度块为 init_P 量级、R 为 r² 量级（相差约 4e5 倍），D' = D - C S^{-1} B 严重相消，
+    // 两条路径（SIMD 批量 / Eigen 逐条）的舍入不同，早期速度估计会相差约 1%；滤波器稳定后这部分差异随之衰减。
+    // 因此框偏差分两段统计：前 100 帧只做宽松检查，之后按缓存容差量级检查
+    float early_box_err = 0.0f, max_box_err = 0.0f, max_S_err = 0.0f;
+    size_t cached_sum = 0;
+    const int frames = 400;
+    for (int f = 0; f < frames; ++f) {
+        // 第 200 帧模拟一次丢帧（dt = 2）：全部退出缓存，之后重新收敛进入
+        const float dt = (f == 200) ? 2.0f : 1.0f;
+        step(scene, rng, matches, dets);
+        full.predictAll(dt);
+        cached.predictAll(dt);
+        if (f == 200) assert(cached.cachedCount() == 0);
+        for (size_t i = 0; i < n; ++i) {
+            if (full.timeSinceUpdate(i) - 1 > horizon) continue;
+            Eigen::Vector4f m_full, m_cached;
+            Eigen::Matrix4f S_full, S_cached;
+            full.project(i, m_full, S_full);
+            cached.project(i, m_cached, S_cached);
+            max_S_err = std::max(max_S_err, relative_error(S_cached, S_full));
+        }
+        const std::vector<std::vector<float>> features(dets.size());
+        full.update(matches, dets, features);
+        cached.update(matches, dets, features);
+        for (size_t i = 0; i < n; ++i) {
+            if (full.timeSinceUpdate(i) > horizon) continue;
+            const cv::Rect_<float>& a = full.box(i);
+            const cv::Rect_<float>& b = cached.box(i);
+            float& err = (f < 100) ? early_box_err : max_box_err;
+            err = std::max({err, std::abs(a.x - b.x), std::abs(a.y - b.y),
+                            std::abs(a.width - b.width), std::abs(a.height - b.height)});
+        }
+        if (f >= 300) cached_sum += cached.cachedCount();
+        // 第 250 帧删除每 7 条中的一条：协方差池归还通道，其余轨迹的下标前移
+        if (f == 250) {
+            std::vector<bool> keep(n);
+            size_t out = 0;
+            for (size_t i = 0; i < n; ++i) {
+                keep[i] = i % 7 != 3;
+                if (!keep[i]) continue;
+                scene.pos[out] = scene.pos[i];
+                scene.vel[out] = scene.vel[i];
+                scene.occlusion[out] = scene.occlusion[i];
+                ++out;
+            }
+            full.compact(keep);
+            cached.compact(keep);
+            n = out;
+            scene.pos.resize(n);
+            scene.vel.resize(n);
+            scene.occlusion.resize(n);
+        }
+    }
+    const double cached_ratio = static_cast<double>(cached_sum) / (100.0 * n);
+    std::cout << std::fixed << std::setprecision(4) << "框最大偏差 " << max_box_err << " 像素（前 100 帧 "
+              << early_box_err << "），门控 S 最大相对误差 "
+              << std::scientific << std::setprecision(2) << max_S_err << std::fixed << std::setprecision(1)
+              << "\n最后 100 帧处于缓存中的轨迹占比 " << 100.0 * cached_ratio << "%\n" << std::defaultfloat;
+    assert(early_box_err < 1.0f && max_box_err < box_bound && max_S_err < 1e-2f);
+    assert(cached_ratio > 0.6);
+}
+
+static void test_snapshot() {
+    std::cout << "\n=== 快照 ===\n";
+    std::mt19937 rng(5);
+    const size_t n = 100;
+    Scene scene = make_scene(n, rng);
+    GainCacheConfig cfg;
+    cfg.enabled = true;
+    TrackStore<> a;
+    a.setGainCache(cfg);
+    for (size_t i = 0; i < n; ++i) a.add(static_cast<int>(i), cv::Rect_<float>(scene.pos[i].x, scene.pos[i].y, 60.0f, 120.0f), nullptr, 0);
+
+    std::vector<std::pair<size_t, size_t>> matches;
+    std::vector<cv::Rect_<float>> dets;
+    for (int f = 0; f < 80; ++f) {
+        step(scene, rng, matches, dets);
+        a.predictAll();
+        a.update(matches, dets, std::vector<std::vector<float>>(dets.size()));
+    }
+    SnapshotWriter writer;
+    a.saveState(writer);
+    std::vector<char> buf;
+    writer.finish(buf);
+    TrackStore<> b;   // 未开缓存：配置随快照恢复
+    b.loadState(SnapshotReader(buf.data(), buf.size()));
+    assert(b.gainCacheConfig() == a.gainCacheConfig() && b.cachedCount() == a.cachedCount());
+
+    for (int f = 0; f < 80; ++f) {
+        step(scene, rng, matches, dets);
+        const std::vector<std::vector<float>> features(dets.size());
+        a.predictAll();
+        b.predictAll();
+        a.update(matches, dets, features);
+        b.update(matches, dets, features);
+        for (size_t i = 0; i < n; ++i) {
+            assert(a.box(i) == b.box(i) && a.mean(i) == b.mean(i) && a.covariance(i) == b.covariance(i));
+        }
+    }
+    std::cout << "恢复后继续 80 帧，输出完全一致（缓存中 " << a.cachedCount() << " / " << n << "）\n";
+
+    // 协方差池通道表：缓存中的轨迹也占了通道（与池中某条轨迹重复）时拒绝恢复
+    const SnapshotHeader* header = reinterpret_cast<const SnapshotHeader*>(buf.data());
+    const SnapshotSection* sections = reinterpret_cast<const SnapshotSection*>(buf.data() + sizeof(SnapshotHeader));
+    int32_t* lanes = nullptr;
+    for (uint32_t s = 0; s < header->section_count; ++s) {
+        if (sections[s].tag == SnapshotTag("TKLN")) lanes = reinterpret_cast<int32_t*>(buf.data() + sections[s].offset);
+    }
+    assert(lanes != nullptr);
+    const int32_t* pooled = std::find_if(lanes, lanes + n, [](int32_t lane) { return lane >= 0; });
+    int32_t* cached_lane = std::find(lanes, lanes + n, -1);
+    assert(pooled != lanes + n && cached_lane != lanes + n);
+    *cached_lane = *pooled;
+    bool rejected = false;
+    try {
+        TrackStore<> c;
+        c.loadState(SnapshotReader(buf.data(), buf.size()));
+    } catch (const std::runtime_error&) {
+        rejected = true;
+    }
+    assert(rejected);
+}
+
+template <class Model>
+static void test_manager_restore() {
+    std::cout << "\n=== 快照恢复到 TrackerManager 的一路（" << Model::kName << "）===\n";
+    TrackerParams<Model> params;
+    params.gain_cache.enabled = true;
+    TrackerManager<Model> manager(nullptr, nullptr, params);
+    const int src = manager.addStream();
+    const std::shared_ptr<const KalmanGainCache<Model>> shared = manager.tracker(src).gainCache();
+    assert(shared != nullptr);
+
+    std::mt19937 rng(17);
+    const size_t n = 30;
+    Scene scene = make_scene(n, rng);
+    std::vector<std::pair<size_t, size_t>> matches;
+    std::vector<cv::Rect_<float>> boxes;
+    std::vector<detect_result> dets;
+    std::vector<TrackOutput> outputs;
+    for (int f = 0; f < 60; ++f) {
+        step(scene, rng, matches, boxes);
+        dets.clear();
+        for (const cv::Rect_<float>& b : boxes) {
+            detect_result d;
+            d.box = cv::Rect(cv::Point(static_cast<int>(b.x), static_cast<int>(b.y)), cv::Size(60, 120));
+            d.confidence = 0.9f;
+            d.classId = 0;
+            dets.push_back(d);
+        }
+        manager.track(src, cv::Mat(), dets, outputs);
+    }
+    assert(manager.tracker(src).gainCachedTracks() > 0);
+    std::vector<char> buf;
+    manager.tracker(src).snapshot(buf);
+
+    // 配置相同：恢复后仍是共享的那张表
+    const int dst = manager.addStream();
+    manager.tracker(dst).restore(buf.data(), buf.size());
+    assert(manager.tracker(dst).gainCache() == shared);
+    assert(manager.tracker(dst).gainCachedTracks() == manager.tracker(src).gainCachedTracks());
+
+    // 配置不同（容差不同的独立跟踪器的快照）：按快照配置新建
+    DeepSortTracker<Model> other("");
+    GainCacheConfig cfg = params.gain_cache;
+    cfg.tolerance = 2e-3f;
+    other.setGainCache(cfg);
+    other.snapshot(buf);
+    manager.tracker(dst).restore(buf.data(), buf.size());
+    assert(manager.tracker(dst).gainCache() != shared && manager.tracker(dst).gainCacheConfig() == cfg);
+
+    // 运动模型不同的跟踪器拒绝恢复，状态不变
+    DeepSortTracker<ConstantVelocityXYWH> wrong("");
+    bool rejected = false;
+    try {
+        wrong.restore(buf.data(), buf.size());
+    } catch (const std::runtime_error&) {
+        rejected = true;
+    }
+    assert(rejected && wrong.gainCache() == nullptr);
+    std::cout << "配置相同时沿用共享的表，配置不同时按快照新建，运动模型不同时拒绝恢复\n";
+}
+
+static void bench() {
+    std::cout << "\n=== 耗时（稳态，每帧预测 + 更新）===\n";
+    std::cout << std::setw(8) << "丢检率" << std::setw(8) << "轨迹数" << std::setw(16) << "完整 ns/轨迹"
+              << std::setw(16) << "缓存 ns/轨迹" << std::setw(10) << "加速比" << std::setw(10) << "缓存率"
+              << std::setw(18) << "其中预测 完整/缓存" << "\n";
+    for (float miss_rate : {0.0f, 0.06f}) {
+        for (size_t n : {100, 1000, 10000}) {
+            double ns[2] = {0.0, 0.0}, predict_ns[2] = {0.0, 0.0};
+            size_t in_cache = 0;
+            for (int mode = 0; mode < 2; ++mode) {
+                std::mt19937 rng(23);
+                Scene scene = make_scene(n, rng);
+                TrackStore<> store;
+                GainCacheConfig cfg;
+                cfg.enabled = mode == 1;
+                store.setGainCache(cfg);
+                store.reserve(n);
+                for (size_t i = 0; i < n; ++i) {
+                    store.add(static_cast<int>(i), cv::Rect_<float>(scene.pos[i].x, scene.pos[i].y, 60.0f, 120.0f),
+                              nullptr, 0);
+                }
+                std::vector<std::pair<size_t, size_t>> matches;
+                std::vector<cv::Rect_<float>> dets;
+                std::vector<std::vector<float>> features;
+                const int warmup = 80, frames = 100;
+                double total = 0.0, predict = 0.0;
+                for (int f = 0; f < warmup + frames; ++f) {
+                    step(scene, rng, matches, dets, miss_rate);
+                    features.resize(dets.size());
+                    auto t0 = std::chrono::high_resolution_clock::now();
+                    store.predictAll();
+                    auto t1 = std::chrono::high_resolution_clock::now();
+                    store.update(matches, dets, features);
+                    auto t2 = std::chrono::high_resolution_clock::now();
+                    if (f < warmup) continue;
+                    total += std::chrono::duration<double, std::nano>(t2 - t0).count();
+                    predict += std::chrono::duration<double, std::nano>(t1 - t0).count();
+                }
+                ns[mode] = total / (frames * static_cast<double>(n));
+                predict_ns[mode] = predict / (frames * static_cast<double>(n));
+                if (mode == 1) in_cache = store.cachedCount();
+            }
+            std::cout << std::fixed << std::setprecision(1) << std::setw(7) << 100.0f * miss_rate << "%" << std::setw(8)
+                      << n << std::setw(16) << ns[0] << std::setw(16) << ns[1] << std::setw(9) << ns[0] / ns[1] << "x"
+                      << std::setw(9) << 100.0 * in_cache / n << "%" << std::setw(10) << predict_ns[0] << " / "
+                      << predict_ns[1] << "\n" << std::defaultfloat;
+        }
+    }
+}
+
+int main() {
+    // 匀加速模型的加速度分量远小于协方差的最大元素，按同一绝对容差合并节点时相对误差更大，
+    // 且经 m²/2 的外推放大：表的误差界放宽，长遮挡中的预测框不作比较
+    test_table<ConstantVelocityXYAH>(5.0f, 1e-2f);
+    test_table<ConstantAccelerationXYAH>(10.0f, 0.1f);
+    test_store<ConstantVelocityXYAH>(std::numeric_limits<int>::max(), 0.05f);
+    test_store<ConstantAccelerationXYAH>(5, 0.1f);
+    test_snapshot();
+    test_manager_restore<ConstantVelocityXYAH>();
+    test_manager_restore<ConstantAccelerationXYAH>();
+    bench();
+    std::cout << "\n全部通过\n";
+    return 0;
+}
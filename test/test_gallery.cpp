@@ -0,0 +1,175 @@
+#include "tracker/TrackStore.h"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <cassert>
+
+// ==================== 轨迹外观特征库测试 ====================
+// 1. 环形缓冲：只保留最近 nn_budget 个特征，一帧坏特征不影响 Min 距离
+// 2. 批量距离矩阵与逐对距离一致（Min / Mean / EMA）
+// 3. 内存上限：超限时缩小容量并保留最新特征
+// 4. 规模：1000 条轨迹 x 100 个特征对 100 个检测的距离矩阵耗时
+
+static const size_t kDim = 512;
+
+static std::vector<float> random_unit(std::mt19937& rng) {
+    std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+    std::vector<float> f(kDim);
+    for (auto& x : f) x = dist(rng);
+    L2Normalize(f);
+    return f;
+}
+
+static std::vector<float> perturb(const std::vector<float>& f, float sigma, std::mt19937& rng) {
+    std::normal_distribution<float> noise(0.0f, sigma);
+    std::vector<float> g(f);
+    for (auto& x : g) x = std::max(0.0f, x + noise(rng));
+    L2Normalize(g);
+    return g;
+}
+
+static void check_matrix(TrackStore<>& store, const std::vector<float>& dets, size_t m) {
+    RowMajorMatrixXf mat;
+    store.appearanceDistanceMatrix(dets.data(), m, mat);
+    float max_err = 0.0f;
+    for (size_t i = 0; i < store.size(); ++i) {
+        for (size_t j = 0; j < m; ++j) {
+            max_err = std::max(max_err, std::abs(mat(i, j) - store.appearanceDistance(i, dets.data() + j * kDim)));
+        }
+    }
+    assert(max_err < 1e-4f);
+    std::cout << "  矩阵 vs 逐对最大误差: " << std::scientific << max_err << std::defaultfloat << "\n";
+}
+
+int main() {
+    std::mt19937 rng(3);
+    const cv::Rect_<float> box(100, 100, 50, 100);
+
+    // ---------- 1. 环形缓冲与坏特征 ----------
+    std::cout << "=== 环形缓冲 ===\n";
+    {
+        GalleryConfig cfg;
+        cfg.nn_budget = 5;
+        TrackStore<> store(3, cfg);
+        std::vector<float> person = random_unit(rng);
+        store.add(1, box, person.data(), kDim);
+        for (int k = 0; k < 9; ++k) {
+            std::vector<float> f = perturb(person, 0.02f, rng);
+            store.update(0, box, f.data(), kDim);
+        }
+        assert(store.galleryCount(0) == 5);
+
+        // 一帧遮挡：特征变成另一个人；最新特征被覆盖，但特征库的最小距离仍然很小
+        std::vector<float> occluder = random_unit(rng);
+        store.update(0, box, occluder.data(), kDim);
+        assert(std::equal(occluder.begin(), occluder.end(), store.feature(0)));
+        float d_gallery = store.appearanceDistance(0, person.data());
+        float d_latest = NormalizedCosineDistance(store.feature(0), person.data(), kDim);
+        std::cout << "  遮挡后 Min 距离: " << d_gallery << "（只用最新特征: " << d_latest << "）\n";
+        assert(d_gallery < d_latest);
+
+        // 全零特征（推理失败）不入库
+        std::vector<float> zero(kDim, 0.0f);
+        store.update(0, box, zero.data(), kDim);
+        assert(std::equal(occluder.begin(), occluder.end(), store.feature(0)));
+    }
+
+    // ---------- 2. 批量 vs 逐对 ----------
+    std::cout << "=== 批量距离矩阵 ===\n";
+    for (GalleryMetric metric : {GalleryMetric::Min, GalleryMetric::Mean, GalleryMetric::EMA}) {
+        GalleryConfig cfg;
+        cfg.nn_budget = 8;
+        cfg.metric = metric;
+        TrackStore<> store(3, cfg);
+        for (int t = 0; t < 20; ++t) {
+            std::vector<float> f = random_unit(rng);
+            store.add(t, box, f.data(), kDim);
+            for (int k = 0; k < t % 12; ++k) {
+                std::vector<float> g = perturb(f, 0.05f, rng);
+                store.update(t, box, g.data(), kDim);
+            }
+        }
+        // 删掉一部分轨迹，检查压缩后特征库仍对齐
+        std::vector<bool> keep(store.size());
+        for (size_t i = 0; i < keep.size(); ++i) keep[i] = (i % 3 != 1);
+        store.compact(keep);
+
+        std::vector<float> dets;
+        for (int j = 0; j < 15; ++j) {
+            std::vector<float> f = random_unit(rng);
+            dets.insert(dets.end(), f.begin(), f.end());
+        }
+        check_matrix(store, dets, 15);
+    }
+
+    // ---------- 3. 内存上限 ----------
+    std::cout << "=== 内存上限 ===\n";
+    {
+        GalleryConfig cfg;
+        cfg.nn_budget = 100;
+        cfg.memory_cap_bytes = 64 * 100 * kDim * sizeof(float);   // 可容纳 64 条满容量轨迹
+        TrackStore<> store(3, cfg);
+        std::vector<std::vector<float>> latest;
+        for (int t = 0; t < 200; ++t) {
+            std::vector<float> f = random_unit(rng);
+            store.add(t, box, f.data(), kDim);
+            for (int k = 0; k < 10; ++k) {
+                f = perturb(f, 0.05f, rng);
+                store.update(t, box, f.data(), kDim);
+            }
+            latest.push_back(f);
+        }
+        size_t bytes = store.size() * store.galleryBudget() * kDim * sizeof(float);
+        std::cout << "  200 条轨迹，容量缩为 " << store.galleryBudget()
+                  << "，特征库 " << bytes / 1024 << " KB（上限 " << cfg.memory_cap_bytes / 1024 << " KB）\n";
+        assert(bytes <= cfg.memory_cap_bytes);
+        for (size_t i = 0; i < store.size(); ++i) {
+            assert(std::equal(latest[i].begin(), latest[i].end(), store.feature(i)));
+        }
+
+        // 人群散去：只剩 20 条轨迹后新建轨迹时容量放大回 nn_budget，已有特征保留
+        const int shrunk = store.galleryBudget();
+        std::vector<int> counts(20);
+        for (size_t i = 0; i < 20; ++i) counts[i] = store.galleryCount(i);
+        std::vector<bool> keep(store.size(), false);
+        for (size_t i = 0; i < 20; ++i) keep[i] = true;
+        store.compact(keep);
+        std::vector<float> f = random_unit(rng);
+        store.add(200, box, f.data(), kDim);
+        std::cout << "  轨迹数回落到 " << store.size() << "，容量 " << shrunk << " -> " << store.galleryBudget() << "\n";
+        assert(store.galleryBudget() == cfg.nn_budget);
+        for (size_t i = 0; i < 20; ++i) {
+            assert(store.galleryCount(i) == counts[i]);
+            assert(std::equal(latest[i].begin(), latest[i].end(), store.feature(i)));
+        }
+        assert(store.size() * store.galleryBudget() * kDim * sizeof(float) <= cfg.memory_cap_bytes);
+    }
+
+    // ---------- 4. 规模 ----------
+    std::cout << "=== 1000 条轨迹 x 100 特征 vs 100 检测 ===\n";
+    {
+        TrackStore<> store;
+        std::vector<float> f = random_unit(rng);
+        for (int t = 0; t < 1000; ++t) {
+            store.add(t, box, f.data(), kDim);
+            for (int k = 0; k < 99; ++k) store.update(t, box, f.data(), kDim);
+        }
+        std::vector<float> dets;
+        for (int j = 0; j < 100; ++j) {
+            std::vector<float> g = random_unit(rng);
+            dets.insert(dets.end(), g.begin(), g.end());
+        }
+        RowMajorMatrixXf mat;
+        store.appearanceDistanceMatrix(dets.data(), 100, mat);   // 预热
+        auto t0 = std::chrono::high_resolution_clock::now();
+        store.appearanceDistanceMatrix(dets.data(), 100, mat);
+        auto t1 = std::chrono::high_resolution_clock::now();
+        std::cout << "  特征库 " << store.size() * store.galleryBudget() * kDim * sizeof(float) / (1024 * 1024)
+                  << " MB，距离矩阵 " << std::fixed << std::setprecision(2)
+                  << std::chrono::duration<double, std::milli>(t1 - t0).count() << " ms\n";
+    }
+
+    return 0;
+}
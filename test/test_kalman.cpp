@@ -1,14 +1,413 @@
 #include "kalmanfilter/kalman.h"
+#include "kalmanfilter/kalman_batch.h"
 #include <iostream>
 #include <iomanip>
 #include <vector>
 #include <cassert>
+#include <chrono>
+#include <atomic>
+#include <cstdlib>
+
+// ==================== 堆分配计数 ====================
+// 拦截 malloc（glibc），统计调用次数；Eigen 与 operator new 最终都走 malloc，
+// 用于验证定长滤波器每次 predict/update 不做堆分配
+static std::atomic<long> g_alloc_count{0};
+
+extern "C" void* __libc_malloc(std::size_t size);
+extern "C" void* malloc(std::size_t size) {
+    g_alloc_count++;
+    return __libc_malloc(size);
+}
+
+// ==================== 参考实现：旧版动态矩阵滤波器 ====================
+// 与改造前 kalman.cpp 完全一致（MatrixXf + S.inverse() + Joseph form），用于数值对比和测速
+class LegacyKalmanFilter {
+    public:
+        LegacyKalmanFilter(float q_pos = 1.0f / 20.0f, float q_vel = 1.0f / 160.0f,
+                           float r = 0.05f, float init_P = 1000.0f) {
+            x_ = Eigen::VectorXf::Zero(8);
+            P_ = Eigen::MatrixXf::Identity(8, 8) * init_P;
+            F_ = Eigen::MatrixXf::Identity(8, 8);
+            F_.block<4, 4>(0, 4) = Eigen::MatrixXf::Identity(4, 4);
+            H_ = Eigen::MatrixXf::Zero(4, 8);
+            H_.block<4, 4>(0, 0) = Eigen::MatrixXf::Identity(4, 4);
+            Q_ = Eigen::MatrixXf::Zero(8, 8);
+            Q_.diagonal() << q_pos * q_pos, q_pos * q_pos, q_pos * q_pos, q_pos * q_pos,
+                             q_vel * q_vel, q_vel * q_vel, q_vel * q_vel, q_vel * q_vel;
+            R_ = Eigen::MatrixXf::Identity(4, 4) * (r * r);
+        }
+
+        // 变帧间隔：F 的速度块取 dt·I，Q 按 dt 线性缩放（dt = 1 时即改造前的实现）
+        Eigen::Vector4f predict(float dt = 1.0f) {
+            Eigen::MatrixXf F = F_;
+            F.block<4, 4>(0, 4) *= dt;
+            x_ = F * x_;
+            P_ = F * P_ * F.transpose() + Q_ * dt;
+            return x_.head<4>();
+        }
+
+        void update(const Eigen::Vector4f& z) {
+            Eigen::MatrixXf y = z - H_ * x_;
+            Eigen::MatrixXf S = H_ * P_ * H_.transpose() + R_;
+            Eigen::MatrixXf K = P_ * H_.transpose() * S.inverse();
+            x_ = x_ + K * y;
+            Eigen::MatrixXf I = Eigen::MatrixXf::Identity(8, 8);
+            P_ = (I - K * H_) * P_ * (I - K * H_).transpose();
+            P_ += K * R_ * K.transpose();
+            P_ = (P_ + P_.transpose()) * 0.5f;
+        }
+
+        const Eigen::VectorXf& getState() const { return x_; }
+        const Eigen::MatrixXf& getCovariance() const { return P_; }
+
+    private:
+        Eigen::MatrixXf F_, H_, Q_, R_, P_;
+        Eigen::VectorXf x_;
+};
+
+// 相对误差：||a - b|| / max(||b||, 1)
+static float relative_error(const Eigen::MatrixXf& a, const Eigen::MatrixXf& b) {
+    return (a - b).norm() / std::max(b.norm(), 1.0f);
+}
+
+// ==================== 定长滤波器 vs 旧版：数值一致性 + 速度 ====================
+static void compare_with_legacy() {
+    std::cout << "\n=== 定长 KalmanFilter vs 旧版 MatrixXf 实现 ===\n\n";
+
+    // 构造观测序列：匀速运动 + 噪声，每 7 帧丢一次检测
+    const int steps = 200;
+    std::vector<Eigen::Vector4f> zs(steps);
+    std::vector<bool> has(steps);
+    srand(1234);
+    for (int t = 0; t < steps; ++t) {
+        zs[t] = Eigen::Vector4f(100.0f + 2.0f * t, 200.0f + 1.0f * t, 0.5f, 100.0f);
+        zs[t][0] += (rand() % 10 - 5) * 0.1f;
+        zs[t][1] += (rand() % 10 - 5) * 0.1f;
+        has[t] = (t % 7) != 3;
+    }
+
+    // 1. 数值一致性：逐步对比状态与协方差
+    KalmanFilter<> kf;
+    LegacyKalmanFilter ref;
+    float max_x_err = 0.0f, max_P_err = 0.0f;
+    for (int t = 0; t < steps; ++t) {
+        kf.predict();
+        ref.predict();
+        if (has[t]) {
+            kf.update(zs[t]);
+            ref.update(zs[t]);
+        }
+        max_x_err = std::max(max_x_err, relative_error(kf.getState(), ref.getState()));
+        max_P_err = std::max(max_P_err, relative_error(kf.getCovariance(), ref.getCovariance()));
+    }
+    std::cout << "最大相对误差: 状态 = " << std::scientific << std::setprecision(2) << max_x_err
+              << ", 协方差 = " << max_P_err << "\n";
+    assert(max_x_err < 1e-3f);
+    assert(max_P_err < 1e-2f);
+
+    // 2. 堆分配：定长实现每次调用应为 0
+    KalmanFilter<> kf_alloc;
+    long before = g_alloc_count.load();
+    for (int t = 0; t < steps; ++t) {
+        kf_alloc.predict();
+        if (has[t]) kf_alloc.update(zs[t]);
+    }
+    long fixed_allocs = g_alloc_count.load() - before;
+
+    LegacyKalmanFilter ref_alloc;
+    before = g_alloc_count.load();
+    for (int t = 0; t < steps; ++t) {
+        ref_alloc.predict();
+        if (has[t]) ref_alloc.update(zs[t]);
+    }
+    long legacy_allocs = g_alloc_count.load() - before;
+    std::cout << "堆分配次数（" << steps << " 帧）: 定长 = " << fixed_allocs
+              << ", 旧版 = " << legacy_allocs << "\n";
+    assert(fixed_allocs == 0);
+
+    // 3. 速度：重复跑整条序列
+    const int repeats = 2000;
+    auto run_fixed = [&]() {
+        float sink = 0.0f;
+        for (int r = 0; r < repeats; ++r) {
+            KalmanFilter<> f;
+            for (int t = 0; t < steps; ++t) {
+                f.predict();
+                if (has[t]) f.update(zs[t]);
+            }
+            sink += f.getState()[0];
+        }
+        return sink;
+    };
+    auto run_legacy = [&]() {
+        float sink = 0.0f;
+        for (int r = 0; r < repeats; ++r) {
+            LegacyKalmanFilter f;
+            for (int t = 0; t < steps; ++t) {
+                f.predict();
+                if (has[t]) f.update(zs[t]);
+            }
+            sink += f.getState()[0];
+        }
+        return sink;
+    };
+
+    auto t0 = std::chrono::high_resolution_clock::now();
+    volatile float s1 = run_fixed();
+    auto t1 = std::chrono::high_resolution_clock::now();
+    volatile float s2 = run_legacy();
+    auto t2 = std::chrono::high_resolution_clock::now();
+    (void)s1; (void)s2;
+
+    double fixed_ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+    double legacy_ms = std::chrono::duration<double, std::milli>(t2 - t1).count();
+    double calls = static_cast<double>(repeats) * steps;
+    std::cout << std::fixed << std::setprecision(1)
+              << "定长实现: " << fixed_ms << " ms（" << fixed_ms * 1e6 / calls << " ns/帧）\n"
+              << "旧版实现: " << legacy_ms << " ms（" << legacy_ms * 1e6 / calls << " ns/帧）\n"
+              << std::setprecision(2) << "加速比: " << legacy_ms / fixed_ms << "x\n";
+}
+
+// ==================== 变帧间隔预测 ====================
+// 同一条匀速轨迹分别按 30 fps 逐帧、抽帧（每 3 帧处理 1 帧）和不规则间隔观测：
+// 定长实现、批量实现与稠密参考实现的结果一致，且抽帧后的预测仍贴近真实位置
+static void test_variable_dt() {
+    std::cout << "\n=== 变帧间隔预测 ===\n\n";
+
+    // 单位：标称帧；真实运动为每帧 (2, 1) 像素
+    auto truth = [](float t) { return Eigen::Vector4f(100.0f + 2.0f * t, 200.0f + 1.0f * t, 0.5f, 100.0f); };
+    const std::vector<float> times = {0, 1, 2, 3, 6, 9, 12, 12.5f, 13, 15.75f, 18, 24, 25, 26};
+
+    KalmanFilter<> kf;
+    LegacyKalmanFilter ref;
+    KalmanBatch<> batch;
+    const size_t stride = KalmanBatch<>::kLaneAlign;
+    std::vector<float> mean(8 * stride), cov(64 * stride);
+    for (size_t i = 0; i < stride; ++i) batch.initiate(mean.data(), cov.data(), stride, i);
+
+    float max_x_err = 0.0f, max_P_err = 0.0f, max_batch_err = 0.0f, last_pred_err = 0.0f;
+    for (size_t k = 0; k < times.size(); ++k) {
+        const float dt = k == 0 ? 1.0f : times[k] - times[k - 1];
+        Eigen::Vector4f pred = kf.predict(dt);
+        ref.predict(dt);
+        batch.predict(mean.data(), cov.data(), stride, stride, dt);
+        if (k >= 4) last_pred_err = (pred.head<2>() - truth(times[k]).head<2>()).norm();
+
+        Eigen::Vector4f z = truth(times[k]);
+        kf.update(z);
+        ref.update(z);
+        std::vector<uint32_t> idx(stride);
+        std::vector<float> zs(4 * stride);
+        for (size_t i = 0; i < stride; ++i) {
+            idx[i] = static_cast<uint32_t>(i);
+            for (int c = 0; c < 4; ++c) zs[4 * i + c] = z[c];
+        }
+        batch.update(mean.data(), cov.data(), stride, idx.data(), zs.data(), stride);
+
+        max_x_err = std::max(max_x_err, relative_error(kf.getState(), ref.getState()));
+        max_P_err = std::max(max_P_err, relative_error(kf.getCovariance(), ref.getCovariance()));
+        for (int r = 0; r < 8; ++r) {
+            max_batch_err = std::max(max_batch_err,
+                std::abs(mean[r * stride + stride - 1] - kf.getState()[r]) / std::max(std::abs(kf.getState()[r]), 1.0f));
+        }
+    }
+    std::cout << "最大相对误差: 状态 = " << std::scientific << std::setprecision(2) << max_x_err
+              << ", 协方差 = " << max_P_err << ", 批量 vs 定长 = " << max_batch_err << "\n"
+              << std::fixed << std::setprecision(3) << "抽帧 / 不规则间隔下的预测位置误差: " << last_pred_err << " 像素\n";
+    assert(max_x_err < 1e-3f && max_P_err < 1e-2f && max_batch_err < 1e-4f);
+    assert(last_pred_err < 0.5f);
+
+    // 一次外推 3 帧与逐帧外推 3 次的均值相同，位置方差更小（过程噪声未经速度块放大）
+    KalmanFilter<> a, b;
+    for (int t = 0; t < 5; ++t) {
+        a.predict();
+        b.predict();
+        a.update(truth(static_cast<float>(t)));
+        b.update(truth(static_cast<float>(t)));
+    }
+    a.predict(3.0f);
+    for (int s = 0; s < 3; ++s) b.predict();
+    assert((a.getState() - b.getState()).norm() < 1e-3f);
+    assert(a.getCovariance()(0, 0) <= b.getCovariance()(0, 0));
+    // dt = 0（重复时间戳）：状态不变
+    KalmanMean before = a.getState();
+    a.predict(0.0f);
+    assert((a.getState() - before).norm() == 0.0f);
+    std::cout << "一次外推 3 帧 = 逐帧外推 3 次（均值一致）\n";
+}
+
+// ==================== 编译期运动模型 ====================
+// 对每个模型显式构造稠密的 F / Q / H / R（定长），用教科书公式逐步对比分块展开的实现；
+// 再在匀加速目标上对比匀速与匀加速模型丢检期间的外推误差
+template <class Model>
+static float dense_reference_error(const std::vector<Eigen::Vector4f>& zs, const std::vector<bool>& has) {
+    using KF = KalmanFilter<Model>;
+    constexpr int N = KF::kStateDim, M = KF::kMeasDim;
+    static_assert(KF::Covariance::SizeAtCompileTime == N * N, "协方差必须是定长类型");
+    const typename KF::Params p;
+    KF kf(p);
+
+    Eigen::Matrix<float, N, N> F = Eigen::Matrix<float, N, N>::Identity();
+    for (int b = 1; b * M < N; ++b) {
+        for (int k = 0; k + b * M < N; k += M) {
+            // 第 b 阶导数对 k 块的贡献：1 / b!（dt = 1）
+            F.template block<M, M>(k, k + b * M).diagonal().setConstant(b == 1 ? 1.0f : 0.5f);
+        }
+    }
+    Eigen::Matrix<float, N, N> Q = Model::processNoise(p).asDiagonal();
+    Eigen::Matrix<float, M, M> R = Model::measurementNoise(p).asDiagonal();
+    Eigen::Matrix<float, M, N> H = Eigen::Matrix<float, M, N>::Zero();
+    H.template leftCols<M>().setIdentity();
+    Eigen::Matrix<float, N, 1> x = Eigen::Matrix<float, N, 1>::Zero();
+    Eigen::Matrix<float, N, N> P = Eigen::Matrix<float, N, N>::Identity() * p.init_P;
+
+    float max_err = 0.0f;
+    for (size_t t = 0; t < zs.size(); ++t) {
+        kf.predict();
+        x = F * x;
+        P = F * P * F.transpose() + Q;
+        if (has[t]) {
+            kf.update(zs[t]);
+            Eigen::Matrix<float, M, M> S = H * P * H.transpose() + R;
+            Eigen::Matrix<float, N, M> K = P * H.transpose() * S.inverse();
+            x += K * (zs[t] - H * x);
+            Eigen::Matrix<float, N, N> I_KH = Eigen::Matrix<float, N, N>::Identity() - K * H;
+            P = I_KH * P * I_KH.transpose() + K * R * K.transpose();
+        }
+        max_err = std::max(max_err, relative_error(kf.getState(), x));
+        max_err = std::max(max_err, relative_error(kf.getCovariance(), P));
+    }
+    return max_err;
+}
+
+// 跟踪 boxes（tlwh），每 period 帧中的最后 gap 帧丢检；输出丢检末帧的平均预测位置误差、ns/帧和堆分配次数
+template <class Model>
+static void extrapolation_error(const std::vector<Eigen::Vector4f>& boxes, int period, int gap,
+                                float& mean_err, double& ns_per_frame, long& allocs) {
+    KalmanFilter<Model> kf;
+    float err_sum = 0.0f;
+    int n_err = 0;
+    const long before = g_alloc_count.load();
+    auto t0 = std::chrono::high_resolution_clock::now();
+    for (size_t t = 0; t < boxes.size(); ++t) {
+        const Eigen::Vector4f& b = boxes[t];
+        const Eigen::Vector4f pred = Model::toTlwh(kf.predict());
+        const int phase = static_cast<int>(t) % period;
+        if (t >= static_cast<size_t>(period) && phase == period - 1) {
+            err_sum += (pred.head<2>() - b.head<2>()).norm();
+            n_err++;
+        }
+        if (phase < period - gap) kf.update(Model::fromTlwh(b[0], b[1], b[2], b[3]));
+    }
+    auto t1 = std::chrono::high_resolution_clock::now();
+    allocs = g_alloc_count.load() - before;
+    mean_err = err_sum / std::max(n_err, 1);
+    ns_per_frame = std::chrono::duration<double, std::nano>(t1 - t0).count() / boxes.size();
+}
+
+// 同一序列分别走 KalmanBatch<Model>（匀速 xyah 为 SIMD 核，其余逐通道）与 KalmanFilter<Model>，
+// 返回最大相对误差；奇数通道丢检，测试 update 的子集路径
+template <class Model>
+static float batch_error(const std::vector<Eigen::Vector4f>& zs, const std::vector<bool>& has) {
+    using KF = KalmanFilter<Model>;
+    constexpr int N = KF::kStateDim, M = KF::kMeasDim;
+    const size_t stride = KalmanBatch<Model>::kLaneAlign;
+    KalmanBatch<Model> batch;
+    KF even, odd;
+    std::vector<float> mean(N * stride), cov(N * N * stride);
+    for (size_t i = 0; i < stride; ++i) batch.initiate(mean.data(), cov.data(), stride, i);
+
+    float max_err = 0.0f;
+    std::vector<uint32_t> idx;
+    std::vector<float> z;
+    for (size_t t = 0; t < zs.size(); ++t) {
+        const float dt = t % 4 == 3 ? 2.0f : 1.0f;
+        batch.predict(mean.data(), cov.data(), stride, stride, dt);
+        even.predict(dt);
+        odd.predict(dt);
+        if (has[t]) {
+            idx.clear();
+            z.clear();
+            for (size_t i = 0; i < stride; i += 2) {
+                idx.push_back(static_cast<uint32_t>(i));
+                for (int c = 0; c < M; ++c) z.push_back(zs[t][c]);
+            }
+            batch.update(mean.data(), cov.data(), stride, idx.data(), z.data(), idx.size());
+            even.update(zs[t]);
+        }
+        for (size_t i = 0; i < 2; ++i) {
+            const KF& ref = i == 0 ? even : odd;
+            typename KF::Mean x;
+            typename KF::Covariance P;
+            for (int r = 0; r < N; ++r) x[r] = mean[r * stride + i];
+            for (int e = 0; e < N * N; ++e) P(e / N, e % N) = cov[e * stride + i];
+            max_err = std::max(max_err, relative_error(x, ref.getState()));
+            max_err = std::max(max_err, relative_error(P, ref.getCovariance()));
+        }
+    }
+    return max_err;
+}
+
+static void test_motion_models() {
+    std::cout << "\n=== 编译期运动模型 ===\n\n";
+
+    // 1. 分块展开 vs 稠密公式
+    std::vector<Eigen::Vector4f> zs(100);
+    std::vector<bool> has(zs.size());
+    for (size_t t = 0; t < zs.size(); ++t) {
+        const float f = static_cast<float>(t);
+        zs[t] = Eigen::Vector4f(100.0f + 2.0f * f + 0.02f * f * f, 200.0f + f, 0.5f, 100.0f + 0.1f * f);
+        has[t] = (t % 5) != 2;
+    }
+    const float err_cv = dense_reference_error<ConstantVelocityXYAH>(zs, has);
+    const float err_wh = dense_reference_error<ConstantVelocityXYWH>(zs, has);
+    const float err_ca = dense_reference_error<ConstantAccelerationXYAH>(zs, has);
+    std::cout << "分块实现 vs 稠密公式最大相对误差: CV-xyah = " << std::scientific << std::setprecision(2) << err_cv
+              << ", CV-xywh = " << err_wh << ", CA-xyah = " << err_ca << "\n";
+    assert(err_cv < 1e-2f && err_wh < 1e-2f && err_ca < 1e-2f);
+
+    // 2. 框互转
+    const Eigen::Vector4f box(10.0f, 20.0f, 30.0f, 60.0f);
+    assert((ConstantVelocityXYAH::toTlwh(ConstantVelocityXYAH::fromTlwh(10, 20, 30, 60)) - box).norm() < 1e-4f);
+    assert((ConstantVelocityXYWH::toTlwh(ConstantVelocityXYWH::fromTlwh(10, 20, 30, 60)) - box).norm() < 1e-4f);
+
+    // 3. 匀加速目标（x 方向加速度 0.05 像素/帧²），每 10 帧丢检 4 帧：
+    //    匀加速模型外推误差应明显小于匀速模型；两种匀速模型在宽高比不变时结果相近
+    std::vector<Eigen::Vector4f> boxes(300);
+    for (size_t t = 0; t < boxes.size(); ++t) {
+        const float f = static_cast<float>(t);
+        boxes[t] = Eigen::Vector4f(50.0f + 1.0f * f + 0.025f * f * f, 100.0f + 0.5f * f, 40.0f, 80.0f);
+    }
+    float e_cv, e_wh, e_ca;
+    double ns_cv, ns_wh, ns_ca;
+    long a_cv, a_wh, a_ca;
+    extrapolation_error<ConstantVelocityXYAH>(boxes, 10, 4, e_cv, ns_cv, a_cv);
+    extrapolation_error<ConstantVelocityXYWH>(boxes, 10, 4, e_wh, ns_wh, a_wh);
+    extrapolation_error<ConstantAccelerationXYAH>(boxes, 10, 4, e_ca, ns_ca, a_ca);
+    std::cout << std::fixed << std::setprecision(2)
+              << "丢检 4 帧后的位置误差（像素）: CV-xyah = " << e_cv << ", CV-xywh = " << e_wh
+              << ", CA-xyah = " << e_ca << "\n"
+              << std::setprecision(1) << "每帧耗时 ns: CV-xyah = " << ns_cv << ", CV-xywh = " << ns_wh
+              << ", CA-xyah = " << ns_ca << "；堆分配: " << a_cv + a_wh + a_ca << "\n";
+    assert(e_ca < 0.5f * e_cv);
+    assert(std::abs(e_wh - e_cv) < 0.5f);
+    assert(a_cv + a_wh + a_ca == 0);
+
+    // 4. 批量实现：匀速 xyah 的 SIMD 核与其余模型的逐通道路径都与单轨迹滤波器一致
+    const float b_cv = batch_error<ConstantVelocityXYAH>(zs, has);
+    const float b_wh = batch_error<ConstantVelocityXYWH>(zs, has);
+    const float b_ca = batch_error<ConstantAccelerationXYAH>(zs, has);
+    std::cout << "批量 vs 单轨迹最大相对误差: CV-xyah = " << std::scientific << std::setprecision(2) << b_cv
+              << ", CV-xywh = " << b_wh << ", CA-xyah = " << b_ca << "（" << KalmanBatch<>::isaName() << " / "
+              << KalmanBatch<ConstantAccelerationXYAH>::isaName() << "）\n";
+    assert(b_cv < 1e-3f && b_wh < 1e-3f && b_ca < 1e-3f);
+}
 
 int main() {
     std::cout << "=== KalmanFilter 单轨迹测试 ===\n\n";
 
     // 创建 Kalman 滤波器（使用默认 DeepSORT 超参数）
-    KalmanFilter kf;
+    KalmanFilter<> kf;
 
     // 模拟一条真实轨迹：匀速运动的目标
     // 真实状态: [u, v, gamma, h] = [100 + t*2, 200 + t*1, 0.5, 100]
@@ -91,5 +490,9 @@ int main() {
     std::cout << "2. 帧 3-5（未匹配）：预测继续外推，协方差 P_diag 显著增大\n";
     std::cout << "3. 帧 6（恢复匹配）：滤波器快速收敛回真实轨迹\n";
 
+    compare_with_legacy();
+    test_variable_dt();
+    test_motion_models();
+
     return 0;
 }
\ No newline at end of file
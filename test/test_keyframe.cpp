@@ -0,0 +1,220 @@
+#include "tracker/DeepSortTracker.h"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <cassert>
+#include <cstdio>
+
+// ==================== 关键帧 / 插帧测试 ====================
+// 合成视频：带纹理的背景上若干带纹理的目标匀速运动，检测即真值框。
+// 1. 每 3 帧检测一次：插帧上光流推进的框贴近真值，每个目标始终保持同一个 ID
+// 2. 漂移：插帧画面突然失去纹理（光流全部失败）时，下一帧强制检测
+// 3. 回放：插帧的光流观测写入飞行记录，不需要图像即可确定性回放
+// 4. 耗时：关键帧 vs 插帧（SORT，检测耗时不计）
+
+struct Target {
+    cv::Point2f pos, vel;
+    cv::Mat texture;
+};
+
+struct Video {
+    cv::Mat background;
+    std::vector<Target> targets;
+    cv::Size target_size{60, 120};
+};
+
+static Video make_video(int n, std::mt19937& rng) {
+    Video v;
+    cv::theRNG().state = rng();
+    v.background.create(480, 640, CV_8UC3);
+    cv::randu(v.background, cv::Scalar::all(0), cv::Scalar::all(255));
+    cv::GaussianBlur(v.background, v.background, cv::Size(7, 7), 2.0);
+    // 3 列 x 2 行，60 帧内互不遮挡、不出画面
+    std::uniform_real_distribution<float> vx(-0.9f, 0.9f), vy(-0.8f, 0.8f);
+    for (int i = 0; i < n; ++i) {
+        Target t;
+        t.pos = cv::Point2f(110.0f + 180.0f * (i % 3), 40.0f + 220.0f * (i / 3));
+        t.vel = cv::Point2f(vx(rng), vy(rng));
+        t.texture.create(v.target_size, CV_8UC3);
+        cv::randu(t.texture, cv::Scalar::all(0), cv::Scalar::all(255));
+        cv::GaussianBlur(t.texture, t.texture, cv::Size(5, 5), 1.5);
+        v.targets.push_back(t);
+    }
+    return v;
+}
+
+static cv::Rect truth_box(const Video& v, size_t i, int f) {
+    const cv::Point2f p = v.targets[i].pos + v.targets[i].vel * static_cast<float>(f);
+    return cv::Rect(cvRound(p.x), cvRound(p.y), v.target_size.width, v.target_size.height);
+}
+
+static cv::Mat render(const Video& v, int f) {
+    cv::Mat img = v.background.clone();
+    const cv::Rect frame_rect(0, 0, img.cols, img.rows);
+    for (size_t i = 0; i < v.targets.size(); ++i) {
+        const cv::Rect b = truth_box(v, i, f);
+        const cv::Rect vis = b & frame_rect;
+        if (vis.area() == 0) continue;
+        v.targets[i].texture(vis - b.tl()).copyTo(img(vis));
+    }
+    return img;
+}
+
+static std::vector<detect_result> detect(const Video& v, int f) {
+    std::vector<detect_result> dets;
+    for (size_t i = 0; i < v.targets.size(); ++i) {
+        detect_result d;
+        d.box = truth_box(v, i, f);
+        d.classId = 0;
+        d.confidence = 0.9f;
+        dets.push_back(d);
+    }
+    return dets;
+}
+
+// 与真值 IoU 最大的目标
+static int owner(const Video& v, const cv::Rect_<float>& box, int f, float& best_iou) {
+    int best = -1;
+    best_iou = 0.0f;
+    for (size_t i = 0; i < v.targets.size(); ++i) {
+        const cv::Rect b = truth_box(v, i, f);
+        const float iou = CalculateIoU(box, cv::Rect_<float>(b.x, b.y, b.width, b.height));
+        if (iou > best_iou) {
+            best_iou = iou;
+            best = static_cast<int>(i);
+        }
+    }
+    return best;
+}
+
+int main() {
+    std::cout << "=== 关键帧 / 插帧 ===\n";
+    std::mt19937 rng(11);
+    const int num_targets = 6, num_frames = 60;
+    Video video = make_video(num_targets, rng);
+
+    KeyframeConfig kc;
+    kc.detect_interval = 3;
+
+    // ---------- 1. 每 3 帧检测一次 ----------
+    {
+        DeepSortTracker<> tracker("", 0.7f, 30, 3);
+        tracker.setKeyframeConfig(kc);
+        std::vector<TrackOutput> out;
+        std::vector<int> id_of(num_targets, -1);
+        float min_iou = 1.0f, iou_sum = 0.0f;
+        size_t n_boxes = 0;
+        for (int f = 0; f < num_frames; ++f) {
+            const cv::Mat img = render(video, f);
+            const bool keyframe = tracker.needsDetection();
+            assert(keyframe == (f % 3 == 0));
+            if (keyframe) tracker.update(img, detect(video, f), out);
+            else tracker.propagate(img, out);
+            if (f < 6) continue;
+
+            assert(out.size() == static_cast<size_t>(num_targets));
+            for (const TrackOutput& o : out) {
+                float iou = 0.0f;
+                const int t = owner(video, o.box, f, iou);
+                assert(t >= 0);
+                if (id_of[t] < 0) id_of[t] = o.id;
+                assert(id_of[t] == o.id);   // 插帧不丢 ID、不换 ID
+                if (!keyframe) {
+                    min_iou = std::min(min_iou, iou);
+                    iou_sum += iou;
+                    n_boxes++;
+                }
+            }
+        }
+        const KeyframeStats& ks = tracker.keyframeStats();
+        std::cout << std::fixed << std::setprecision(3)
+                  << "  关键帧 " << ks.keyframes << "，插帧 " << ks.interframes
+                  << "，光流采用 " << ks.flow_tracked << " / 失败 " << ks.flow_failed << " / 漂移 " << ks.flow_drifted
+                  << "\n  插帧框与真值 IoU：平均 " << iou_sum / n_boxes << "，最小 " << min_iou << "\n"
+                  << std::defaultfloat;
+        assert(ks.keyframes == 20 && ks.interframes == 40 && ks.forced_keyframes == 0);
+        assert(min_iou > 0.8f);
+    }
+
+    // ---------- 2. 漂移强制检测 ----------
+    {
+        DeepSortTracker<> tracker("", 0.7f, 30, 1);
+        tracker.setKeyframeConfig(kc);
+        std::vector<TrackOutput> out;
+        tracker.update(render(video, 0), detect(video, 0), out);
+        assert(!tracker.needsDetection());
+        // 插帧画面失去纹理：所有轨迹光流失败，只保留预测
+        cv::Mat blank(video.background.size(), CV_8UC3, cv::Scalar::all(128));
+        tracker.propagate(blank, out);
+        assert(out.size() == static_cast<size_t>(num_targets));
+        assert(tracker.keyframeStats().flow_failed == static_cast<size_t>(num_targets));
+        assert(tracker.needsDetection());
+        tracker.update(render(video, 2), detect(video, 2), out);
+        assert(tracker.keyframeStats().forced_keyframes == 1);
+        assert(!tracker.needsDetection());
+        std::cout << "  光流全部失败后下一帧强制检测\n";
+    }
+
+    // ---------- 3. 插帧的确定性回放 ----------
+    {
+        DeepSortTracker<> tracker("", 0.7f, 30, 3);
+        tracker.setKeyframeConfig(kc);
+        FlightRecorderConfig rc;
+        rc.capacity_frames = 40;
+        auto recorder = std::make_shared<FlightRecorder>(rc);
+        tracker.setFlightRecorder(recorder);
+        std::vector<TrackOutput> out;
+        for (int f = 0; f < num_frames; ++f) {
+            const cv::Mat img = render(video, f);
+            if (tracker.needsDetection()) tracker.update(img, detect(video, f), out);
+            else tracker.propagate(img, out);
+        }
+        const std::string path = "test_keyframe.fdr";
+        assert(recorder->dump(path) > 0);
+        FlightRecord record = FlightRecorder::load(path);
+        std::remove(path.c_str());
+
+        DeepSortTracker<> replayed("");
+        replayed.restore(record.checkpoint.data(), record.checkpoint.size());
+        std::vector<TrackOutput> got;
+        size_t interframes = 0;
+        for (const FlightFrame& fr : record.frames) {
+            interframes += fr.interframe;
+            replayed.replay(fr, record.with_reid, got);
+        }
+        assert(interframes > 0 && got.size() == out.size());
+        for (size_t i = 0; i < got.size(); ++i) {
+            assert(got[i].id == out[i].id && got[i].box == out[i].box && got[i].age == out[i].age);
+        }
+        std::cout << "  回放 " << record.frames.size() << " 帧（其中插帧 " << interframes << "），输出一致\n";
+    }
+
+    // ---------- 4. 耗时 ----------
+    {
+        DeepSortTracker<> tracker("", 0.7f, 30, 3);
+        tracker.setKeyframeConfig(kc);
+        std::vector<cv::Mat> frames;
+        for (int f = 0; f < num_frames; ++f) frames.push_back(render(video, f));
+        std::vector<TrackOutput> out;
+        double key_ms = 0.0, inter_ms = 0.0;
+        for (int f = 0; f < num_frames; ++f) {
+            const bool keyframe = tracker.needsDetection();
+            std::vector<detect_result> dets = keyframe ? detect(video, f) : std::vector<detect_result>();
+            auto t0 = std::chrono::high_resolution_clock::now();
+            if (keyframe) tracker.update(frames[f], dets, out);
+            else tracker.propagate(frames[f], out);
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - t0).count();
+            (keyframe ? key_ms : inter_ms) += ms;
+        }
+        const KeyframeStats& ks = tracker.keyframeStats();
+        std::cout << std::fixed << std::setprecision(3)
+                  << "  跟踪耗时 ms/帧：关键帧 " << key_ms / ks.keyframes << "（另加检测器），插帧 "
+                  << inter_ms / ks.interframes << "（" << num_targets << " 个目标，640x480，光流缩放 "
+                  << kc.flow_scale << "）\n" << std::defaultfloat;
+    }
+
+    std::cout << "全部通过\n";
+    return 0;
+}
@@ -2,25 +2,29 @@
 #include <opencv2/opencv.hpp>
 #include <iostream>
 #include <string>
+#include <thread>
+#include <chrono>
+#include <cmath>
 
 int main(int argc, char* argv[]) {
     // 1. 解析命令行参数
     if (argc < 3) {
-        std::cerr << "Usage: " << argv[0] << " <model.mnn> <input_image.jpg>\n";
-        std::cerr << "Example: " << argv[0] << " ReID/ReID.mnn test.jpg\n";
+        std::cerr << "Usage: " << argv[0] << " <model.mnn> <input_image.jpg> [num_threads]\n";
+        std::cerr << "Example: " << argv[0] << " ReID/ReID.mnn test.jpg 4\n";
         return -1;
     }
 
     std::string modelPath = argv[1];
     std::string imagePath = argv[2];
+    int numThreads = argc > 3 ? std::max(1, std::atoi(argv[3])) : 1;
 
     // 推理时需进行与训练模型一致的归一化方式
     // ImageNet 统计值
     float mean[3] = {0.485f * 255.0f, 0.456f * 255.0f, 0.406f * 255.0f}; // ≈ [123.675, 116.28, 103.53]
     float std[3]  = {0.229f, 0.224f, 0.225f};
 
-    // 2. 创建推理器并加载模型
-    MNNInfer infer(modelPath,mean,std);
+    // 2. 创建推理器并加载模型（会话池大小 = 线程数）
+    MNNInfer infer(modelPath,mean,std,numThreads);
     if (infer.loadModel() != 0) {
         std::cerr << "Failed to load model: " << modelPath << std::endl;
         return -1;
@@ -67,5 +71,42 @@ int main(int argc, char* argv[]) {
         // std::cout << "\n";
     }
 
+    // 7. 多线程：各线程共享同一个模型并发推理，结果应与单线程一致
+    if (numThreads > 1) {
+        const int iters = 20;
+        std::vector<int> mismatches(numThreads, 0);
+        auto t0 = std::chrono::high_resolution_clock::now();
+        std::vector<std::thread> workers;
+        for (int t = 0; t < numThreads; ++t) {
+            workers.emplace_back([&, t]() {
+                std::vector<cv::Mat> in = {img};
+                std::vector<std::vector<float>> out;
+                std::vector<std::pair<std::string, std::vector<int>>> shapes;
+                for (int k = 0; k < iters; ++k) {
+                    if (infer.runInference(in, out, shapes) != 0 || out.size() != 1 ||
+                        out[0].size() != outputs[0].size()) {
+                        mismatches[t]++;
+                        continue;
+                    }
+                    for (size_t j = 0; j < out[0].size(); ++j) {
+                        if (std::abs(out[0][j] - outputs[0][j]) > 1e-4f) {
+                            mismatches[t]++;
+                            break;
+                        }
+                    }
+                }
+            });
+        }
+        for (auto& w : workers) w.join();
+        auto t1 = std::chrono::high_resolution_clock::now();
+        double ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+
+        int total_mismatches = 0;
+        for (int m : mismatches) total_mismatches += m;
+        std::cout << "\n" << numThreads << " threads x " << iters << " runs: "
+                  << ms / (numThreads * iters) << " ms/run, mismatches: " << total_mismatches << "\n";
+        if (total_mismatches != 0) return -1;
+    }
+
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,153 @@
+#include "eval/MotMetrics.h"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <cmath>
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+
+// ==================== MOT 指标测试 ====================
+// 手算可得的小例子：
+// 1. 完美跟踪：MOTA = IDF1 = HOTA = 1
+// 2. 一次 ID 切换：MOTA = 0.75，IDF1 = 0.5，HOTA = sqrt(0.5)
+// 3. 漏检 + 虚警：MOTA = 0
+// 4. MOTChallenge 预处理：与干扰类别 gt 匹配的跟踪框不算虚警，标记为 0 的 gt 不算漏检
+// 5. 定位误差：IoU = 0.6 的匹配在 α <= 0.6 时计入，HOTA 随之下降
+// 6. 文件读写往返与多序列合并
+
+static bool near(double a, double b, double eps = 1e-6) {
+    return std::abs(a - b) < eps;
+}
+
+static MotEntry entry(int id, float x, float y, float w = 50.0f, float h = 100.0f, int cls = 1, float score = 1.0f) {
+    MotEntry e;
+    e.id = id;
+    e.box = cv::Rect_<float>(x, y, w, h);
+    e.cls = cls;
+    e.score = score;
+    return e;
+}
+
+static void print(const char* name, const MotSummary& m) {
+    std::cout << std::fixed << std::setprecision(4)
+              << "  " << name << ": MOTA " << m.mota() << "  IDF1 " << m.idf1() << "  HOTA " << m.hota()
+              << "  (DetA " << m.detA() << ", AssA " << m.assA() << ", LocA " << m.locA() << ")"
+              << "  IDSW " << m.idsw << " FP " << m.fp << " FN " << m.fn << "\n" << std::defaultfloat;
+}
+
+int main() {
+    std::cout << "=== MOT 指标 ===\n";
+
+    // ---------- 1. 完美跟踪 ----------
+    {
+        MotEvaluator ev;
+        for (int f = 0; f < 10; ++f) {
+            std::vector<MotEntry> gt = {entry(1, 10.0f * f, 0), entry(2, 300, 10.0f * f)};
+            std::vector<MotEntry> tr = {entry(7, 10.0f * f, 0), entry(9, 300, 10.0f * f)};
+            ev.addFrame(gt, tr);
+        }
+        MotSummary m = ev.compute();
+        print("完美跟踪", m);
+        assert(near(m.mota(), 1.0) && near(m.idf1(), 1.0) && near(m.hota(), 1.0) && near(m.motp(), 1.0));
+        assert(m.mostly_tracked == 2 && m.mostly_lost == 0);
+    }
+
+    // ---------- 2. ID 切换 ----------
+    {
+        // 一个目标 4 帧，跟踪 ID 前两帧为 1，后两帧为 2
+        MotEvaluator ev;
+        for (int f = 0; f < 4; ++f) {
+            ev.addFrame({entry(1, 0, 0)}, {entry(f < 2 ? 1 : 2, 0, 0)});
+        }
+        MotSummary m = ev.compute();
+        print("ID 切换", m);
+        assert(m.idsw == 1 && near(m.mota(), 0.75));
+        assert(m.idtp == 2 && near(m.idf1(), 0.5));
+        // 每个匹配对的关联得分 2 / (4 + 2 - 2) = 0.5，DetA = 1
+        assert(near(m.detA(), 1.0) && near(m.assA(), 0.5) && near(m.hota(), std::sqrt(0.5)));
+    }
+
+    // ---------- 3. 漏检 + 虚警 ----------
+    {
+        MotEvaluator ev;
+        ev.addFrame({entry(1, 0, 0), entry(2, 200, 0)}, {entry(1, 0, 0), entry(5, 600, 400)});
+        MotSummary m = ev.compute();
+        print("漏检+虚警", m);
+        assert(m.tp == 1 && m.fp == 1 && m.fn == 1 && near(m.mota(), 0.0));
+        assert(near(m.idf1(), 0.5));
+    }
+
+    // ---------- 4. MOTChallenge 预处理 ----------
+    {
+        // gt：行人、静止的人（类别 7，干扰项）、标记为 0 的行人；跟踪框分别覆盖三者
+        std::vector<MotEntry> gt = {entry(1, 0, 0), entry(2, 200, 0, 50, 100, 7), entry(3, 400, 0, 50, 100, 1, 0.0f)};
+        std::vector<MotEntry> tr = {entry(1, 0, 0), entry(2, 200, 0), entry(3, 400, 0)};
+        MotEvaluator rules(true), plain(false);
+        rules.addFrame(gt, tr);
+        plain.addFrame(gt, tr);
+        MotSummary a = rules.compute(), b = plain.compute();
+        print("MOT 规则", a);
+        print("不做预处理", b);
+        // 干扰项上的跟踪框被移除；标记为 0 的 gt 被移除，其上的跟踪框仍是虚警
+        assert(a.num_gt == 1 && a.num_tracker == 2 && a.tp == 1 && a.fp == 1 && a.fn == 0);
+        assert(b.num_gt == 3 && b.num_tracker == 3 && b.tp == 3 && near(b.mota(), 1.0));
+    }
+
+    // ---------- 5. 定位误差 ----------
+    {
+        // 宽 50 的框水平偏移 12.5：IoU = 37.5 / 62.5 = 0.6
+        MotEvaluator ev;
+        for (int f = 0; f < 5; ++f) ev.addFrame({entry(1, 0, 0)}, {entry(1, 12.5f, 0)});
+        MotSummary m = ev.compute();
+        print("IoU 0.6", m);
+        assert(near(m.mota(), 1.0) && near(m.motp(), 0.6, 1e-5));
+        // α = 0.05..0.60 共 12 个阈值匹配成功（HOTA = 1），其余 7 个全部漏检 + 虚警（HOTA = 0）
+        for (int a = 0; a < kHotaAlphas; ++a) assert(near(m.hotaAt(a), a < 12 ? 1.0 : 0.0, 1e-5));
+        assert(near(m.hota(), 12.0 / 19.0, 1e-5) && near(m.locA(), (12 * 0.6 + 7 * 1.0) / 19.0, 1e-5));
+    }
+
+    // ---------- 6. 文件读写与合并 ----------
+    {
+        const std::string gt_path = "test_mot_gt.txt", res_path = "test_mot_res.txt";
+        {
+            std::ofstream f(gt_path);
+            f << "1,1,0,0,50,100,1,1,1.0\n"
+                 "2,1,5,0,50,100,1,1,0.8\n"
+                 "2,2,300,0,50,100,1,1,1.0\n"
+                 "3,2,305,0,50,100,1,1,1.0\n";
+        }
+        MotSequence gt = LoadMotFile(gt_path);
+        assert(gt.size() == 4 && gt[2].size() == 2 && gt[2][0].visibility == 0.8f && gt[2][1].box.x == 300.0f);
+
+        MotSequence res(4);
+        res[1] = {entry(10, 0, 0)};
+        res[2] = {entry(10, 5, 0), entry(11, 300, 0)};
+        res[3] = {entry(11, 305, 0)};
+        SaveMotFile(res_path, res);
+        MotSequence loaded = LoadMotFile(res_path);
+        assert(loaded.size() == 4 && loaded[2].size() == 2 && loaded[2][1].id == 11);
+
+        MotEvaluator ev;
+        ev.addSequence(gt, loaded);
+        MotSummary one = ev.compute();
+        assert(one.num_frames == 3 && near(one.mota(), 1.0) && near(one.idf1(), 1.0));
+
+        // 两个序列合并：计数相加
+        MotEvaluator ev2;
+        ev2.addFrame({entry(1, 0, 0)}, {});
+        MotSummary total = one;
+        total += ev2.compute();
+        assert(total.num_gt == 5 && total.fn == 1 && near(total.mota(), 0.8));
+        std::remove(gt_path.c_str());
+        std::remove(res_path.c_str());
+        std::cout << "  文件往返与合并正确\n";
+
+        bool thrown = false;
+        try { LoadMotFile("no_such_file.txt"); } catch (const std::runtime_error&) { thrown = true; }
+        assert(thrown);
+    }
+
+    std::cout << "全部通过\n";
+    return 0;
+}
@@ -0,0 +1,167 @@
+#include "gallery/ReidGallery.h"
+#include "utils/utils.h"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+
+// ==================== 跨摄像头 ReID 特征库测试 ====================
+// 1. 召回率：HNSW top-10 与暴力检索对比
+// 2. 持久化：关闭后重新打开文件，检索结果一致，继续入库
+// 3. 并发：多个线程检索的同时另一个线程入库
+
+static const size_t kDim = 128;
+
+// 聚类分布的特征：每个“车辆”一个中心，同一车辆的不同观测在中心附近
+static std::vector<float> make_features(size_t n, size_t clusters, std::mt19937& rng) {
+    std::normal_distribution<float> g(0.0f, 1.0f);
+    std::vector<float> centers(clusters * kDim);
+    for (auto& x : centers) x = g(rng);
+    std::vector<float> out(n * kDim);
+    for (size_t i = 0; i < n; ++i) {
+        const float* c = centers.data() + (rng() % clusters) * kDim;
+        for (size_t d = 0; d < kDim; ++d) out[i * kDim + d] = c[d] + 0.5f * g(rng);
+        L2Normalize(out.data() + i * kDim, kDim);
+    }
+    return out;
+}
+
+static std::vector<uint32_t> brute_force(const std::vector<float>& base, size_t n, const float* q, size_t k) {
+    std::vector<std::pair<float, uint32_t>> all(n);
+    for (size_t i = 0; i < n; ++i) all[i] = {NormalizedCosineDistance(q, base.data() + i * kDim, kDim), static_cast<uint32_t>(i)};
+    std::partial_sort(all.begin(), all.begin() + k, all.end());
+    std::vector<uint32_t> ids(k);
+    for (size_t i = 0; i < k; ++i) ids[i] = all[i].second;
+    return ids;
+}
+
+int main() {
+    std::mt19937 rng(11);
+    const size_t n = 20000, num_queries = 200, k = 10;
+    std::vector<float> base = make_features(n, 2000, rng);
+    std::vector<float> queries = make_features(num_queries, 2000, rng);
+
+    ReidGalleryConfig cfg;
+    cfg.dim = kDim;
+    cfg.initial_capacity = 1024;   // 触发多次扩容
+    cfg.ef_search = 128;
+    const std::string path = "test_reid_gallery.bin";
+    std::remove(path.c_str());
+
+    // ---------- 1. 召回率 ----------
+    std::cout << "=== 召回率（" << n << " 个 " << kDim << " 维特征）===\n";
+    std::vector<std::vector<GalleryMatch>> before(num_queries);
+    {
+        ReidGallery gallery(path, cfg);
+        auto t0 = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < n; ++i) {
+            GalleryRecord r;
+            r.camera_id = static_cast<int32_t>(i % 50);
+            r.track_id = static_cast<int32_t>(i);
+            r.frame = static_cast<int64_t>(i / 50);
+            uint32_t id = gallery.add(base.data() + i * kDim, r);
+            assert(id == i);
+        }
+        auto t1 = std::chrono::high_resolution_clock::now();
+
+        size_t hit = 0;
+        double search_ms = 0.0;
+        for (size_t q = 0; q < num_queries; ++q) {
+            const float* f = queries.data() + q * kDim;
+            auto s0 = std::chrono::high_resolution_clock::now();
+            gallery.search(f, k, before[q]);
+            auto s1 = std::chrono::high_resolution_clock::now();
+            search_ms += std::chrono::duration<double, std::milli>(s1 - s0).count();
+            assert(before[q].size() == k);
+            assert(std::is_sorted(before[q].begin(), before[q].end(),
+                                  [](const GalleryMatch& a, const GalleryMatch& b) { return a.distance < b.distance; }));
+            std::vector<uint32_t> truth = brute_force(base, n, f, k);
+            for (const auto& m : before[q]) {
+                hit += std::count(truth.begin(), truth.end(), m.index);
+                assert(m.record.track_id == static_cast<int32_t>(m.index));
+                assert(m.record.camera_id == static_cast<int32_t>(m.index % 50));
+            }
+        }
+        double recall = static_cast<double>(hit) / (num_queries * k);
+        std::cout << "  入库 " << std::fixed << std::setprecision(1)
+                  << std::chrono::duration<double, std::milli>(t1 - t0).count() / n * 1000.0 << " us/个"
+                  << "，检索 " << std::setprecision(3) << search_ms / num_queries << " ms/次"
+                  << "，recall@" << k << " = " << recall
+                  << "，文件 " << gallery.mappedBytes() / (1024 * 1024) << " MB\n" << std::defaultfloat;
+        assert(recall >= 0.9);
+    }
+
+    // ---------- 2. 持久化 ----------
+    std::cout << "=== 重新打开 ===\n";
+    {
+        ReidGallery gallery(path, cfg);
+        assert(gallery.size() == n);
+        std::vector<GalleryMatch> after;
+        for (size_t q = 0; q < num_queries; ++q) {
+            gallery.search(queries.data() + q * kDim, k, after);
+            assert(after.size() == before[q].size());
+            for (size_t i = 0; i < after.size(); ++i) assert(after[i].index == before[q][i].index);
+        }
+        // 重新打开后继续入库，新特征可被检索到
+        GalleryRecord r;
+        r.camera_id = 99;
+        r.track_id = 7;
+        uint32_t id = gallery.add(queries.data(), r);
+        gallery.search(queries.data(), 1, after);
+        assert(after[0].index == id && after[0].record.camera_id == 99 && after[0].distance < 1e-4f);
+        std::cout << "  " << gallery.size() << " 个特征，检索结果与关闭前一致\n";
+
+        // 维度不一致的配置不能打开该文件
+        ReidGalleryConfig wrong = cfg;
+        wrong.dim = kDim * 2;
+        bool thrown = false;
+        try {
+            ReidGallery bad(path, wrong);
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+    std::remove(path.c_str());
+
+    // ---------- 3. 并发入库与检索 ----------
+    std::cout << "=== 并发：1 个线程入库，4 个线程检索 ===\n";
+    {
+        ReidGallery gallery("", cfg);   // 匿名内存
+        const size_t first = n - 2000;
+        for (size_t i = 0; i < first; ++i) gallery.add(base.data() + i * kDim, GalleryRecord());
+
+        std::atomic<bool> done(false);
+        std::atomic<size_t> searches(0);
+        std::vector<std::thread> readers;
+        for (int t = 0; t < 4; ++t) {
+            readers.emplace_back([&, t]() {
+                std::vector<GalleryMatch> out;
+                size_t q = t;
+                while (!done) {
+                    gallery.search(queries.data() + (q++ % num_queries) * kDim, k, out);
+                    assert(out.size() == k);
+                    searches++;
+                }
+            });
+        }
+        auto t0 = std::chrono::high_resolution_clock::now();
+        for (size_t i = first; i < n; ++i) gallery.add(base.data() + i * kDim, GalleryRecord());
+        auto t1 = std::chrono::high_resolution_clock::now();
+        done = true;
+        for (auto& r : readers) r.join();
+
+        assert(gallery.size() == n);
+        double ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+        std::cout << "  入库 " << n - first << " 个用时 " << std::fixed << std::setprecision(1) << ms
+                  << " ms，同时完成检索 " << searches.load() << " 次\n" << std::defaultfloat;
+    }
+
+    return 0;
+}
@@ -0,0 +1,210 @@
+#include "tracker/DeepSortTracker.h"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <cassert>
+#include <cstdio>
+
+// ==================== 跟踪状态快照测试 ====================
+// 1. TrackStore：带特征库的轨迹保存/恢复后逐字段一致（完整特征库与精简快照）
+// 2. DeepSortTracker：跑一段后快照，恢复到另一个（超参数不同的）跟踪器，两者后续输出完全一致
+// 3. 文件：saveSnapshot / loadSnapshot（mmap）往返；版本不符、截断的快照被拒绝且不破坏当前状态
+// 4. 耗时：1000 条轨迹的快照与恢复
+
+static const size_t kDim = 64;
+
+static std::vector<std::vector<cv::Rect_<float>>> make_scene(int n, int num_frames, std::mt19937& rng) {
+    std::uniform_real_distribution<float> px(0.0f, 1800.0f), py(0.0f, 900.0f), v(-4.0f, 4.0f);
+    std::normal_distribution<float> noise(0.0f, 1.0f);
+    std::vector<cv::Point2f> pos(n), vel(n);
+    for (int i = 0; i < n; ++i) {
+        pos[i] = cv::Point2f(px(rng), py(rng));
+        vel[i] = cv::Point2f(v(rng), v(rng) * 0.5f);
+    }
+    std::vector<std::vector<cv::Rect_<float>>> frames(num_frames);
+    for (int f = 0; f < num_frames; ++f) {
+        for (int i = 0; i < n; ++i) {
+            pos[i] += vel[i];
+            if ((f + i) % 13 == 0) continue;
+            frames[f].emplace_back(pos[i].x + noise(rng), pos[i].y + noise(rng), 60.0f, 120.0f);
+        }
+    }
+    return frames;
+}
+
+// 快照中某一节的数据（用于构造损坏的快照）
+template <typename T>
+static T* section_data(std::vector<char>& buf, uint32_t tag, size_t& count) {
+    const SnapshotHeader* header = reinterpret_cast<const SnapshotHeader*>(buf.data());
+    const SnapshotSection* sections = reinterpret_cast<const SnapshotSection*>(buf.data() + sizeof(SnapshotHeader));
+    for (uint32_t s = 0; s < header->section_count; ++s) {
+        if (sections[s].tag != tag) continue;
+        count = sections[s].count;
+        return reinterpret_cast<T*>(buf.data() + sections[s].offset);
+    }
+    count = 0;
+    return nullptr;
+}
+
+static bool same_outputs(const std::vector<TrackOutput>& a, const std::vector<TrackOutput>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].id != b[i].id || a[i].handle != b[i].handle || a[i].box != b[i].box ||
+            a[i].state != b[i].state || a[i].age != b[i].age) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void check_store(TrackStore<>& a, const TrackStore<>& b, bool full_gallery) {
+    assert(a.size() == b.size() && a.capacity() == b.capacity() && a.featureDim() == b.featureDim());
+    for (size_t i = 0; i < a.size(); ++i) {
+        assert(a.id(i) == b.id(i) && a.box(i) == b.box(i) && a.handle(i) == b.handle(i));
+        assert(a.hits(i) == b.hits(i) && a.age(i) == b.age(i) && a.timeSinceUpdate(i) == b.timeSinceUpdate(i));
+        assert(a.state(i) == b.state(i));
+        assert(a.mean(i) == b.mean(i) && a.covariance(i) == b.covariance(i));
+        assert(std::equal(a.feature(i), a.feature(i) + kDim, b.feature(i)));
+        if (full_gallery) assert(a.galleryCount(i) == b.galleryCount(i));
+        else assert(b.galleryCount(i) == 1);
+    }
+}
+
+int main() {
+    std::mt19937 rng(17);
+
+    // ---------- 1. TrackStore ----------
+    std::cout << "=== TrackStore 往返 ===\n";
+    for (bool full_gallery : {true, false}) {
+        GalleryConfig cfg;
+        cfg.nn_budget = 8;
+        TrackStore<> store(3, cfg);
+        std::normal_distribution<float> g(0.0f, 1.0f);
+        for (int t = 0; t < 40; ++t) {
+            std::vector<float> f(kDim);
+            for (auto& x : f) x = std::abs(g(rng));
+            L2Normalize(f);
+            store.add(t, cv::Rect_<float>(10.0f * t, 20.0f, 30.0f, 60.0f), f.data(), kDim);
+            for (int k = 0; k < t % 11; ++k) {
+                store.predictAll();
+                store.update(t, cv::Rect_<float>(10.0f * t + k, 20.0f, 30.0f, 60.0f), f.data(), kDim);
+            }
+        }
+        std::vector<bool> keep(store.size());
+        for (size_t i = 0; i < keep.size(); ++i) keep[i] = (i % 4 != 2);
+        store.compact(keep);   // 留下空闲 slot
+
+        SnapshotWriter writer;
+        std::vector<char> buf;
+        store.saveState(writer, full_gallery);
+        writer.finish(buf);
+
+        TrackStore<> restored;
+        restored.loadState(SnapshotReader(buf.data(), buf.size()));
+        check_store(store, restored, full_gallery);
+
+        // 恢复后的 slot 池继续按原顺序复用
+        size_t a = store.add(100, cv::Rect_<float>(0, 0, 10, 10), nullptr, 0);
+        size_t b = restored.add(100, cv::Rect_<float>(0, 0, 10, 10), nullptr, 0);
+        assert(store.handle(a) == restored.handle(b));
+        std::cout << "  " << (full_gallery ? "完整特征库" : "只存最新特征") << ": " << buf.size() / 1024 << " KB\n";
+    }
+
+    // ---------- 2. DeepSortTracker ----------
+    std::cout << "=== 跟踪器快照后继续跟踪 ===\n";
+    auto frames = make_scene(40, 200, rng);
+    {
+        DeepSortTracker<> a("");
+        std::vector<TrackOutput> out_a, out_b;
+        for (int f = 0; f < 100; ++f) a.update(cv::Mat(), frames[f], out_a);
+
+        std::vector<char> buf;
+        a.snapshot(buf);
+        DeepSortTracker<> b("", 0.3f, 5, 1);   // 超参数由快照覆盖
+        b.restore(buf.data(), buf.size());
+
+        for (int f = 100; f < 200; ++f) {
+            a.update(cv::Mat(), frames[f], out_a);
+            b.update(cv::Mat(), frames[f], out_b);
+            assert(same_outputs(out_a, out_b));
+        }
+        std::cout << "  快照 " << buf.size() / 1024 << " KB，恢复后 100 帧输出一致\n";
+    }
+
+    // ---------- 3. 文件与错误处理 ----------
+    std::cout << "=== 文件往返与错误处理 ===\n";
+    {
+        const std::string path = "test_snapshot.bin";
+        DeepSortTracker<> a("");
+        std::vector<TrackOutput> out_a, out_b;
+        for (int f = 0; f < 50; ++f) a.update(cv::Mat(), frames[f], out_a);
+        a.saveSnapshot(path);
+
+        DeepSortTracker<> b("");
+        b.loadSnapshot(path);
+        std::remove(path.c_str());
+
+        std::vector<char> buf;
+        b.snapshot(buf);
+        std::vector<char> bad = buf;
+        reinterpret_cast<SnapshotHeader*>(bad.data())->version = kSnapshotVersion + 1;
+        bool thrown = false;
+        try { b.restore(bad.data(), bad.size()); } catch (const std::runtime_error&) { thrown = true; }
+        assert(thrown);
+        thrown = false;
+        try { b.restore(buf.data(), buf.size() / 2); } catch (const std::runtime_error&) { thrown = true; }
+        assert(thrown);
+
+        // 长度正确但内容不一致的节（槽位表、空闲表、特征库下标、枚举值）同样被拒绝
+        auto rejects = [&](const char (&tag)[5], auto corrupt) {
+            std::vector<char> bad_buf = buf;
+            size_t count = 0;
+            int32_t* data = section_data<int32_t>(bad_buf, SnapshotTag(tag), count);
+            assert(data && count > 0);
+            corrupt(data, count);
+            bool rejected = false;
+            try { b.restore(bad_buf.data(), bad_buf.size()); } catch (const std::runtime_error&) { rejected = true; }
+            return rejected;
+        };
+        assert(rejects("TSIX", [](int32_t* d, size_t n) { d[n - 1] = 1 << 20; }));
+        assert(rejects("TSLT", [](int32_t* d, size_t) { d[0] = d[1]; }));
+        assert(rejects("TGHD", [](int32_t* d, size_t) { d[0] = 1000; }));
+        assert(rejects("TGCN", [](int32_t* d, size_t) { d[0] = -1; }));
+        assert(rejects("DSST", [](int32_t* d, size_t) { d[3] = 7; }));   // assignment_mode
+        assert(rejects("TSST", [](int32_t* d, size_t) { d[9] = 7; }));   // metric（n_init, budget, 3 个 uint64, nn_budget 之后）
+
+        // 失败的恢复不影响 b
+        for (int f = 50; f < 100; ++f) {
+            a.update(cv::Mat(), frames[f], out_a);
+            b.update(cv::Mat(), frames[f], out_b);
+            assert(same_outputs(out_a, out_b));
+        }
+        std::cout << "  文件往返一致，版本不符、截断与内容不一致的快照被拒绝\n";
+    }
+
+    // ---------- 4. 耗时 ----------
+    std::cout << "=== 1000 条轨迹 ===\n";
+    {
+        auto big = make_scene(1000, 30, rng);
+        DeepSortTracker<> a("");
+        std::vector<TrackOutput> out;
+        for (const auto& dets : big) a.update(cv::Mat(), dets, out);
+
+        std::vector<char> buf;
+        a.snapshot(buf);   // 预热：分配缓冲
+        auto t0 = std::chrono::high_resolution_clock::now();
+        a.snapshot(buf);
+        auto t1 = std::chrono::high_resolution_clock::now();
+        DeepSortTracker<> b("");
+        b.restore(buf.data(), buf.size());
+        auto t2 = std::chrono::high_resolution_clock::now();
+        std::cout << "  " << out.size() << " 条输出轨迹，快照 " << buf.size() / 1024 << " KB"
+                  << std::fixed << std::setprecision(3)
+                  << "，保存 " << std::chrono::duration<double, std::milli>(t1 - t0).count() << " ms"
+                  << "，恢复 " << std::chrono::duration<double, std::milli>(t2 - t1).count() << " ms\n";
+    }
+
+    return 0;
+}
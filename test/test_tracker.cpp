@@ -25,22 +25,38 @@ int main() {
 
     // ==================== 初始化检测器和跟踪器 ====================
     try {
+        // 图优化后的模型缓存到模型旁边，第二次启动起跳过图优化
+        DetectorConfig detector_config;
+        detector_config.optimized_model_path = "/home/rton/MultiObjectTracker/test/yolo12n.opt.onnx";
+
+        auto startup = std::chrono::high_resolution_clock::now();
         ONNXYoloDetector yolo_detector(
             yolo_model_path,
             class_names,
             640,
             640,
-            0.6f,
-            0.5f
+            0.1f,   // 低分检测交给跟踪器的第二阶段 IoU 关联，不送入 ReID
+            0.5f,
+            detector_config
         );
 
-        DeepSortTracker tracker(
+        DeepSortTracker<> tracker(
             reid_model_path,
             0.7f,
             30,
             3,
             0.2f
         );
+        const double startup_ms = std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - startup).count();
+        const DetectorLoadStats& load = yolo_detector.loadStats();
+        std::cout << "⏱️ 启动耗时 " << startup_ms << " ms（检测器会话 " << load.session_ms << " ms，"
+                  << (load.from_optimized_cache ? "加载优化缓存" : "图优化") << "）" << std::endl;
+
+        // 关键帧 / 插帧：YOLO 每 detect_interval 帧运行一次，其余帧用 Kalman 预测 + 稀疏光流推进轨迹
+        KeyframeConfig keyframe;
+        keyframe.detect_interval = 3;
+        tracker.setKeyframeConfig(keyframe);
 
         // ==================== 打开视频 ====================
         std::string input_video = "/home/rton/MultiObjectTracker/test/demo.mp4";
@@ -60,6 +76,7 @@ int main() {
 
         std::cout << "📹 视频信息: " << width << "x" << height 
                   << " @ " << fps << " FPS, 总帧数: " << total_frames << std::endl;
+        if (fps > 0.0) tracker.setFrameInterval(1.0 / fps);
 
         // 创建视频写入器（使用与原视频相同的 FPS 和尺寸）
         cv::VideoWriter writer;
@@ -72,40 +89,42 @@ int main() {
         std::cout << "🚀 开始 YOLO + DeepSORT 跟踪...\n";
         cv::Mat frame;
         int frame_count = 0;
+        std::vector<TrackOutput> tracks;   // 跟踪结果缓冲，逐帧复用
+        std::vector<detect_result> yolo_results;
+        double keyframe_ms = 0.0, interframe_ms = 0.0;
+        double first_frame_ms = 0.0;   // 首帧含推理的一次性初始化，单独报告
 
         while (cap.read(frame)) {
             if (frame.empty()) break;
 
             auto start = std::chrono::high_resolution_clock::now();
-
-            // Step 1: YOLO 检测
-            std::vector<detect_result> yolo_results;
-            yolo_detector.detect(frame, yolo_results);
-
-            // Step 2: 转换检测结果
-            std::vector<cv::Rect_<float>> detections;
-            for (const auto& det : yolo_results) {
-                detections.emplace_back(
-                    static_cast<float>(det.box.x),
-                    static_cast<float>(det.box.y),
-                    static_cast<float>(det.box.width),
-                    static_cast<float>(det.box.height)
-                );
+            const double timestamp = cap.get(cv::CAP_PROP_POS_MSEC) / 1000.0;
+            const bool keyframe_now = tracker.needsDetection();
+
+            if (keyframe_now) {
+                // Step 1: YOLO 检测
+                yolo_results.clear();
+                yolo_detector.detect(frame, yolo_results);
+
+                // Step 2: DeepSORT 跟踪（按置信度两阶段关联）
+                tracker.update(frame, yolo_results, tracks, timestamp);
+            } else {
+                // 插帧：不检测、不做 ReID，Kalman 预测 + 光流观测
+                tracker.propagate(frame, tracks, timestamp);
             }
 
-            // Step 3: DeepSORT 跟踪
-            auto tracks = tracker.update(frame, detections);
-
             auto end = std::chrono::high_resolution_clock::now();
-            auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
-            std::cout << "🕒 帧 " << frame_count << ": 处理时间 = " 
-                      << duration.count() << " ms, 检测数 = " << yolo_results.size() 
-                      << ", 跟踪数 = " << tracks.size() << std::endl;
-
-            // Step 4: 可视化
+            double ms = std::chrono::duration<double, std::milli>(end - start).count();
+            (keyframe_now ? keyframe_ms : interframe_ms) += ms;
+            if (frame_count == 0) first_frame_ms = ms;
+            std::cout << "🕒 帧 " << frame_count << (keyframe_now ? " [关键帧]" : " [插帧]  ")
+                      << ": 处理时间 = " << static_cast<int>(ms) << " ms, 检测数 = "
+                      << (keyframe_now ? yolo_results.size() : 0) << ", 跟踪数 = " << tracks.size() << std::endl;
+
+            // Step 3: 可视化
             cv::Mat vis = frame.clone();
             for (const auto& track : tracks) {
-                cv::Rect_<float> box = track.to_tlwh();
+                const cv::Rect_<float>& box = track.box;
                 cv::Rect draw_box(
                     static_cast<int>(box.x),
                     static_cast<int>(box.y),
@@ -133,6 +152,17 @@ int main() {
         writer.release();
         cv::destroyAllWindows();
 
+        const KeyframeStats& ks = tracker.keyframeStats();
+        std::cout << "\n🎞️ 关键帧 " << ks.keyframes << "（漂移强制 " << ks.forced_keyframes << "），插帧 "
+                  << ks.interframes << "；平均耗时 关键帧 " << keyframe_ms / std::max<size_t>(ks.keyframes, 1)
+                  << " ms，插帧 " << interframe_ms / std::max<size_t>(ks.interframes, 1) << " ms" << std::endl;
+        std::cout << "   冷启动: 启动 " << startup_ms << " ms + 首帧 " << first_frame_ms << " ms" << std::endl;
+        std::cout << "   光流观测: 采用 " << ks.flow_tracked << "，失败 " << ks.flow_failed
+                  << "，漂移丢弃 " << ks.flow_drifted << std::endl;
+
+        const ReidStats& reid = tracker.reidStats();
+        std::cout << "\n🔍 ReID: 提取 " << reid.crops_extracted << " / " << reid.crops_total
+                  << " 个检测，跳过 " << reid.crops_skipped << std::endl;
         std::cout << "\n✅ 跟踪完成！输出视频已保存至: " << output_video << std::endl;
 
     } catch (const std::exception& e) {
@@ -0,0 +1,108 @@
+#include "utils/utils.h"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <cassert>
+
+// ==================== 外观距离：逐对 CosineLoss vs 归一化 + GEMM ====================
+// 1. 数值：fp32 GEMM 结果与逐对 double 精度 CosineLoss 对比（含零向量）
+// 2. 性能：200 x 200 对 512 维特征（OSNet 输出维度）的完整距离矩阵
+
+static std::vector<std::vector<float>> random_features(size_t n, size_t dim, std::mt19937& rng) {
+    // ReID 特征经过 ReLU，非负
+    std::uniform_real_distribution<float> dist(0.0f, 4.0f);
+    std::vector<std::vector<float>> f(n, std::vector<float>(dim));
+    for (auto& v : f) {
+        for (auto& x : v) x = dist(rng);
+    }
+    return f;
+}
+
+// 打包为行优先连续矩阵并逐行归一化
+static std::vector<float> pack_normalized(const std::vector<std::vector<float>>& f, size_t dim) {
+    std::vector<float> m(f.size() * dim);
+    for (size_t i = 0; i < f.size(); ++i) {
+        std::copy(f[i].begin(), f[i].end(), m.begin() + i * dim);
+        L2Normalize(m.data() + i * dim, dim);
+    }
+    return m;
+}
+
+int main() {
+    const size_t dim = 512;
+    const size_t n = 200;
+    std::mt19937 rng(11);
+
+    auto tracks = random_features(n, dim, rng);
+    auto dets = random_features(n, dim, rng);
+    // 让一部分配对非常相似，覆盖距离接近 0 的区间
+    std::normal_distribution<float> noise(0.0f, 0.05f);
+    for (size_t i = 0; i < n; i += 3) {
+        for (size_t k = 0; k < dim; ++k) dets[i][k] = std::max(0.0f, tracks[i][k] + noise(rng));
+    }
+    std::fill(dets[n - 1].begin(), dets[n - 1].end(), 0.0f);   // 推理失败时的零特征
+
+    std::vector<float> T = pack_normalized(tracks, dim);
+    std::vector<float> D = pack_normalized(dets, dim);
+
+    // ---------- 1. 数值一致性 ----------
+    RowMajorMatrixXf gemm;
+    CosineDistanceMatrix(T.data(), n, D.data(), n, dim, gemm);
+
+    float max_gemm_err = 0.0f, max_pair_err = 0.0f;
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            float ref = CosineLoss(tracks[i], dets[j]);
+            max_gemm_err = std::max(max_gemm_err, std::abs(gemm(i, j) - ref));
+            float pair = NormalizedCosineDistance(T.data() + i * dim, D.data() + j * dim, dim);
+            max_pair_err = std::max(max_pair_err, std::abs(pair - ref));
+        }
+    }
+    std::cout << "=== 外观距离数值对比（" << n << " x " << n << "，" << dim << " 维）===\n"
+              << "GEMM 最大绝对误差:     " << std::scientific << max_gemm_err << "\n"
+              << "逐对点积最大绝对误差:  " << max_pair_err << std::defaultfloat << "\n";
+    assert(max_gemm_err < 1e-5f);
+    assert(max_pair_err < 1e-5f);
+    assert(gemm(0, n - 1) == 1.0f);   // 零特征的距离为 1
+
+    // ---------- 2. 性能 ----------
+    const int repeats = 20;
+    double sink = 0.0;
+
+    auto t0 = std::chrono::high_resolution_clock::now();
+    for (int r = 0; r < repeats; ++r) {
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < n; ++j) sink += CosineLoss(tracks[i], dets[j]);
+        }
+    }
+    auto t1 = std::chrono::high_resolution_clock::now();
+    for (int r = 0; r < repeats; ++r) {
+        // 每帧都需要归一化新检测的特征，计入耗时
+        std::vector<float> Dn = pack_normalized(dets, dim);
+        CosineDistanceMatrix(T.data(), n, Dn.data(), n, dim, gemm);
+        sink += gemm(r % n, 0);
+    }
+    auto t2 = std::chrono::high_resolution_clock::now();
+    for (int r = 0; r < repeats; ++r) {
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < n; ++j) {
+                sink += NormalizedCosineDistance(T.data() + i * dim, D.data() + j * dim, dim);
+            }
+        }
+    }
+    auto t3 = std::chrono::high_resolution_clock::now();
+
+    double loss_ms = std::chrono::duration<double, std::milli>(t1 - t0).count() / repeats;
+    double gemm_ms = std::chrono::duration<double, std::milli>(t2 - t1).count() / repeats;
+    double pair_ms = std::chrono::duration<double, std::milli>(t3 - t2).count() / repeats;
+    std::cout << "\n=== 完整距离矩阵耗时（每帧）===\n" << std::fixed << std::setprecision(3)
+              << "逐对 CosineLoss:       " << loss_ms << " ms\n"
+              << "归一化 + GEMM:         " << gemm_ms << " ms（" << std::setprecision(1)
+              << loss_ms / gemm_ms << "x）\n" << std::setprecision(3)
+              << "逐对归一化点积:        " << pair_ms << " ms\n"
+              << "(sink " << std::setprecision(1) << sink << ")\n";
+
+    return 0;
+}
@@ -1,5 +1,11 @@
 #include "yolo/onnx_yolo_detecter.h"
 #include <opencv2/opencv.hpp>
+#include <chrono>
+#include <iostream>
+
+static double elapsed_ms(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
 
 int main() {
     std::vector<std::string> classNames = {
@@ -14,17 +20,45 @@ int main() {
         "hair drier", "toothbrush"
     };
 
+    // 优化后的模型缓存在模型旁边：第一次运行写出，之后运行直接加载（对比两次的启动耗时）
+    DetectorConfig config;
+    config.optimized_model_path = "/home/rton/MultiObjectTracker/test/yolo12n.opt.onnx";
+
+    auto t0 = std::chrono::steady_clock::now();
     ONNXYoloDetector detector(
         "/home/rton/MultiObjectTracker/test/yolo12n.onnx", 
         classNames,
         640,640,
         0.2,
-        0.4
+        0.4,
+        config
     );
+    const double construct_ms = elapsed_ms(t0);
 
     cv::Mat frame = cv::imread("/home/rton/MultiObjectTracker/test/test.jpeg");
     std::vector<detect_result> results;
+
+    // 冷启动：首帧推理含线程池创建、内存 arena 分配等一次性开销
+    t0 = std::chrono::steady_clock::now();
     detector.detect(frame, results);
+    const double first_ms = elapsed_ms(t0);
+
+    // 稳态吞吐
+    const int runs = 20;
+    std::vector<detect_result> scratch;
+    t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < runs; ++i) {
+        scratch.clear();
+        detector.detect(frame, scratch);
+    }
+    const double steady_ms = elapsed_ms(t0) / runs;
+
+    const DetectorLoadStats& load = detector.loadStats();
+    std::cout << "启动: 构造 " << construct_ms << " ms（会话 " << load.session_ms << " ms，"
+              << (load.from_optimized_cache ? "加载优化缓存" : load.wrote_optimized_cache ? "优化并写出缓存" : "优化，无缓存")
+              << "），首帧 " << first_ms << " ms\n"
+              << "稳态: " << steady_ms << " ms/帧（" << 1000.0 / steady_ms << " FPS，intra "
+              << config.intra_op_threads << " 线程，自旋 " << (config.allow_spinning ? "开" : "关") << "）\n";
 
     // 可视化
     for (const auto& r : results) {